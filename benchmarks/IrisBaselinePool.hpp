@@ -0,0 +1,701 @@
+/**
+ * @file IrisBaselinePool.hpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief The thread pool that preceded the work-stealing pool (benchmarks only).
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ * Kept unchanged, together with the linked-node FIFO2::Queue it was built on,
+ * so that IrisPoolBenchmark can compare the work-stealing pool against it.
+ * Workers sleep on a shared condition variable (polling every second) and pop
+ * from the one queue. With several workers the queue can lose tasks, which
+ * then never run; the benchmark reports such runs as stalled.
+ */
+#ifndef IrisBaselinePool_hpp
+#define IrisBaselinePool_hpp
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <sstream>
+#include <iostream>
+
+namespace Iris {
+namespace Baseline {
+namespace FIFO2 {
+#if IRIS_DEBUG
+inline struct __NODE_MEM_GUARD {
+    atomic_uint32   __NODES;
+    explicit __NODE_MEM_GUARD () : __NODES(0) {}
+    ~__NODE_MEM_GUARD () {
+        if (__NODES != 0)
+            std::cerr<<"FIFO NODE MEMORY GUARD TRIGGER: The Iris Queue Node Memory Guard indicates that not all nodes within the queue have been destroyed. This indicates a MEMORY LEAK associated with the lockless queue structure. Place a breakpoint in the FIFO_Queue::QueueNode::DECREMENT and FIFO_Queue::__INTERNAL__Node destructor to track descrepencies between reference counts and destructor calls.";
+    }
+} NODE_MEMORY_GUARD;
+#endif
+
+constexpr uint16_t NODE_SIZE = 1<<11; //2048
+constexpr uint16_t NODE_MASK = NODE_SIZE - 1;
+
+template <class T>
+class Queue;
+template <class T>
+class NodePtr;
+template <class T>
+class Iterator;
+template <class T>
+class __INTERNAL__Node;
+
+template <class T>
+using AtomicPtr = std::atomic<__INTERNAL__Node<T>*>;
+template <class T>
+using QueuePtr  = std::shared_ptr<Queue<T>>;
+
+enum __EntryFlag {
+    ENTRY_FREE,
+    ENTRY_WRITING,
+    ENTRY_PENDING,
+    ENTRY_READING,
+    ENTRY_COMPLETE
+};
+
+using EntryFlag = std::atomic<__EntryFlag>;
+template <class T>
+struct Entry {
+    T                           handle;
+    EntryFlag                   flag;
+    explicit Entry              () :
+    flag                        (ENTRY_FREE) {}
+    static_assert(std::is_copy_constructible_v<T>, "Entries within Iris lockless queues must be copiable");
+};
+
+/// NodePtr is a
+template <class T>
+class NodePtr {
+    friend class Queue<T>;
+    friend class __INTERNAL__Node<T>;
+protected:
+    AtomicPtr<T>                _ptr;
+public:
+    // Default constructor, create NEW node
+    NodePtr                     (AtomicPtr<T>& head_node);
+    NodePtr                     (const NodePtr&);
+    NodePtr                     (__INTERNAL__Node<T>*);
+   ~NodePtr                     ();
+    NodePtr& operator =         (const NodePtr&);
+    bool compare_exchange       (const NodePtr& expected,
+                                 const NodePtr& desired);
+    
+    __INTERNAL__Node<T>*
+    operator *                  () const {
+        return _ptr.load();
+    }
+    __INTERNAL__Node<T>*
+    operator ->                 () const {
+        return _ptr.load();
+    }
+    bool
+    operator ==                 (const NodePtr& o) const {
+        return _ptr == o._ptr;
+    }
+    bool
+    operator ==                 (const __INTERNAL__Node<T>* ptr) const {
+        return _ptr == ptr;
+    }
+    operator bool               () const {
+        return _ptr.load() != nullptr;
+    }
+private:
+    void set_reference          (__INTERNAL__Node<T>* __ptr);
+};
+
+template <class T>
+class __INTERNAL__Node {
+    friend class Queue<T>;
+    friend class NodePtr<T>;
+    friend class Iterator<T>;
+    AtomicPtr<T>&               _head;
+    Entry<T>                    _e[NODE_SIZE];
+    atomic_uint16               _front;
+    atomic_sint32               _use;
+protected:
+    NodePtr<T>                  _next;
+    explicit __INTERNAL__Node   (AtomicPtr<T>& head) :
+    _head                       (head),
+    _front                      (0),
+    _use                        (1),
+    _next                       (NULL)
+    {
+    #if IRIS_DEBUG
+        ++NODE_MEMORY_GUARD.__NODES;
+    #endif
+    }
+    int16_t INCREMENT () {
+        int use = _use.load (std::memory_order_acquire);
+        while (use > 0)
+            if (_use.compare_exchange_weak
+                (use, use + 1,
+                 std::memory_order_release,
+                 std::memory_order_relaxed))
+                return use;
+        return 0;
+    }
+    int16_t DECREMENT () {
+        return _use.fetch_sub(1)-1;
+    }
+public:
+    __INTERNAL__Node            (const __INTERNAL__Node&) = delete;
+    __INTERNAL__Node& operator =(const __INTERNAL__Node&) = delete;
+   ~__INTERNAL__Node            ()
+     {
+       // If this is the head node, exchange the head node status \
+       // with the next node in the chain.
+       __INTERNAL__Node* NODE_PTR = this;
+       _head.compare_exchange_strong(NODE_PTR, _next._ptr);
+       
+     #if IRIS_DEBUG
+       for (uint16_t index = 0; index < NODE_SIZE; index++) {
+           switch (_e[index].flag) {
+               case ENTRY_FREE:
+               case ENTRY_COMPLETE:
+                   break;
+               case ENTRY_WRITING:
+               case ENTRY_PENDING:
+               case ENTRY_READING:
+                   std:: cerr << "Attempting to destory queue node "
+                   << "with oustanding queue entry ["
+                   << index
+                   << "]; Place breakpoint in "
+                   << __FILE__ << " at " << __LINE__
+                   << " to debug. \n";
+           }
+       }
+        --NODE_MEMORY_GUARD.__NODES;
+     #endif
+     }
+    Entry<T>* get_front         ()
+    {
+        int16_t i = _front.fetch_add(1);
+        return i < NODE_SIZE ? &_e[i] : nullptr;
+    }
+    Entry<T>* get_at            (uint16_t i)
+    {
+        return i < NODE_SIZE ? &_e[i] : nullptr;
+    }
+private:
+    /// Extend chain is a THREAD SAFE call that will extend the chain by as many threads that call it.
+    /// Guaranteed to create a new node when called and insert it in a thread-safe stack manner
+    /// to the next chain.
+    void extend_chain           ()
+    {
+        // END_TEST_NODE ensures NODE_TO_ADD_TO_CHAIN is only added to
+        // the end of the growing chain. Each time the exchange fails
+        // next is progressed down the growing chain.
+        // NOTE: NODE_TO_ADD_TO_CHAIN reference count will be 1!
+        // We are doing manual addition
+        __INTERNAL__Node* END_TEST_NODE = nullptr;
+        __INTERNAL__Node* NODE_TO_ADD_TO_CHAIN = new __INTERNAL__Node(_head);
+        AtomicPtr<T>* next = &_next._ptr;
+        while (!next->compare_exchange_weak(END_TEST_NODE,
+                                            NODE_TO_ADD_TO_CHAIN,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+            // There is another link in the chain,
+            // this link was returned in END_TEST_NODE.
+            // Progress next with the addr of the next ptr in the chain
+            // and reset the END_TEST_NODE to look for nullptr (ie end)
+            next = &END_TEST_NODE->_next._ptr;
+            END_TEST_NODE = nullptr;
+        }
+    }
+};
+// Default constructor, create NEW node
+template <class T>
+inline NodePtr<T>::NodePtr      (AtomicPtr<T>& head) :
+_ptr                            (new __INTERNAL__Node(head))
+{
+    
+}
+
+// Copy constructor
+template <class T>
+inline NodePtr<T>::NodePtr      (const NodePtr<T>& o) :
+_ptr                            (nullptr)
+{
+    set_reference(o._ptr);
+}
+
+// Construct from raw node ptr
+template <class T>
+inline NodePtr<T>::NodePtr      (__INTERNAL__Node<T>* __ptr) :
+_ptr                            (nullptr)
+{
+    set_reference(__ptr);
+}
+
+// Copy assignment operator.
+template <class T>
+inline NodePtr<T>& NodePtr<T>::operator = (const NodePtr & o)
+{
+    // Perform an exchange storing the prior node
+    // if there is a new node. Else set this to null.
+    __INTERNAL__Node<T>* prior = nullptr;
+    if (o && o._ptr.load()->INCREMENT() > 0)
+         prior = _ptr.exchange(o._ptr);
+    else prior = _ptr.exchange(nullptr);
+    
+    // Post exchange, decrement the prior
+    // if var prior is the last reference
+    // delete it.
+    if (prior && prior->DECREMENT() < 1)
+        delete prior;
+    
+    return *this;
+}
+// Destructor -- remove node if this is the last ptr
+template <class T>
+inline NodePtr<T>::~NodePtr             ()
+{
+    // If there is a nullptr for the reference
+    if (_ptr.load() == nullptr) return;
+    
+    // If this is the last node access, delete it
+    // Because this is a destructor we don't have to
+    // worry about a copy exchange incrementing it.
+    if (_ptr.load()->DECREMENT() < 1)
+        delete _ptr.exchange(nullptr);
+}
+template <class T>
+inline bool NodePtr<T>::compare_exchange (const NodePtr &expected,
+                                          const NodePtr &desired)
+{
+    // Safety copy will ensure the reference count
+    // will at least have 1, thus it will not require deletion
+    // Until safety_copy exits scope (at the end of this call)
+    NodePtr safty_copy  = expected;
+    auto    EXPECTED    = safty_copy._ptr.load(std::memory_order_acquire);
+    auto    DESIRED     = desired._ptr.load(std::memory_order_acquire);
+    if (_ptr.compare_exchange_strong(EXPECTED, DESIRED,
+                                     std::memory_order_release,
+                                     std::memory_order_relaxed))
+    {
+        // Increment will increase the deired ptrs
+        DESIRED->INCREMENT();
+        // Decrement will NOT cause it to decrement to 0
+        // because of the safety copy
+        EXPECTED->DECREMENT();
+        // This thread was successful in updating it, return true
+        return true;
+    }
+    // This thread was unsuccessful; another thread made it here first.
+    return false;
+}
+template <class T>
+inline void NodePtr<T>::set_reference (__INTERNAL__Node<T>* __ptr) {
+    // If this incremented
+    if (__ptr && __ptr->INCREMENT() > 0)
+         _ptr.store (__ptr);
+    else _ptr.store (nullptr);
+}
+
+template <class T>
+class Iterator {
+    friend class Queue<T>;
+    NodePtr<T>                  _node;
+    uint16_t                    _index;
+protected:
+    explicit Iterator           (__INTERNAL__Node<T>* node_ptr) :
+    _node                       (node_ptr),
+    _index                      (0) {
+        for (;;_index++) {
+            // Grab the entry at the index
+            Entry<T>* entry = _node->get_at(_index);
+            
+            // If there is no entry, move on to the next node.
+            if (!entry) {
+                // If we are at the end of the node and there is
+                // no other node in the chain, assume it's the end.
+                if (_node->_next == nullptr) return;
+                
+                // Grab the next node in the chain
+                _node.compare_exchange(_node, _node->_next);
+                _index  = 0;
+                entry   = _node->get_at(_index);
+            }
+            
+            switch (entry->flag) {
+                // Most likely -- we are not at the end.
+                // Either it is complete or we are at the reading end.
+                // continue until we hit PENDING or
+                case ENTRY_COMPLETE:
+                case ENTRY_READING:
+                    continue;
+                    
+                // PAST THE READING BLOCK TO THE PENDING BLOCK.
+                // This is where we want iterators to begin.
+                case ENTRY_PENDING:
+                case ENTRY_FREE:
+                case ENTRY_WRITING:
+                    return;
+            }
+        }
+    }
+public:
+    Iterator                    (const Iterator& o) :
+    _node                       (o._node),
+    _index                      (o._index){}
+    bool pop                    (T& reference) {
+        
+        // This will always check the current node first
+        // despite the fact it was likely previously emptied.
+        for (;;_index++) {
+            // Get the front entry (first)
+            Entry<T>* entry = _node->get_at(_index);
+            
+            POP_ENTRY:
+            if (entry) {
+                __EntryFlag FLAG = ENTRY_PENDING;
+                if (entry->flag.compare_exchange_strong(FLAG, ENTRY_READING)) {
+                    reference       = entry->handle;
+                    entry->handle   = T();
+                    entry->flag.store(ENTRY_COMPLETE);
+                    return true;
+                    
+                } switch (FLAG) {
+                    // Most likely -- we are not at the end.
+                    // Either it is complete or we are at the reading end.
+                    // continue until we hit PENDING or
+                    case ENTRY_COMPLETE:
+                    case ENTRY_READING:
+                        continue;
+                        
+                    // Spurrious failure; attempt it again.
+                    // It's better to reattempt due to compare_exchange logic
+                    case ENTRY_PENDING:
+                        goto POP_ENTRY;
+                      
+                    // Writing Edge.
+                    case ENTRY_FREE:
+                    case ENTRY_WRITING:
+                        return false;
+                }
+            }
+            
+            // If we are at the end of the node and there is
+            // no other node in the chain, assume it's the end.
+            if (_node->_next == nullptr) return false;
+            
+            // Grab the next node in the chain
+            _node.compare_exchange(_node, _node->_next);
+            _index  = 0;
+            entry   = _node->get_at(_index);
+            goto POP_ENTRY;
+        }
+    }
+    bool at_end () {
+        // Get the front entry (first)
+        NodePtr<T> node = _node;
+        Entry<T>* entry = _node->get_at(_index);
+        
+        if (!entry) {
+            // If we are at the end of the node and there is
+            // no other node in the chain, assume it's the end.
+            if (node->_next == nullptr) return true;
+            
+            node    = node->_next;
+            _index  = 0;
+            entry   = node->get_at(_index);
+        } switch (entry->flag.load(std::memory_order_acquire)) {
+            case ENTRY_FREE:
+                return true;
+            case ENTRY_WRITING:
+            case ENTRY_PENDING:
+            case ENTRY_READING:
+            case ENTRY_COMPLETE:
+                return false;
+        } return true;
+    }
+};
+
+// FIRST IN FIRST OUT QUEUE:
+// The queue has a STRONG reference to the tail node, which is at
+// the growing end of the queue.
+// There is a WEAK reference to the head at the back end of the queue.
+// New "tail" nodes are added to the queue.
+// New iterators are added and reference the lagging head as they work
+// through the queue entries.
+// Iterator -|                Queue -|
+//           |                       |
+//           v                       v
+//          Head -> node -> node -> Tail -> next -> next -//
+//            ^      ^
+// Iterator 3-|      |
+//       Iterator 2 -|
+// iterator keeps the head alive. Queue maintains reference
+// to Tail. Should Iterator 1 and 2 exit, the nodes will colapse
+// until it hits Tail, which will stay alive due to Queue.
+// Note: any 'next' nodes were created by threads needing additional
+// nodes and are stored for use (see '__INTERNAL__Node::extend_chain()')
+template <class T>
+class Queue : public std::enable_shared_from_this<Queue<T>> {
+    NodePtr<T>                  _tail;
+    AtomicPtr<T>                _head;
+public:
+    // Generate the tail node as a new node, and reference
+    // the tail node internal pointer as the head as well.
+    explicit Queue              () :
+    _tail                       (NodePtr(_head)),
+    _head                       (_tail._ptr.load()) {}
+    Queue                       (const Queue&) = delete;
+    Queue& operator =           (const Queue&) = delete;
+    void push                   (const T& reference)
+    {
+        auto tail = _tail;
+        if (!tail) throw std::runtime_error("Failed to push entry. No valid tail\n");
+        
+        // Get the front entry (first) 
+        Entry<T>* entry = tail->get_front();
+        
+    INSERT_ENTRY:
+        if (entry) {
+            switch (entry->flag.exchange(ENTRY_WRITING)) {
+                // ANYTHING BESIDES A FREE SPACE IS A MISTAKE
+                // Throw for development but attempt to recover in production
+                case ENTRY_WRITING:
+                case ENTRY_PENDING:
+                case ENTRY_READING:
+                case ENTRY_COMPLETE:
+                    assert(false && "ERROR: Entry was not empty");
+                    entry = tail->get_front();
+                    goto INSERT_ENTRY;
+                    
+                // It should have been a free space
+                case ENTRY_FREE:
+                    entry->handle   = reference;
+                    entry->flag     = ENTRY_PENDING;
+                    return;
+            }
+        }
+        
+        while (entry == nullptr) {
+            // Copy construct a shared_ptr to the next in the tail
+            auto next = tail->_next;
+            
+            // If there is not another link in the chain,
+            // Grow the chain. Each concurrent thread will add a link
+            // any new unused links will be used in subsequent calls.
+            // (chain extension will probably happen in bursts)
+            if (next == nullptr) {
+                tail->extend_chain();
+                next = tail->_next;
+                assert (next && "Chain extension failed.\n");
+            }
+            
+            if (next) _tail.compare_exchange(tail, next);
+            
+            tail    = _tail;
+            entry   = tail->get_front();
+        }
+        // A valid entry exits in var entry, go to insertion.
+        goto INSERT_ENTRY;
+    }
+    Iterator<T> begin () const
+    {
+        return Iterator (_head.load(std::memory_order_acquire));
+    }
+};
+} // END NAMESPACE FIFO2
+
+using Fence         = std::shared_ptr<struct __INTERNAL__Fence>;
+using ThreadPool    = std::shared_ptr<class __INTERNAL__Pool>;
+using TaskList      = FIFO2::Queue<struct Callback>;
+
+struct Callback {
+    LambdaPtr                       callback        = nullptr;
+    Fence                           fenceOptional   = nullptr;
+};
+
+struct __INTERNAL__Fence {
+    atomic_bool                     complete;
+    
+    explicit __INTERNAL__Fence      () :
+    complete                        (false) { }
+    __INTERNAL__Fence               (const __INTERNAL__Fence&) = delete;
+    __INTERNAL__Fence& operator =   (const __INTERNAL__Fence&) = delete;
+    void wait_on_signal ()          { complete.wait(false); }
+};
+
+enum __status : uint8_t {
+    POOL_ACTIVE         = 0,
+    POOL_DRAINING       = 0x01,
+    POOL_TERMINATING    = 0x10,
+    POOL_INACTIVE       = 0xFF
+};
+using Status = std::atomic<__status>;
+
+class __INTERNAL__Pool {
+    TaskList        _tasks;
+    Threads         _threads;
+    Mutex           _task_added_mtx; // Used only for conditional variable
+    Notification    _task_added;     // Conditional variable notification
+    Status          status;
+    
+public:
+    explicit __INTERNAL__Pool       (uint32_t thread_pool_size);
+    __INTERNAL__Pool                (const __INTERNAL__Pool&) = delete;
+    __INTERNAL__Pool& operator =    (const __INTERNAL__Pool&) = delete;
+   ~__INTERNAL__Pool                ();
+    void    issue_task              (const LambdaPtr&);
+    Fence   issue_task_with_fence   (const LambdaPtr&);
+    void    wait_until_complete     ();
+    void    terminate               ();
+    void    reset                   ();
+private:
+    void    process_tasks           ();
+};
+
+inline ThreadPool createThreadPool (uint32_t thread_pool_size)
+{
+    return std::make_shared<__INTERNAL__Pool>(thread_pool_size);
+}
+inline __INTERNAL__Pool::__INTERNAL__Pool (uint32_t thread_pool_size) :
+_threads    (thread_pool_size),
+status      (POOL_ACTIVE)
+{
+    // Start all of the callback threads
+    for (auto& thread : _threads)
+        thread = std::thread {
+            &__INTERNAL__Pool::process_tasks,
+            this
+        };
+}
+inline __INTERNAL__Pool::~__INTERNAL__Pool ()
+{
+    wait_until_complete();
+}
+inline void WARN_INACTIVE_QUEUE()
+{
+    std::cerr << "[WARNING] Iris Async Pool: Attempting to enqueue task to inactive queue\n";
+}
+inline void __INTERNAL__Pool::issue_task(const LambdaPtr &lambda)
+{
+    // Return if the pool is not active / Shutting down
+    if (status & POOL_TERMINATING) return WARN_INACTIVE_QUEUE();
+    
+    // Insert the task into the list.
+    _tasks.push(Callback{
+        .callback       = lambda,
+        .fenceOptional  = nullptr,
+    });
+    
+    // And notify any waiting implementation threads
+    _task_added.notify_one();
+}
+inline Fence __INTERNAL__Pool::issue_task_with_fence(const LambdaPtr &lambda)
+{
+    // Return if the pool is not active / Shutting down
+    if (status & POOL_TERMINATING) { WARN_INACTIVE_QUEUE(); return NULL; }
+    
+    // Create a callback fence
+    auto fence = std::make_shared<__INTERNAL__Fence>();
+    
+    // Insert the task into the list.
+    _tasks.push(Callback{
+        .callback       = lambda,
+        .fenceOptional  = fence,
+    });
+    
+    // And notify any waiting implementation threads
+    _task_added.notify_one();
+    
+    return fence;
+}
+inline void __INTERNAL__Pool::wait_until_complete ()
+{
+    {// Switch the pool to the draining state
+        auto STATUS = status.load();
+        while(!status.compare_exchange_weak(STATUS, (__status)(STATUS|POOL_DRAINING)));
+    }
+    _task_added.notify_all();                                   // Ensure all exit the wait.
+    for (auto& thread : _threads)                               // Iterate over each worker
+        if (thread.joinable())                                  // Check if it is outstanding; if so...
+            thread.join();                                      // Merge threads and wait for it to complete.
+    status.store(POOL_INACTIVE);
+}
+inline void __INTERNAL__Pool::terminate()
+{
+    {   // Switch the pool to the terminated state
+        auto STATUS = status.load();
+        while(!status.compare_exchange_weak(STATUS, (__status)(STATUS|POOL_TERMINATING)));
+    }
+    _task_added.notify_all();                                   // Ensure all exit the wait.
+    for (auto& thread : _threads)                               // Iterate over each worker
+        if (thread.joinable())                                  // Check if it is outstanding; if so...
+            thread.join();                                      // Merge threads and wait for it to complete.
+    status.store(POOL_INACTIVE);
+}
+inline void __INTERNAL__Pool::reset() {
+    wait_until_complete();
+    status.store(POOL_ACTIVE);
+    for (auto& thread : _threads)
+        thread = std::thread {
+            &__INTERNAL__Pool::process_tasks,
+            this
+        };
+}
+inline void __INTERNAL__Pool::process_tasks() {
+    // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ //
+    //  HEADER BLOCK                                    //
+    // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ //
+    using namespace FIFO2;
+    Callback callback_entry;
+    Iterator<Callback> __it = _tasks.begin();
+    MutexLock task_lock     = MutexLock(_task_added_mtx, std::defer_lock);
+
+    while (status == POOL_ACTIVE) {
+        // Wait for a task to be issued.
+        try {
+            task_lock.lock();
+            _task_added.wait_for(task_lock, std::chrono::seconds(1)); // Check every second
+            task_lock.unlock();
+        } catch (...) {
+            if (task_lock.owns_lock())
+                task_lock.unlock();
+            task_lock = MutexLock(_task_added_mtx, std::defer_lock);
+            continue;
+        }
+        
+        // Attempt to implement those tasks.
+        try {
+            while (__it.pop(callback_entry) && (status ^ POOL_TERMINATING)) {
+                // Get the entry at the iterator's location.
+
+                // Invoke the callback method and then release 
+                // it's context (to free captured vars).
+                callback_entry.callback();
+                callback_entry.callback = nullptr;
+                
+                // If there is a fence, trigger it to release any waiting threads.
+                auto fence = callback_entry.fenceOptional;
+                if (fence) {
+                    fence->complete = true;
+                    fence->complete.notify_all();
+                }
+            }
+        } catch (std::runtime_error& error) {
+            std::stringstream LOG;
+            LOG         << "[WARNING] Exception thrown on Arke Async callback thread: "
+                        << error.what() << "\n";
+            std::cerr   << LOG.str();
+            
+    
+            if (task_lock.owns_lock())
+                task_lock.unlock();
+            task_lock = MutexLock(_task_added_mtx, std::defer_lock);
+        }
+    }
+}
+} // END BASELINE
+} // END IRIS
+#endif /* IrisBaselinePool_hpp */
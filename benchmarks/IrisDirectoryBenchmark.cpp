@@ -0,0 +1,115 @@
+/**
+ * @file IrisDirectoryBenchmark.cpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief Slide directory lookups per second from 1 to N threads.
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ * Every tile request resolves its slide through the SlideDirectory. For each
+ * thread count (1, 2, 4, ... up to the maximum, default 64) the threads look
+ * up random identifiers among `slides` open slides for `seconds` and the
+ * benchmark reports lookups per second for:
+ *  - find:     the identifier to a live slide (takes a reference to it)
+ *  - handle:   the identifier to its interned handle alone
+ *  - churn:    find, while another thread replaces a slide every millisecond
+ *              (each replacement publishes a new table)
+ *
+ * Usage: IrisDirectoryBenchmark [max threads = 64] [slides = 1024] [seconds = 2]
+ *
+ * The directory never dereferences its slides, so the benchmark registers
+ * placeholders that share ownership of a token instead of opening slide files.
+ */
+#include <cstdio>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+#include "IrisRestfulPriv.hpp"
+
+using namespace Iris;
+using namespace Iris::RESTful;
+using Clock = std::chrono::steady_clock;
+
+enum LookupKind {
+    LOOKUP_FIND,
+    LOOKUP_HANDLE,
+};
+inline Slide PLACEHOLDER_SLIDE ()
+{
+    auto token = std::make_shared<char>(0);
+    return Slide(token, reinterpret_cast<__INTERNAL__Slide*>(token.get()));
+}
+inline uint32_t NEXT_RANDOM (uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+double LOOKUPS_PER_SECOND (const SlideDirectory& directory, const std::vector<std::string>& ids,
+                           uint32_t threads, uint32_t seconds, LookupKind kind)
+{
+    std::atomic<bool>       stop    {false};
+    std::atomic<uint64_t>   total   {0};
+    std::vector<std::thread> workers;
+    for (uint32_t thread = 0; thread < threads; ++thread)
+        workers.emplace_back([&, thread]() {
+            uint32_t state = 2654435761U * (thread + 1);
+            uint64_t lookups = 0, found = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int batch = 0; batch < 256; ++batch, ++lookups) {
+                    auto& id = ids[NEXT_RANDOM(state) % ids.size()];
+                    if (kind == LOOKUP_FIND) found += directory.find(id) != nullptr;
+                    else found += directory.handle(id) != NULL_SLIDE_HANDLE;
+                }
+            }
+            if (found < lookups / 2)
+                fprintf(stderr, "[WARNING] Only %llu of %llu lookups resolved\n",
+                        (unsigned long long)found, (unsigned long long)lookups);
+            total.fetch_add(lookups, std::memory_order_relaxed);
+        });
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    stop.store(true);
+    for (auto& worker : workers) worker.join();
+    return total.load() / double(seconds);
+}
+int main (int argc, char const* argv[])
+{
+    const uint32_t max_threads  = argc > 1 ? std::stoul(argv[1]) : 64;
+    const uint32_t slide_count  = argc > 2 ? std::max<uint32_t>(std::stoul(argv[2]), 1) : 1024;
+    const uint32_t seconds      = argc > 3 ? std::stoul(argv[3]) : 2;
+
+    SlideDirectory directory;
+    std::vector<std::string> ids;
+    std::vector<Slide> slides;
+    for (uint32_t index = 0; index < slide_count; ++index) {
+        ids.push_back("slide-" + std::to_string(index));
+        slides.push_back(PLACEHOLDER_SLIDE());
+        directory.insert(ids.back(), slides.back());
+    }
+
+    printf("%8s %16s %16s %16s\n", "threads", "find (M/s)", "handle (M/s)", "churn (M/s)");
+    for (uint32_t threads = 1; threads <= max_threads; threads *= 2) {
+        auto find   = LOOKUPS_PER_SECOND(directory, ids, threads, seconds, LOOKUP_FIND);
+        auto handle = LOOKUPS_PER_SECOND(directory, ids, threads, seconds, LOOKUP_HANDLE);
+
+        std::atomic<bool> stop {false};
+        std::thread writer ([&]() {
+            for (uint32_t index = 0; !stop.load(std::memory_order_relaxed); ++index) {
+                auto& slide = slides[index % slide_count];
+                auto replacement = PLACEHOLDER_SLIDE();
+                if (directory.replace(ids[index % slide_count], slide, replacement))
+                    slide = replacement;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+        auto churn  = LOOKUPS_PER_SECOND(directory, ids, threads, seconds, LOOKUP_FIND);
+        stop.store(true);
+        writer.join();
+
+        printf("%8u %16.2f %16.2f %16.2f\n", threads, find / 1e6, handle / 1e6, churn / 1e6);
+    }
+    return 0;
+}
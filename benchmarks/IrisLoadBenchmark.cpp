@@ -0,0 +1,334 @@
+/**
+ * @file IrisLoadBenchmark.cpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief HTTP load driver: connections and requests per second from 1 to N cores.
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ * Drives a running Iris RESTful server over HTTP or HTTPS. For each client core
+ * count (1, 2, 4, ... up to the maximum, default all cores) one thread per
+ * core, pinned to it and running its own event loop, keeps `connections`
+ * clients busy for `seconds` in each of two phases:
+ *  - requests:     persistent (keep-alive) connections, one GET after another
+ *  - connections:  a new connection per GET ("Connection: close")
+ * and reports requests per second, connections per second, the median and
+ * 99th percentile request latency, failed requests, and the response body
+ * throughput (MB/s) of the requests phase. Given the server's process id
+ * (Linux), it also reports the server's CPU time (user and system) per GB of
+ * response bodies over the requests phase.
+ *
+ * Usage: IrisLoadBenchmark <host> <port> <target> [max cores = all]
+ *                          [connections per core = 32] [seconds = 5] [first core = 0]
+ *                          [server pid]
+ *
+ * Prefix the host with https:// to connect over TLS (the server's certificate
+ * is not verified). For the TLS CPU cost per GB served with and without kernel
+ * TLS, run the server with and without --ktls and a large tile target, e.g.
+ *     IrisLoadBenchmark https://127.0.0.1 3000 /slides/<slide>/layers/0/tiles/0 4 32 5 1 $(pidof IrisRESTful)
+ *
+ * The target is any request the server answers, for example a tile:
+ * /slides/<slide-name>/layers/0/tiles/0. To measure how the server scales,
+ * restrict it to 1..N cores (taskset -c) and start the client cores beyond
+ * them (first core) so that client and server do not share cores; compare
+ * the shared network reactors with --per-core-reactors this way.
+ */
+#include <utility>
+#include <boost/beast.hpp>
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+#include <memory>
+#include <limits>
+#include <optional>
+#include <algorithm>
+#if defined(__linux__)
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+namespace   net     = boost::asio;
+namespace   beast   = boost::beast;
+namespace   http    = beast::http;
+namespace   ssl     = net::ssl;
+using       tcp     = net::ip::tcp;
+using       Clock   = std::chrono::steady_clock;
+using       TlsStream = ssl::stream<tcp::socket>;
+
+enum LoadPhase {
+    PHASE_REQUESTS,         // Keep-alive connections
+    PHASE_CONNECTIONS,      // A new connection per request
+};
+struct Counters {
+    uint64_t                            requests    = 0;
+    uint64_t                            connections = 0;
+    uint64_t                            failures    = 0;
+    uint64_t                            bytes       = 0;    // Response bodies
+    std::vector<double>                 latencies;  // Microseconds
+};
+struct Load {
+    tcp::resolver::results_type         endpoints;
+    std::string                         host;
+    std::string                         target;
+    LoadPhase                           phase;
+    Clock::time_point                   deadline;
+    ssl::context*                       tls         = nullptr; // HTTPS when set
+};
+inline void OPEN_STREAM (std::optional<tcp::socket>& stream, net::io_context& context, const Load&)
+{
+    stream.emplace(context);
+}
+inline void OPEN_STREAM (std::optional<TlsStream>& stream, net::io_context& context, const Load& load)
+{
+    stream.emplace(context, *load.tls);
+}
+template <class Handler>
+inline void HANDSHAKE (tcp::socket&, Handler&& handler)
+{
+    handler(beast::error_code{});
+}
+template <class Handler>
+inline void HANDSHAKE (TlsStream& stream, Handler&& handler)
+{
+    stream.async_handshake(ssl::stream_base::client, std::move(handler));
+}
+/**
+ * @brief One client connection, run on its core's event loop
+ *
+ * Issues GET requests until the phase's deadline: on one connection in the
+ * requests phase, or reconnecting for each request in the connections phase.
+ * The stream is a TCP socket, or a TLS stream over one (reopened per
+ * connection, as a TLS stream cannot be reused once closed).
+ */
+template <class Stream>
+class Client : public std::enable_shared_from_this<Client<Stream>> {
+    const Load&                         _load;
+    Counters&                           _counters;
+    net::io_context&                    _context;
+    std::optional<Stream>               _stream;
+    beast::flat_buffer                  _buffer;
+    http::request<http::empty_body>     _request;
+    std::unique_ptr<http::response_parser<http::string_body>> _parser;
+    Clock::time_point                   _sent;
+public:
+    explicit Client                     (net::io_context& context, const Load& load, Counters& counters) :
+    _load                               (load),
+    _counters                           (counters),
+    _context                            (context),
+    _request                            (http::verb::get, load.target, 11)
+    {
+        _request.set(http::field::host, load.host);
+        _request.set(http::field::user_agent, "IrisLoadBenchmark");
+        _request.keep_alive(load.phase == PHASE_REQUESTS);
+    }
+    void start                          ()
+    {
+        if (Clock::now() >= _load.deadline) return;
+        OPEN_STREAM(_stream, _context, _load);
+        net::async_connect(beast::get_lowest_layer(*_stream), _load.endpoints,
+                           [self = this->shared_from_this()]
+                           (beast::error_code error, const tcp::endpoint&) {
+            if (error) return self->fail();
+            beast::get_lowest_layer(*self->_stream).set_option(tcp::no_delay(true), error);
+            HANDSHAKE(*self->_stream, [self](beast::error_code error) {
+                if (error) return self->fail();
+                ++self->_counters.connections;
+                self->send();
+            });
+        });
+    }
+private:
+    void send                           ()
+    {
+        _sent = Clock::now();
+        http::async_write(*_stream, _request, [self = this->shared_from_this()]
+                          (beast::error_code error, size_t) {
+            if (error) return self->fail();
+            self->receive();
+        });
+    }
+    void receive                        ()
+    {
+        _parser = std::make_unique<http::response_parser<http::string_body>>();
+        _parser->body_limit(std::numeric_limits<std::uint64_t>::max());
+        http::async_read(*_stream, _buffer, *_parser, [self = this->shared_from_this()]
+                         (beast::error_code error, size_t) {
+            if (error) return self->fail();
+            self->complete();
+        });
+    }
+    void complete                       ()
+    {
+        auto& response = _parser->get();
+        if (response.result_int() >= 400) ++_counters.failures;
+        else {
+            ++_counters.requests;
+            _counters.bytes += response.body().size();
+            _counters.latencies.push_back(std::chrono::duration<double, std::micro>
+                                          (Clock::now() - _sent).count());
+        }
+        if (Clock::now() >= _load.deadline) return close();
+        if (_load.phase == PHASE_REQUESTS && response.keep_alive()) return send();
+        reconnect();
+    }
+    void fail                           ()
+    {
+        ++_counters.failures;
+        if (Clock::now() < _load.deadline) reconnect();
+        else close();
+    }
+    void reconnect                      ()
+    {
+        close();
+        _buffer.clear();
+        start();
+    }
+    void close                          ()
+    {
+        // A TLS close_notify is not sent; the server sees the connection end
+        if (!_stream) return;
+        beast::error_code ignored;
+        auto& socket = beast::get_lowest_layer(*_stream);
+        socket.shutdown(tcp::socket::shutdown_both, ignored);
+        socket.close(ignored);
+    }
+};
+inline void PIN_TO_CORE (std::thread& thread, int core)
+{
+    #if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    if (pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set))
+        fprintf(stderr, "[WARNING] Failed to pin a client thread to core %d\n", core);
+    #endif
+}
+// CPU time (user and system) the process has used, in seconds; negative if unavailable
+double PROCESS_CPU_SECONDS (long pid)
+{
+    #if defined(__linux__)
+    if (pid <= 0) return -1;
+    FILE* file = fopen(("/proc/" + std::to_string(pid) + "/stat").c_str(), "r");
+    if (!file) return -1;
+    char stat[1024];
+    const size_t length = fread(stat, 1, sizeof(stat) - 1, file);
+    fclose(file);
+    stat[length] = '\0';
+    // Fields after the command name (which may hold spaces): state is the
+    // 3rd field, and user and system time (clock ticks) the 14th and 15th
+    const char* fields = strrchr(stat, ')');
+    unsigned long long user = 0, system = 0;
+    if (!fields || sscanf(fields + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu",
+                          &user, &system) != 2) return -1;
+    return double(user + system) / sysconf(_SC_CLK_TCK);
+    #else
+    return -1;
+    #endif
+}
+template <class Stream>
+Counters RUN_PHASE (const Load& load, uint32_t cores, uint32_t first_core, uint32_t connections)
+{
+    std::vector<Counters> counters (cores);
+    std::vector<std::thread> threads;
+    for (uint32_t core = 0; core < cores; ++core) {
+        threads.emplace_back([&load, &counters, core, connections]() {
+            net::io_context context (1);
+            for (uint32_t client = 0; client < connections; ++client)
+                std::make_shared<Client<Stream>>(context, load, counters[core])->start();
+            context.run();
+        });
+        PIN_TO_CORE(threads.back(), static_cast<int>(first_core + core));
+    }
+    for (auto& thread : threads) thread.join();
+
+    Counters total;
+    for (auto& core : counters) {
+        total.requests      += core.requests;
+        total.connections   += core.connections;
+        total.failures      += core.failures;
+        total.bytes         += core.bytes;
+        total.latencies.insert(total.latencies.end(), core.latencies.begin(), core.latencies.end());
+    }
+    std::sort(total.latencies.begin(), total.latencies.end());
+    if (total.latencies.empty()) total.latencies.push_back(0);
+    return total;
+}
+Counters RUN_PHASE (const Load& load, uint32_t cores, uint32_t first_core, uint32_t connections)
+{
+    if (load.tls) return RUN_PHASE<TlsStream>(load, cores, first_core, connections);
+    return RUN_PHASE<tcp::socket>(load, cores, first_core, connections);
+}
+int main (int argc, char const* argv[])
+{
+    if (argc < 4) {
+        fprintf(stderr, "Usage: %s <host> <port> <target> [max cores = all] "
+                        "[connections per core = 32] [seconds = 5] [first core = 0] "
+                        "[server pid]\n", argv[0]);
+        return 1;
+    }
+    const uint32_t available    = std::max(std::thread::hardware_concurrency(), 1U);
+    const uint32_t max_cores    = argc > 4 ? std::stoul(argv[4]) : available;
+    const uint32_t connections  = argc > 5 ? std::stoul(argv[5]) : 32;
+    const uint32_t seconds      = argc > 6 ? std::stoul(argv[6]) : 5;
+    const uint32_t first_core   = argc > 7 ? std::stoul(argv[7]) : 0;
+    const long server_pid       = argc > 8 ? std::stol(argv[8]) : 0;
+
+    std::string host            = argv[1];
+    ssl::context tls            (ssl::context::tls_client);
+    Load load {
+        .target     = argv[3],
+    };
+    if (host.rfind("https://", 0) == 0) {
+        host.erase(0, 8);
+        tls.set_verify_mode(ssl::verify_none);
+        load.tls    = &tls;
+    }
+    load.host       = host;
+    try {
+        net::io_context context;
+        load.endpoints = tcp::resolver(context).resolve(host, argv[2]);
+    } catch (std::exception& error) {
+        fprintf(stderr, "[ERROR] Failed to resolve %s:%s: %s\n", host.c_str(), argv[2], error.what());
+        return 1;
+    }
+    if (server_pid && PROCESS_CPU_SECONDS(server_pid) < 0)
+        fprintf(stderr, "[WARNING] Cannot read the CPU time of process %ld; "
+                        "server CPU per GB will not be reported\n", server_pid);
+
+    printf("%6s %14s %10s %10s %10s %10s %12s | %14s %10s %10s\n", "cores",
+           "requests/s", "p50 us", "p99 us", "failed", "MB/s", "CPU s/GB",
+           "connections/s", "p99 us", "failed");
+    std::vector<uint32_t> steps;
+    for (uint32_t cores = 1; cores < max_cores; cores *= 2) steps.push_back(cores);
+    steps.push_back(max_cores);
+    for (auto cores : steps) {
+        load.phase      = PHASE_REQUESTS;
+        load.deadline   = Clock::now() + std::chrono::seconds(seconds);
+        const double cpu_start = PROCESS_CPU_SECONDS(server_pid);
+        auto requests   = RUN_PHASE(load, cores, first_core, connections);
+        const double cpu_end = PROCESS_CPU_SECONDS(server_pid);
+        load.phase      = PHASE_CONNECTIONS;
+        load.deadline   = Clock::now() + std::chrono::seconds(seconds);
+        auto connected  = RUN_PHASE(load, cores, first_core, connections);
+        auto& latency   = requests.latencies;
+        const double gigabytes = requests.bytes / 1e9;
+        char cpu_per_gb[16] = "-";
+        if (cpu_start >= 0 && cpu_end >= 0 && gigabytes > 0)
+            snprintf(cpu_per_gb, sizeof(cpu_per_gb), "%.2f", (cpu_end - cpu_start) / gigabytes);
+        printf("%6u %14.0f %10.1f %10.1f %10llu %10.1f %12s | %14.0f %10.1f %10llu\n", cores,
+               requests.requests / double(seconds), latency[latency.size() / 2],
+               latency[latency.size() * 99 / 100], (unsigned long long)requests.failures,
+               requests.bytes / 1e6 / seconds, cpu_per_gb,
+               connected.connections / double(seconds),
+               connected.latencies[connected.latencies.size() * 99 / 100],
+               (unsigned long long)connected.failures);
+    }
+    return 0;
+}
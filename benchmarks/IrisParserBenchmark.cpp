@@ -0,0 +1,84 @@
+/**
+ * @file IrisParserBenchmark.cpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief GET request parse throughput: route table against the baseline parser.
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ * Parses representative IrisRESTful and WADO-RS targets (tile, DICOM frame,
+ * and slide and series metadata) with parse_get_request and with the parser
+ * it replaced (IrisBaselineGetParser.hpp), on one thread, and reports the
+ * parses per second and nanoseconds per parse of each. The baseline is given
+ * a copy of the target per parse, as it lowercases the target in place and
+ * the server copied the target for it.
+ *
+ * Usage: IrisParserBenchmark [parses per target = 5000000]
+ */
+#include <cstdio>
+#include <chrono>
+#include <string>
+#include "IrisRestfulPriv.hpp"
+#include "IrisBaselineGetParser.hpp"
+
+using namespace Iris;
+using namespace Iris::RESTful;
+using Clock = std::chrono::steady_clock;
+
+struct Target {
+    const char*                         name;
+    std::string_view                    target;
+};
+constexpr Target TARGETS[] = {
+    {"tile",            "/slides/ExampleSlide/layers/2/tiles/1234"},
+    {"dicom frame",     "/studies/2.25.1234/series/2.25.5678/instances/2/frames/1235"},
+    {"metadata",        "/slides/ExampleSlide/metadata"},
+    {"dicom metadata",  "/studies/2.25.1234/series/2.25.5678/metadata"},
+};
+inline double SECONDS_SINCE (const Clock::time_point& start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+double ROUTE_TABLE_PARSES_PER_SECOND (std::string_view target, uint64_t parses, uint64_t& sink)
+{
+    const auto start = Clock::now();
+    for (uint64_t parse = 0; parse < parses; ++parse)
+        sink += parse_get_request(target).index();
+    return parses / SECONDS_SINCE(start);
+}
+double BASELINE_PARSES_PER_SECOND (std::string_view target, uint64_t parses, uint64_t& sink)
+{
+    const auto start = Clock::now();
+    for (uint64_t parse = 0; parse < parses; ++parse) {
+        std::string copy (target);
+        sink += Baseline::parse_get_request(copy)->type;
+    }
+    return parses / SECONDS_SINCE(start);
+}
+int main (int argc, char const* argv[])
+{
+    const uint64_t parses = argc > 1 ? std::stoull(argv[1]) : 5000000;
+
+    // Both parsers must accept every target, or the comparison is meaningless
+    for (auto& target : TARGETS) {
+        std::string copy (target.target);
+        if (std::holds_alternative<GetMalformedRequest>(parse_get_request(target.target)) ||
+            Baseline::parse_get_request(copy)->protocol == Baseline::GetRequest::GET_REQUEST_MALFORMED) {
+            fprintf(stderr, "[ERROR] A parser rejected the %s target %s\n",
+                    target.name, std::string(target.target).c_str());
+            return 1;
+        }
+    }
+
+    uint64_t sink = 0;
+    printf("%16s %16s %12s %16s %12s %8s\n", "target", "table (M/s)", "table ns",
+           "baseline (M/s)", "baseline ns", "speedup");
+    for (auto& target : TARGETS) {
+        auto table      = ROUTE_TABLE_PARSES_PER_SECOND(target.target, parses, sink);
+        auto baseline   = BASELINE_PARSES_PER_SECOND(target.target, parses, sink);
+        printf("%16s %16.2f %12.1f %16.2f %12.1f %7.1fx\n", target.name,
+               table / 1e6, 1e9 / table, baseline / 1e6, 1e9 / baseline, table / baseline);
+    }
+    return sink == 0; // Keeps the parses from being optimized away
+}
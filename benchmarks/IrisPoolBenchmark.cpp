@@ -0,0 +1,176 @@
+/**
+ * @file IrisPoolBenchmark.cpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief Thread pool throughput and wake-up latency from 1 to N threads.
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ * For each pool size (1, 2, 4, ... up to the maximum, default 64), for the
+ * work-stealing pool and for the pool it replaced (IrisBaselinePool.hpp),
+ * reports:
+ *  - injected: tasks per second issued from a thread outside the pool
+ *    (the network reactors' path, through the injection ring)
+ *  - spawned:  tasks per second issued by the pool's own workers
+ *    (their work-stealing deques)
+ *  - wake-up:  median and 99th percentile time from issuing a task to a
+ *    parked pool until the task starts running
+ *
+ * Usage: IrisPoolBenchmark [max threads = 64] [tasks = 1000000]
+ *
+ * The baseline pool loses tasks (they never run) when its queue is pushed to
+ * and popped from concurrently. A measurement whose tasks stop completing for
+ * STALL_SECONDS is cut short: the pool is terminated (and a new one created
+ * for the next measurement), the throughput of the tasks that did run is
+ * reported with the number lost, and a lost wake-up task is reported as lost.
+ */
+#include <cstdio>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include "IrisTypes.hpp"
+#include "IrisFunction.hpp"
+#include "IrisQueue.hpp"
+#include "IrisAsync.hpp"
+#include "IrisBaselinePool.hpp"
+
+using namespace Iris;
+using Clock = std::chrono::steady_clock;
+constexpr uint32_t  FAN_OUT         = 64;   // Tasks spawned by each spawning task
+constexpr uint32_t  WAKE_SAMPLES    = 1000;
+constexpr auto      STALL_SECONDS   = std::chrono::seconds(5);
+
+struct Throughput {
+    double                              per_second  = 0;
+    uint64_t                            lost        = 0;    // Tasks that never ran
+};
+/**
+ * @brief Wait for the counter to reach the count
+ *
+ * Returns the time the counter last advanced. If it stops advancing for
+ * STALL_SECONDS the pool is terminated, so that no task outlives the counter.
+ */
+template <class Pool>
+Clock::time_point WAIT_FOR (const Pool& pool, const std::atomic<uint64_t>& counter, uint64_t count)
+{
+    uint64_t reached    = counter.load(std::memory_order_acquire);
+    auto advanced       = Clock::now();
+    while (reached < count) {
+        std::this_thread::yield();
+        const uint64_t current = counter.load(std::memory_order_acquire);
+        const auto now  = Clock::now();
+        if (current != reached) {
+            reached     = current;
+            advanced    = now;
+        } else if (now - advanced > STALL_SECONDS) {
+            pool->terminate();
+            break;
+        }
+    }
+    return advanced;
+}
+template <class Pool>
+Throughput THROUGHPUT (const Pool& pool, const std::atomic<uint64_t>& complete, uint64_t tasks,
+                       const Clock::time_point& start)
+{
+    const auto finished = WAIT_FOR(pool, complete, tasks);
+    const auto ran      = complete.load();
+    return Throughput {
+        .per_second     = ran / std::max(std::chrono::duration<double>(finished - start).count(), 1e-9),
+        .lost           = tasks - ran,
+    };
+}
+template <class Pool>
+Throughput INJECTED_TASKS_PER_SECOND (const Pool& pool, uint64_t tasks)
+{
+    std::atomic<uint64_t> complete {0};
+    const auto start = Clock::now();
+    for (uint64_t task = 0; task < tasks; ++task)
+        pool->issue_task([&complete]() {
+            complete.fetch_add(1, std::memory_order_release);
+        });
+    return THROUGHPUT(pool, complete, tasks, start);
+}
+template <class Pool>
+Throughput SPAWNED_TASKS_PER_SECOND (const Pool& pool, uint64_t tasks)
+{
+    std::atomic<uint64_t> complete {0};
+    const uint64_t roots = std::max<uint64_t>(tasks / FAN_OUT, 1);
+    const auto start = Clock::now();
+    for (uint64_t root = 0; root < roots; ++root)
+        pool->issue_task([&complete, pool = pool.get()]() {
+            for (uint32_t task = 0; task < FAN_OUT; ++task)
+                pool->issue_task([&complete]() {
+                    complete.fetch_add(1, std::memory_order_release);
+                });
+        });
+    return THROUGHPUT(pool, complete, roots * FAN_OUT, start);
+}
+// Sorted wake-up times; empty if a wake-up task was lost
+template <class Pool>
+std::vector<double> WAKE_UP_MICROSECONDS (const Pool& pool)
+{
+    std::vector<double> samples;
+    samples.reserve(WAKE_SAMPLES);
+    for (uint32_t sample = 0; sample < WAKE_SAMPLES; ++sample) {
+        // Give the workers time to stop spinning and park
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::atomic<uint64_t> started {0};
+        Clock::time_point issued = Clock::now(), running;
+        pool->issue_task([&started, &running]() {
+            running = Clock::now();
+            started.store(1, std::memory_order_release);
+        });
+        WAIT_FOR(pool, started, 1);
+        if (!started.load()) return {};
+        samples.push_back(std::chrono::duration<double, std::micro>(running - issued).count());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples;
+}
+inline std::string FORMAT (const Throughput& throughput)
+{
+    char buffer[48];
+    if (throughput.lost) snprintf(buffer, sizeof(buffer), "%.2f (%llu lost)", throughput.per_second / 1e6,
+                                  (unsigned long long)throughput.lost);
+    else snprintf(buffer, sizeof(buffer), "%.2f", throughput.per_second / 1e6);
+    return buffer;
+}
+template <class Create>
+void PRINT_POOL (const char* name, uint32_t threads, Create create, uint64_t tasks)
+{
+    // A pool that lost tasks was terminated; the next measurement gets a new one
+    auto pool       = create(threads);
+    auto injected   = INJECTED_TASKS_PER_SECOND(pool, tasks);
+    if (injected.lost) pool = create(threads);
+    auto spawned    = SPAWNED_TASKS_PER_SECOND(pool, tasks);
+    if (spawned.lost) pool = create(threads);
+    auto wake_up    = WAKE_UP_MICROSECONDS(pool);
+    char wake_p50[16] = "lost", wake_p99[16] = "lost";
+    if (wake_up.size()) {
+        snprintf(wake_p50, sizeof(wake_p50), "%.1f", wake_up[wake_up.size() / 2]);
+        snprintf(wake_p99, sizeof(wake_p99), "%.1f", wake_up[wake_up.size() * 99 / 100]);
+    }
+    printf("%8u %14s %24s %24s %12s %12s\n", threads, name, FORMAT(injected).c_str(),
+           FORMAT(spawned).c_str(), wake_p50, wake_p99);
+    pool->wait_until_complete();
+}
+int main (int argc, char const* argv[])
+{
+    const uint32_t max_threads  = argc > 1 ? std::stoul(argv[1]) : 64;
+    const uint64_t tasks        = argc > 2 ? std::stoull(argv[2]) : 1000000;
+    
+    printf("%8s %14s %24s %24s %12s %12s\n", "threads", "pool", "injected (M/s)", "spawned (M/s)",
+           "wake p50 us", "wake p99 us");
+    for (uint32_t threads = 1; threads <= max_threads; threads *= 2) {
+        PRINT_POOL("work-stealing", threads, [](uint32_t threads) {
+            return Async::createThreadPool(threads);
+        }, tasks);
+        PRINT_POOL("baseline", threads, [](uint32_t threads) {
+            return Baseline::createThreadPool(threads);
+        }, tasks);
+    }
+    return 0;
+}
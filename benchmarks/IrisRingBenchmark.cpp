@@ -0,0 +1,119 @@
+/**
+ * @file IrisRingBenchmark.cpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief Bounded MPMC ring (FIFO2::Ring) throughput and latency.
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ * For each combination of producer and consumer counts (1, 2, 4, ... up to
+ * the maximum, default 8) moves timestamped entries through a ring and
+ * reports entries per second and the median and 99th percentile time an
+ * entry spent in the ring. Producers retry (yield) when the ring is full.
+ * The same workload through a mutex-guarded std::deque, as the pool's
+ * overflow queue uses, is reported for comparison.
+ *
+ * Usage: IrisRingBenchmark [max threads = 8] [entries per producer = 1000000]
+ *                          [ring capacity = 4096]
+ */
+#include <cstdio>
+#include <chrono>
+#include <deque>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include "IrisTypes.hpp"
+#include "IrisQueue.hpp"
+
+using namespace Iris;
+using Clock = std::chrono::steady_clock;
+constexpr uint64_t  LATENCY_STRIDE  = 64;   // Every Nth entry is sampled
+
+// Move-only, as the pool's tasks are
+using Entry = std::unique_ptr<Clock::time_point>;
+struct LockedDeque {
+    Mutex               mutex;
+    std::deque<Entry>   entries;
+    bool try_push       (Entry&& entry)
+    {
+        MutexLock lock (mutex);
+        entries.push_back(std::move(entry));
+        return true;
+    }
+    bool try_pop        (Entry& entry)
+    {
+        MutexLock lock (mutex);
+        if (entries.empty()) return false;
+        entry = std::move(entries.front());
+        entries.pop_front();
+        return true;
+    }
+};
+struct Measurement {
+    double              entries_per_second;
+    double              p50_us;
+    double              p99_us;
+};
+template <class Queue>
+Measurement RUN (Queue& queue, uint32_t producers, uint32_t consumers, uint64_t entries)
+{
+    const uint64_t total = entries * producers;
+    std::atomic<uint64_t> popped {0};
+    std::vector<std::vector<double>> latencies (consumers);
+    std::vector<std::thread> threads;
+    const auto start = Clock::now();
+    for (uint32_t producer = 0; producer < producers; ++producer)
+        threads.emplace_back([&queue, entries]() {
+            for (uint64_t index = 0; index < entries; ++index) {
+                auto entry = std::make_unique<Clock::time_point>(Clock::now());
+                while (!queue.try_push(std::move(entry))) std::this_thread::yield();
+            }
+        });
+    for (uint32_t consumer = 0; consumer < consumers; ++consumer)
+        threads.emplace_back([&queue, &popped, &latencies, consumer, total]() {
+            auto& samples = latencies[consumer];
+            Entry entry;
+            while (popped.load(std::memory_order_relaxed) < total) {
+                if (!queue.try_pop(entry)) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (popped.fetch_add(1, std::memory_order_relaxed) % LATENCY_STRIDE == 0)
+                    samples.push_back(std::chrono::duration<double, std::micro>
+                                      (Clock::now() - *entry).count());
+            }
+        });
+    for (auto& thread : threads) thread.join();
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    
+    std::vector<double> samples;
+    for (auto& consumer : latencies) samples.insert(samples.end(), consumer.begin(), consumer.end());
+    std::sort(samples.begin(), samples.end());
+    if (samples.empty()) samples.push_back(0);
+    return Measurement {
+        .entries_per_second = total / seconds,
+        .p50_us             = samples[samples.size() / 2],
+        .p99_us             = samples[samples.size() * 99 / 100],
+    };
+}
+int main (int argc, char const* argv[])
+{
+    const uint32_t max_threads  = argc > 1 ? std::stoul(argv[1]) : 8;
+    const uint64_t entries      = argc > 2 ? std::stoull(argv[2]) : 1000000;
+    const size_t   capacity     = argc > 3 ? std::stoull(argv[3]) : 4096;
+    
+    printf("%9s %9s | %14s %10s %10s | %14s %10s %10s\n", "producers", "consumers",
+           "ring (M/s)", "p50 us", "p99 us", "locked (M/s)", "p50 us", "p99 us");
+    for (uint32_t producers = 1; producers <= max_threads; producers *= 2)
+        for (uint32_t consumers = 1; consumers <= max_threads; consumers *= 2) {
+            FIFO2::Ring<Entry> ring (capacity);
+            LockedDeque locked;
+            auto bounded    = RUN(ring, producers, consumers, entries);
+            auto unbounded  = RUN(locked, producers, consumers, entries);
+            printf("%9u %9u | %14.2f %10.1f %10.1f | %14.2f %10.1f %10.1f\n", producers, consumers,
+                   bounded.entries_per_second / 1e6, bounded.p50_us, bounded.p99_us,
+                   unbounded.entries_per_second / 1e6, unbounded.p50_us, unbounded.p99_us);
+        }
+    return 0;
+}
@@ -0,0 +1,206 @@
+/**
+ * @file IrisViewportBenchmark.cpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief Viewport load time: one tile batch request against individual tile requests.
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ * Loads the tiles of a viewport (tile indices within one layer of a slide)
+ * from a running Iris RESTful server `viewports` times in each of two ways:
+ *  - individual:   one GET per tile, spread over `connections` keep-alive
+ *                  connections (a browser opens 6 per host over HTTP/1.1)
+ *  - batch:        a single GET of the tile batch route (tiles?indices=)
+ *                  on one keep-alive connection
+ * and reports the median, 99th percentile and mean time to load the whole
+ * viewport, the bytes received per viewport, and failed loads. Connections
+ * are opened (and the tiles read once) before timing.
+ *
+ * Usage: IrisViewportBenchmark <host> <port> <slide> [layer = 0] [indices = 0-63]
+ *                              [connections = 6] [viewports = 100]
+ *
+ * The indices take the batch route's form (a,b,c-d). What the batch saves
+ * is round trips, so on loopback the two take about as long. To model a
+ * remote viewer add latency to the loopback interface, for example a 50 ms
+ * round trip (25 ms each way) with netem, and remove it afterwards:
+ *     sudo tc qdisc add dev lo root netem delay 25ms
+ *     sudo tc qdisc del dev lo root
+ */
+#include <boost/beast.hpp>
+#include <boost/asio.hpp>
+#include <cstdio>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <memory>
+#include <limits>
+#include <optional>
+#include <functional>
+#include <algorithm>
+
+namespace   net     = boost::asio;
+namespace   beast   = boost::beast;
+namespace   http    = beast::http;
+using       tcp     = net::ip::tcp;
+using       Clock   = std::chrono::steady_clock;
+
+struct Result {
+    std::vector<double>                 milliseconds;
+    uint64_t                            bytes       = 0;
+    uint64_t                            failures    = 0;
+};
+/**
+ * @brief One keep-alive client connection
+ *
+ * Connected on construction; get() writes a GET request and reads the whole
+ * response, then calls back with whether it succeeded and its body size.
+ */
+class Connection {
+    tcp::socket                         _socket;
+    beast::flat_buffer                  _buffer;
+    http::request<http::empty_body>     _request;
+    std::optional<http::response_parser<http::string_body>> _parser;
+public:
+    explicit Connection                 (net::io_context& context, const tcp::resolver::results_type& endpoints,
+                                         const std::string& host) :
+    _socket                             (context),
+    _request                            (http::verb::get, "/", 11)
+    {
+        net::connect(_socket, endpoints);
+        _socket.set_option(tcp::no_delay(true));
+        _request.set(http::field::host, host);
+        _request.set(http::field::user_agent, "IrisViewportBenchmark");
+        _request.keep_alive(true);
+    }
+    Connection                          (const Connection&) = delete;
+    Connection& operator =              (const Connection&) = delete;
+    template <class Handler>
+    void get                            (const std::string& target, Handler&& handler)
+    {
+        _request.target(target);
+        http::async_write(_socket, _request, [this, handler = std::move(handler)]
+                          (beast::error_code error, size_t) mutable {
+            if (error) return handler(false, size_t(0));
+            _parser.emplace();
+            _parser->body_limit(std::numeric_limits<std::uint64_t>::max());
+            http::async_read(_socket, _buffer, *_parser, [this, handler = std::move(handler)]
+                             (beast::error_code error, size_t) mutable {
+                if (error) return handler(false, size_t(0));
+                auto& response = _parser->get();
+                handler(response.result() == http::status::ok, response.body().size());
+            });
+        });
+    }
+};
+// Expand the batch route's index list (a,b,c-d) into individual indices
+std::vector<uint32_t> PARSE_INDICES (const std::string& indices)
+{
+    std::vector<uint32_t> result;
+    size_t begin = 0;
+    while (begin < indices.size()) {
+        size_t end = indices.find(',', begin);
+        if (end == std::string::npos) end = indices.size();
+        const std::string item = indices.substr(begin, end - begin);
+        const size_t dash = item.find('-');
+        const uint32_t first = std::stoul(item.substr(0, dash));
+        const uint32_t last = dash == std::string::npos ? first : std::stoul(item.substr(dash + 1));
+        for (uint32_t index = first; index <= last; ++index) result.push_back(index);
+        begin = end + 1;
+    }
+    return result;
+}
+// Load every target, each connection issuing the next unrequested one as it completes
+double LOAD_VIEWPORT (net::io_context& context, std::vector<std::unique_ptr<Connection>>& connections,
+                      const std::vector<std::string>& targets, Result& result)
+{
+    size_t next = 0;
+    bool failed = false;
+    std::function<void(Connection&)> issue = [&](Connection& connection) {
+        if (next == targets.size()) return;
+        connection.get(targets[next++], [&](bool ok, size_t bytes) {
+            if (!ok) failed = true;
+            result.bytes += bytes;
+            issue(connection);
+        });
+    };
+    const auto start = Clock::now();
+    for (auto& connection : connections) issue(*connection);
+    context.run();
+    context.restart();
+    const double milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    if (failed) ++result.failures;
+    else result.milliseconds.push_back(milliseconds);
+    return milliseconds;
+}
+void PRINT_RESULT (const char* mode, Result& result, uint32_t viewports)
+{
+    auto& times = result.milliseconds;
+    std::sort(times.begin(), times.end());
+    double mean = 0;
+    for (auto time : times) mean += time;
+    if (times.size()) mean /= times.size();
+    else times.push_back(0);
+    printf("%12s %10.2f %10.2f %10.2f %14.1f %8llu\n", mode, times[times.size() / 2],
+           times[times.size() * 99 / 100], mean, result.bytes / 1024.0 / viewports,
+           (unsigned long long)result.failures);
+}
+int main (int argc, char const* argv[])
+{
+    if (argc < 4) {
+        fprintf(stderr, "Usage: %s <host> <port> <slide> [layer = 0] [indices = 0-63] "
+                        "[connections = 6] [viewports = 100]\n", argv[0]);
+        return 1;
+    }
+    const std::string host      = argv[1];
+    const std::string slide     = argv[3];
+    const uint32_t layer        = argc > 4 ? std::stoul(argv[4]) : 0;
+    const std::string indices   = argc > 5 ? argv[5] : "0-63";
+    const uint32_t connections  = argc > 6 ? std::max<uint32_t>(std::stoul(argv[6]), 1) : 6;
+    const uint32_t viewports    = argc > 7 ? std::max<uint32_t>(std::stoul(argv[7]), 1) : 100;
+
+    const std::string layer_target = "/slides/" + slide + "/layers/" + std::to_string(layer);
+    std::vector<std::string> individual;
+    try {
+        for (auto index : PARSE_INDICES(indices))
+            individual.push_back(layer_target + "/tiles/" + std::to_string(index));
+    } catch (std::exception&) {
+        fprintf(stderr, "[ERROR] Expected tile indices of the form a,b,c-d; got %s\n", indices.c_str());
+        return 1;
+    }
+    const std::vector<std::string> batch { layer_target + "/tiles?indices=" + indices };
+
+    net::io_context context (1);
+    std::vector<std::unique_ptr<Connection>> pool, single;
+    try {
+        auto endpoints = tcp::resolver(context).resolve(argv[1], argv[2]);
+        for (uint32_t connection = 0; connection < connections; ++connection)
+            pool.push_back(std::make_unique<Connection>(context, endpoints, host));
+        single.push_back(std::make_unique<Connection>(context, endpoints, host));
+    } catch (std::exception& error) {
+        fprintf(stderr, "[ERROR] Failed to connect to %s:%s: %s\n", argv[1], argv[2], error.what());
+        return 1;
+    }
+
+    // Read the tiles once so that both modes are served from a warm slide
+    Result warm;
+    LOAD_VIEWPORT(context, pool, individual, warm);
+    LOAD_VIEWPORT(context, single, batch, warm);
+    if (warm.failures) {
+        fprintf(stderr, "[ERROR] The server failed to return the viewport tiles of %s\n", slide.c_str());
+        return 1;
+    }
+
+    Result individually, batched;
+    for (uint32_t viewport = 0; viewport < viewports; ++viewport) {
+        LOAD_VIEWPORT(context, pool, individual, individually);
+        LOAD_VIEWPORT(context, single, batch, batched);
+    }
+    printf("Viewport of %zu tiles; individual requests over %u connections\n",
+           individual.size(), connections);
+    printf("%12s %10s %10s %10s %14s %8s\n", "mode", "p50 ms", "p99 ms", "mean ms",
+           "KiB/viewport", "failed");
+    PRINT_RESULT("individual", individually, viewports);
+    PRINT_RESULT("batch", batched, viewports);
+    return 0;
+}
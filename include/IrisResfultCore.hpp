@@ -29,5 +29,11 @@ Server create_server (const ServerCreateInfo& info);
  * @return Result flag indicating success or failure
  */
 Result server_listen (const Server&, uint16_t port);
+/**
+ * @brief Sample the server's runtime counters
+ * 
+ * @return ServerStatistics snapshot (zeroed if the server is invalid)
+ */
+ServerStatistics get_server_statistics (const Server&);
 } // END RESTFUL NAMESPACE
 } // END IRIS NAMESPACE
@@ -11,6 +11,7 @@
  * 
  */
 
+#include <variant>
 #include <filesystem>
 #include "IrisCodecTypes.hpp"
 #ifndef IrisRestfulTypes_hpp
@@ -34,15 +35,24 @@ using ASIOGuard_t                   = net::executor_work_guard<net::io_context::
 using ASIOResolver_t                = ip::tcp::resolver;
 using ASIOEndpoint_t                = ip::tcp::endpoint;
 using ASIOAcceptor_t                = ip::tcp::acceptor;
-using ASIOSocket_t                  = ip::tcp::socket;
-using ASIOStream_t                  = beast::tcp_stream;
-using ASIOSslStream_t               = ssl::stream<beast::tcp_stream>;
+// Sessions run on a strand of concrete type; a type-erased executor
+// (any_io_executor) heap allocates a strand copy for every operation.
+using ASIOExecutor_t                = net::strand<net::io_context::executor_type>;
+using ASIOSocket_t                  = ip::tcp::socket::rebind_executor<ASIOExecutor_t>::other;
+using ASIOTimer_t                   = net::steady_timer::rebind_executor<ASIOExecutor_t>::other;
+using ASIOStream_t                  = beast::basic_stream<ip::tcp, ASIOExecutor_t>;
+using ASIOSslStream_t               = ssl::stream<ASIOStream_t>;
+using ASIOKtlsStream_t              = class __INTERNAL__KtlsStream;
 using ASIOBuffer_t                  = beast::flat_buffer;
-using HTTPRequest_t                 = http::request<http::string_body>;
+// Request header fields are allocated from the session. See IrisRestfulNetworking.cpp
+template <class T> class RequestAllocator;
+using HTTPRequestFields_t           = http::basic_fields<RequestAllocator<char>>;
+using HTTPRequest_t                 = http::request<http::string_body, HTTPRequestFields_t>;
 using HTTPResponse_t                = http::response<http::string_body>;
 using HTTPResponseBuffer_t          = http::response<http::buffer_body>;
 using HTTPResponseFile_t            = http::response<http::file_body>;
-using HTTPRequestParser_t           = http::request_parser<http::string_body>;
+using HTTPResponseHeader_t          = http::response<http::empty_body>;
+using HTTPRequestParser_t           = http::request_parser<http::string_body, RequestAllocator<char>>;
 #else
 class ASIOError_t;
 class ASIOContext_t;
@@ -51,9 +61,12 @@ class ASIOGuard_t;
 class ASIOResolver_t;
 class ASIOEndpoint_t;
 class ASIOAcceptor_t;
+class ASIOExecutor_t;
 class ASIOSocket_t;
+class ASIOTimer_t;
 class ASIOStream_t;
 class ASIOSslStream_t;
+class ASIOKtlsStream_t;
 class ASIOFlatBuffer_t;
 class HTTPRequest_t;
 class ASIOBuffer_t;
@@ -61,11 +74,13 @@ class HTTPRequest_t;
 class HTTPResponse_t;
 class HTTPResponseBuffer_t;
 class HTTPResponseFile_t;
+class HTTPResponseHeader_t;
 class HTTPRequestParser_t;
 #endif
 class   __INTERNAL__Networking;
 struct  __INTERNAL__Session;
 struct  __INTERNAL__SslSession;
+struct  __INTERNAL__KtlsSession;
 class   __INTERNAL__Slide;
 using ASIOContext                   = std::shared_ptr<ASIOContext_t>;
 using SSLContext                    = std::shared_ptr<SSLContext_t>;
@@ -75,18 +90,66 @@ using ASIOEndpoint                  = std::shared_ptr<ASIOEndpoint_t>;
 using ASIOAcceptor                  = std::shared_ptr<ASIOAcceptor_t>;
 using ASIOStream                    = std::unique_ptr<ASIOStream_t>;
 using ASIOSslStream                 = std::unique_ptr<ASIOSslStream_t>;
+using ASIOKtlsStream                = std::unique_ptr<ASIOKtlsStream_t>;
 using ASIOBuffer                    = std::shared_ptr<ASIOBuffer_t>;
 using HTTPRequest                   = std::shared_ptr<HTTPRequest_t>;
 using HTTPResponse                  = std::shared_ptr<HTTPResponse_t>;
 using HTTPResponseBuffer            = std::shared_ptr<HTTPResponseBuffer_t>;
 using HTTPResponseFile              = std::shared_ptr<HTTPResponseFile_t>;
+using HTTPResponseHeader            = std::shared_ptr<HTTPResponseHeader_t>;
 using HTTPRequestParser             = std::shared_ptr<HTTPRequestParser_t>;
 using Networking                    = std::unique_ptr<__INTERNAL__Networking>;
 using Session                       = std::shared_ptr<__INTERNAL__Session>;
 using SslSession                    = std::shared_ptr<__INTERNAL__SslSession>;
+using KtlsSession                   = std::shared_ptr<__INTERNAL__KtlsSession>;
 using Slide                         = std::shared_ptr<__INTERNAL__Slide>;
+using SlideHandle                   = uint32_t; // Interned slide identifier
+constexpr SlideHandle NULL_SLIDE_HANDLE = UINT32_MAX;
 using SlideInfo                     = IrisCodec::SlideInfo;
 
+/**
+ * @brief How tile bytes are written to the client connection
+ *
+ * TILE_DELIVERY_BUFFER writes the tile from the slide's memory mapping through
+ * the user-space stream. TILE_DELIVERY_SENDFILE writes the response headers and
+ * then hands the slide file descriptor and tile byte range to the kernel
+ * (sendfile), skipping user space entirely. Sendfile is only used on plain HTTP
+ * streams on platforms that support it; TLS streams fall back to buffered delivery.
+ */
+enum TileDelivery : uint8_t {
+    TILE_DELIVERY_BUFFER            = 0,
+    TILE_DELIVERY_SENDFILE,
+};
+/**
+ * @brief Where GET requests are processed
+ *
+ * REQUEST_DISPATCH_WORKER hands every request from the network (reactor)
+ * thread to the server's worker pool, so that no file system access can stall
+ * the reactor. REQUEST_DISPATCH_INLINE serves tile requests whose slide the
+ * connection already has open and whose tile bytes are resident in the page
+ * cache (mincore) directly on the reactor thread, skipping both thread hops;
+ * every other request (cold tiles, slide opens, metadata, files) is still
+ * handed to the pool.
+ */
+enum RequestDispatch : uint8_t {
+    REQUEST_DISPATCH_WORKER         = 0,
+    REQUEST_DISPATCH_INLINE,
+};
+/**
+ * @brief How the network (reactor) threads are organized
+ *
+ * NETWORK_REACTORS_SHARED runs IRIS_CONCURRENCY * 3 threads on one io_context
+ * with a single acceptor; each connection is serialized by a strand and its
+ * handlers may run on any of the threads. NETWORK_REACTORS_PER_CORE runs one
+ * io_context per available core, each on a single thread pinned to that core
+ * with its own SO_REUSEPORT acceptor on the port. The kernel spreads incoming
+ * connections across the acceptors, and a connection's handlers then only run
+ * on the core that accepted it, without strands (Linux only).
+ */
+enum NetworkReactors : uint8_t {
+    NETWORK_REACTORS_SHARED         = 0,
+    NETWORK_REACTORS_PER_CORE,
+};
 /**
  * @brief Information required to configure the server
  * 
@@ -115,60 +178,205 @@ struct ServerCreateInfo {
     std::filesystem::path   doc_root;  /*!< Optional document root when acting as a websever */
     std::string             cors;      /*!< Optional cross origin policy*/
     bool                    https=true;/*!< Default enable TLS layer for HTTPS messages*/
+    TileDelivery            delivery = TILE_DELIVERY_BUFFER; /*!< Tile body delivery mode*/
+    RequestDispatch         dispatch = REQUEST_DISPATCH_WORKER; /*!< Where tile requests are processed*/
+    NetworkReactors         reactors = NETWORK_REACTORS_SHARED; /*!< Shared or per-core network reactors*/
+    bool                    ktls=false;/*!< Opt-in kernel TLS offload (Linux); requires https*/
+    uint32_t                retain_slides=0;    /*!< Slides kept open after their last session leaves (0 disables)*/
+    uint64_t                retain_bytes=0;     /*!< Optional mapped-bytes budget for retained slides (0 for none)*/
+    uint32_t                retain_ttl=600;     /*!< Seconds an unused retained slide stays open*/
+    std::filesystem::path   cache_dir; /*!< Optional persistent slide-open cache directory (see IrisRestfulCache.hpp)*/
+    bool                    catalog=false;/*!< Scan slide_dir at startup for listings; with watch, lookups use it too*/
+    bool                    watch=false;  /*!< Watch slide_dir for new, replaced, and removed slides (Linux)*/
+    uint32_t                readahead=0;        /*!< In-flight neighboring tile read-ahead tasks (0 disables)*/
+    bool                    warm_api=false;     /*!< Enable the slide warm-up API (POST / GET / DELETE /slides/<id>/warm)*/
+    uint32_t                memory_pressure=0;  /*!< cgroup memory pressure (PSI some avg10, percent) that releases cold slides' pages (0 disables; Linux)*/
+    uint32_t                cache_max_age=0;    /*!< Cache-Control max-age of tiles and metadata (0 requires revalidation)*/
+    bool                    cache_immutable=false;/*!< Mark tiles and metadata immutable; only if slides are never replaced*/
+};
+/**
+ * @brief Runtime counters reported by a running server
+ *
+ * Slide lookups are counted as hits when served by a slide that is already
+ * open (in use by a session or retained) and as misses when the slide file
+ * had to be opened. Evictions count retained slides released by the
+ * retention policy (count / bytes budget or idle time-to-live).
+ * Tile bodies are written from the slide mapping (or sent from the file);
+ * the only user-space copy is the kTLS stream gathering a short header and
+ * body into one TLS record, counted in bytes_copied.
+ */
+struct ServerStatistics {
+    uint64_t                slide_hits          = 0;
+    uint64_t                slide_misses        = 0;
+    uint64_t                slide_evictions     = 0;
+    uint32_t                slides_retained     = 0;
+    uint64_t                bytes_retained      = 0;
+    uint32_t                slides_pinned       = 0;    /*!< Slides pinned open by the warm-up API*/
+    uint64_t                tiles_inline        = 0;    /*!< Tile requests served on the reactor thread*/
+    uint64_t                tiles_offloaded     = 0;    /*!< Tile requests handed to the worker pool*/
+    uint64_t                tile_latency_p50    = 0;    /*!< Tile request service time (us), receipt to response*/
+    uint64_t                tile_latency_p99    = 0;
+    uint64_t                tile_bytes          = 0;    /*!< Tile body bytes written (tiles and tile batches)*/
+    uint64_t                bytes_copied        = 0;    /*!< Response bytes copied in user space before writing*/
+    uint64_t                readahead_issued    = 0;    /*!< Tile ranges advised into the page cache*/
+    uint64_t                readahead_predicted = 0;    /*!< ...of which predicted from session motion*/
+    uint64_t                readahead_dropped   = 0;    /*!< Served tiles not followed (in-flight budget reached)*/
+    uint64_t                readahead_hits      = 0;    /*!< Served tiles that had been advised*/
+    uint64_t                readahead_predicted_hits = 0;/*!< Served tiles that had been predicted*/
+    uint64_t                readahead_misses    = 0;    /*!< Served tiles that had not been advised*/
+    uint64_t                readahead_wasted_bytes = 0; /*!< Bytes advised and not (yet) served*/
 };
 
-struct GetRequest {
-    enum Protocol {
-        GET_REQUEST_MALFORMED       = 0,
-        GET_REQUEST_IRIS,
-        GET_REQUEST_DICOM,
-        GET_REQUEST_FILE,           // Optional File Server Fn-ality
-    }           protocol            = GET_REQUEST_MALFORMED;
-    enum Type {
-        GET_REQUEST_UNDEFINED       = 0,
-        GET_REQUEST_TILE,
-        GET_REQUEST_METADATA,
-//        GET_REQUEST_THUMBNAIL,
-//        GET_REQUEST_SLIDE_LABEL,
-    }           type                = GET_REQUEST_UNDEFINED;
-    std::string error_msg;
-    virtual ~GetRequest()           {}
+/**
+ * @brief Parsed GET requests
+ *
+ * The router (parse_get_request) returns one of these by value within a
+ * GetRequest variant. String views reference the request target itself;
+ * they are only valid while the target string they were parsed from lives.
+ */
+enum RequestProtocol : uint8_t {
+    REQUEST_PROTOCOL_IRIS           = 0,
+    REQUEST_PROTOCOL_DICOM,         // WADO-RS
 };
-struct GetFileRequest : GetRequest {
-    std::string mime;
-    std::string path;
+enum RequestMethod : uint8_t {
+    REQUEST_METHOD_GET              = 0,    // GET and HEAD
+    REQUEST_METHOD_POST,
+    REQUEST_METHOD_DELETE,
 };
-struct GetTileRequest : GetRequest {
-    std::string id;
+struct GetMalformedRequest {
+    std::string_view error_msg;     // Static description of the problem
+};
+struct GetFileRequest {             // Optional File Server Fn-ality
+    std::string_view mime;
+    std::string_view path;
+};
+struct GetTileRequest {
+    RequestProtocol protocol        = REQUEST_PROTOCOL_IRIS;
+    std::string_view id;
     uint32_t    layer               = 0;
     uint32_t    tile                = 0;
 };
-struct GetResponse {
+struct GetTileBatchRequest {        // Tiles of one layer (indices=a,b,c-d or frames/a,b,c)
+    RequestProtocol protocol        = REQUEST_PROTOCOL_IRIS;
+    std::string_view id;
+    uint32_t    layer               = 0;
+    std::string_view indices;
+};
+struct GetViewportRequest {         // Tiles covering a rectangle, center-out
+    std::string_view id;
+    uint32_t    layer               = 0;
+    uint32_t    x                   = 0;
+    uint32_t    y                   = 0;
+    uint32_t    width               = 0;
+    uint32_t    height              = 0;
+    bool        slide_space         = false;   // Rectangle in slide (scale 1.0) rather than layer pixels
+};
+struct GetMetadataRequest {
+    RequestProtocol protocol        = REQUEST_PROTOCOL_IRIS;
+    std::string_view id;
+    int32_t     instance            = -1;      // DICOM instance (layer) metadata; -1 for the series
+};
+struct GetSlideListRequest {        // Paginated slide catalog listing
+    uint32_t    offset              = 0;
+    uint32_t    limit               = 100;
+};
+struct WarmSlideRequest {           // GET progress, POST warm and pin, DELETE unpin
+    std::string_view id;
+    std::string_view layers;        // <a>,<b>-<c>; empty for every layer
+};
+using GetRequest = std::variant<
+    GetMalformedRequest,
+    GetFileRequest,
+    GetTileRequest,
+    GetTileBatchRequest,
+    GetViewportRequest,
+    GetMetadataRequest,
+    GetSlideListRequest,
+    WarmSlideRequest
+>;
+/**
+ * @brief GET responses
+ *
+ * The server produces one of these on a worker thread and moves it, by value
+ * within a GetResponse variant, to the networking layer that writes it.
+ */
+struct GetErrorResponse {
     enum Type {
-        GET_RESPONSE_UNDEFINED      = 0,
-        GET_RESPONSE_MALFORMED_REQ,
+        GET_RESPONSE_MALFORMED_REQ  = 0,
         GET_RESPONSE_FILE_NOT_FOUND,
-        GET_RESPONSE_FILE,          // Optional File Server Fn-ality
-        GET_RESPONSE_TILE,
-        GET_RESPONSE_METADATA,
-    }           type                = GET_RESPONSE_UNDEFINED;
-    bool        keep_alive          = false;
+        GET_RESPONSE_METHOD_NOT_ALLOWED,
+    }           type                = GET_RESPONSE_MALFORMED_REQ;
     std::string error_msg;
-    virtual ~GetResponse(){}
 };
-struct PostResponse;
-struct PutResponse;
-struct GetFileResponse : GetResponse {
+struct GetFileResponse {            // Optional File Server Fn-ality
     std::string mime;
     std::filesystem::path address;
 };
-struct GetTileResponse : GetResponse {
-    Buffer      pixelData           = nullptr;
-    ~GetTileResponse()              {}
+/**
+ * @brief View of a single tile's encoded bytes within a slide file
+ *
+ * The data pointer references the slide's read-only file mapping directly;
+ * it is only valid while the owning slide (and thus its mapping) is alive.
+ */
+struct TileData {
+    const BYTE* data                = nullptr;
+    uint64_t    offset              = 0;
+    uint32_t    size                = 0;
+};
+struct GetTileResponse {
+    Slide       slide               = nullptr; // Pins the slide mapping until sent
+    TileData    tile;
+    uint32_t    layer               = 0;
+    uint32_t    index               = 0;       // Tile index within the layer (for its ETag)
+};
+struct BatchTile {
+    uint32_t    index               = 0;
+    TileData    tile;
+};
+struct GetTileBatchResponse {       // Tile batches, viewports, and DICOM frames; sent as a multipart body
+    RequestProtocol protocol        = REQUEST_PROTOCOL_IRIS; // multipart/mixed or (DICOM) multipart/related
+    Slide       slide               = nullptr; // Pins the slide mapping until sent
+    uint32_t    layer               = 0;
+    std::vector<BatchTile> tiles;   // In the requested order
+};
+struct GetMetadataResponse {
+    RequestProtocol protocol        = REQUEST_PROTOCOL_IRIS; // Iris JSON or DICOM JSON
+    Slide       slide               = nullptr; // Serves the slide's serialized metadata
+    int32_t     instance            = -1;      // DICOM instance (layer); -1 for the series
+};
+/**
+ * @brief Catalog entry of a slide within the slide root directory
+ */
+struct SlideCatalogEntry {
+    std::string id;
+    uint64_t    bytes               = 0;
+    Extent      extent;
+};
+struct GetSlideListResponse {
+    uint64_t    total               = 0;
+    uint32_t    offset              = 0;
+    std::vector<SlideCatalogEntry> slides;
 };
-struct GetMetadataResponse : GetResponse {
-    SlideInfo   slideInfo;
+struct WarmSlideResponse {          // Progress of the slide's latest warm-up
+    std::string id;
+    bool        pinned              = false;
+    bool        warming             = false; // Still counting or warming tiles
+    uint32_t    tiles               = 0;
+    uint32_t    tiles_warmed        = 0;
+    uint64_t    bytes               = 0;
+    uint64_t    bytes_warmed        = 0;
 };
+using GetResponse = std::variant<
+    GetErrorResponse,
+    GetTileResponse,
+    GetTileBatchResponse,
+    GetMetadataResponse,
+    GetSlideListResponse,
+    WarmSlideResponse,
+    GetFileResponse
+>;
+struct PostResponse;
+struct PutResponse;
 struct PostRequest;
 struct PutRequest;
 
@@ -182,10 +390,6 @@ struct TileResponse {
     }           flag                = RESPONSE_UNDEFINED;
     Buffer      tile_data           = nullptr;
 };
-struct GetMetadataRequest : public GetRequest {
-    std::string id;
-    ~GetMetadataRequest()           {}
-};
 struct MetadataResponse {
     
 };
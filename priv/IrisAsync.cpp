@@ -6,8 +6,10 @@
 //
 #include <assert.h>
 #include <sstream>
+#include <algorithm>
 #include <iostream>
 #include "IrisTypes.hpp"
+#include "IrisFunction.hpp"
 #include "IrisQueue.hpp"
 #include "IrisAsync.hpp"
 
@@ -23,15 +25,124 @@ void __INTERNAL__Fence::wait_on_signal () {
     complete.wait(false);
 }
 
+// The pool and index of the worker running on this thread, if any
+thread_local struct {
+    const __INTERNAL__Pool*         pool            = nullptr;
+    uint32_t                        index           = 0;
+} CURRENT_WORKER;
+
+bool TaskList::try_push(Callback&& task)
+{
+    return spilled.load(std::memory_order_acquire) == 0 && ring.try_push(std::move(task));
+}
+void TaskList::push(Callback&& task)
+{
+    if (try_push(std::move(task))) return;
+    MutexLock lock (mutex);
+    overflow.push_back(std::move(task));
+    spilled.store(overflow.size(), std::memory_order_release);
+}
+bool TaskList::pop(Callback& task)
+{
+    // The ring holds the older tasks (see push)
+    if (ring.try_pop(task)) return true;
+    if (spilled.load(std::memory_order_acquire) == 0) return false;
+    MutexLock lock (mutex);
+    if (overflow.empty()) return false;
+    task = std::move(overflow.front());
+    overflow.pop_front();
+    spilled.store(overflow.size(), std::memory_order_release);
+    return true;
+}
+__INTERNAL__Worker::__INTERNAL__Worker()
+{
+    // Chain the whole arena into the free list
+    for (auto& slot : slots) {
+        slot.next   = free;
+        free        = &slot;
+    }
+}
+__INTERNAL__Worker::Slot* __INTERNAL__Worker::take_slot()
+{
+    // Once the free list runs dry, collect the slots thieves have returned
+    if (!free) free = returned.exchange(nullptr, std::memory_order_acquire);
+    Slot* slot = free;
+    if (slot) free = slot->next;
+    return slot;
+}
+bool __INTERNAL__Worker::push(Callback& task)
+{
+    const int64_t b = bottom.load(std::memory_order_relaxed);
+    const int64_t t = top.load(std::memory_order_acquire);
+    if (b - t >= CAPACITY) return false;
+    Slot* slot = take_slot();
+    if (!slot) return false;
+    slot->task = std::move(task);
+    tasks[b & MASK].store(slot, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+    return true;
+}
+__INTERNAL__Worker::Slot* __INTERNAL__Worker::pop_slot()
+{
+    const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+    if (t > b) {
+        // Empty
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    Slot* slot = tasks[b & MASK].load(std::memory_order_relaxed);
+    if (t == b) {
+        // The last task; race any thief for it
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                         std::memory_order_relaxed))
+            slot = nullptr;
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return slot;
+}
+bool __INTERNAL__Worker::pop(Callback& task)
+{
+    Slot* slot = pop_slot();
+    if (!slot) return false;
+    task        = std::move(slot->task);
+    slot->next  = free;
+    free        = slot;
+    return true;
+}
+bool __INTERNAL__Worker::steal(Callback& task)
+{
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b) return false;
+    Slot* slot = tasks[t & MASK].load(std::memory_order_relaxed);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                     std::memory_order_relaxed))
+        return false;
+    
+    // The slot is this thread's until it is handed back to the owner
+    task        = std::move(slot->task);
+    slot->next  = returned.load(std::memory_order_relaxed);
+    while (!returned.compare_exchange_weak(slot->next, slot, std::memory_order_release,
+                                           std::memory_order_relaxed));
+    return true;
+}
 __INTERNAL__Pool::__INTERNAL__Pool (uint32_t thread_pool_size) :
-_threads    (thread_pool_size),
+_threads    (std::max(thread_pool_size, 1U)),
+_workers    (std::make_unique<__INTERNAL__Worker[]>(_threads.size())),
+_signal     (0),
+_parked     (0),
 status      (POOL_ACTIVE)
 {
     // Start all of the callback threads
-    for (auto& thread : _threads)
-        thread = std::thread {
+    for (uint32_t index = 0; index < _threads.size(); ++index)
+        _threads[index] = std::thread {
             &__INTERNAL__Pool::process_tasks,
-            this
+            this, index
         };
 }
 __INTERNAL__Pool::~__INTERNAL__Pool ()
@@ -42,21 +153,69 @@ inline void WARN_INACTIVE_QUEUE()
 {
     std::cerr << "[WARNING] Iris Async Pool: Attempting to enqueue task to inactive queue\n";
 }
-void __INTERNAL__Pool::issue_task(const LambdaPtr &lambda)
+inline void RUN_TASK (Callback& task)
+{
+    // Invoke the callback method and then release
+    // it's context (to free captured vars).
+    try { task.callback(); }
+    catch (std::runtime_error& error) {
+        std::stringstream LOG;
+        LOG         << "[WARNING] Exception thrown on Arke Async callback thread: "
+                    << error.what() << "\n";
+        std::cerr   << LOG.str();
+    }
+    task.callback = nullptr;
+    
+    // If there is a fence, trigger it to release any waiting threads.
+    if (auto fence = std::move(task.fenceOptional)) {
+        fence->complete = true;
+        fence->complete.notify_all();
+    }
+}
+void __INTERNAL__Pool::wake()
+{
+    // Pairs with the worker announcing itself parked before its final check
+    // for tasks: either it sees the task or this sees it parked.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_parked.load(std::memory_order_relaxed) == 0) return;
+    _signal.fetch_add(1, std::memory_order_release);
+    _signal.notify_one();
+}
+bool __INTERNAL__Pool::submit(Callback&& callback, bool backpressure)
+{
+    // Workers of this pool keep the tasks they issue; other threads
+    // (and workers whose deque is full) share the injection queue.
+    if (CURRENT_WORKER.pool == this && _workers[CURRENT_WORKER.index].push(callback))
+        return wake(), true;
+    if (!backpressure) _tasks.push(std::move(callback));
+    else if (!_tasks.try_push(std::move(callback))) return false;
+    
+    // And wake a parked worker, if any
+    wake();
+    return true;
+}
+void __INTERNAL__Pool::issue_task(Task&& task)
 {
     // Return if the pool is not active / Shutting down
     if (status & POOL_TERMINATING) return WARN_INACTIVE_QUEUE();
     
     // Insert the task into the list.
-    _tasks.push(Callback{
-        .callback       = lambda,
+    submit(Callback{
+        .callback       = std::move(task),
         .fenceOptional  = nullptr,
     });
+}
+bool __INTERNAL__Pool::try_issue_task(Task&& task)
+{
+    // Return if the pool is not active / Shutting down
+    if (status & POOL_TERMINATING) return false;
     
-    // And notify any waiting implementation threads
-    _task_added.notify_one();
+    return submit(Callback{
+        .callback       = std::move(task),
+        .fenceOptional  = nullptr,
+    }, true);
 }
-Fence __INTERNAL__Pool::issue_task_with_fence(const LambdaPtr &lambda)
+Fence __INTERNAL__Pool::issue_task_with_fence(Task&& task)
 {
     // Return if the pool is not active / Shutting down
     if (status & POOL_TERMINATING) { WARN_INACTIVE_QUEUE(); return NULL; }
@@ -65,14 +224,11 @@ Fence __INTERNAL__Pool::issue_task_with_fence(const LambdaPtr &lambda)
     auto fence = std::make_shared<__INTERNAL__Fence>();
     
     // Insert the task into the list.
-    _tasks.push(Callback{
-        .callback       = lambda,
+    submit(Callback{
+        .callback       = std::move(task),
         .fenceOptional  = fence,
     });
     
-    // And notify any waiting implementation threads
-    _task_added.notify_one();
-    
     return fence;
 }
 void __INTERNAL__Pool::wait_until_complete ()
@@ -81,7 +237,8 @@ void __INTERNAL__Pool::wait_until_complete ()
         auto STATUS = status.load();
         while(!status.compare_exchange_weak(STATUS, (__status)(STATUS|POOL_DRAINING)));
     }
-    _task_added.notify_all();                                   // Ensure all exit the wait.
+    _signal.fetch_add(1);                                       // Ensure all exit the wait.
+    _signal.notify_all();
     for (auto& thread : _threads)                               // Iterate over each worker
         if (thread.joinable())                                  // Check if it is outstanding; if so...
             thread.join();                                      // Merge threads and wait for it to complete.
@@ -93,72 +250,83 @@ void __INTERNAL__Pool::terminate()
         auto STATUS = status.load();
         while(!status.compare_exchange_weak(STATUS, (__status)(STATUS|POOL_TERMINATING)));
     }
-    _task_added.notify_all();                                   // Ensure all exit the wait.
+    _signal.fetch_add(1);                                       // Ensure all exit the wait.
+    _signal.notify_all();
     for (auto& thread : _threads)                               // Iterate over each worker
         if (thread.joinable())                                  // Check if it is outstanding; if so...
             thread.join();                                      // Merge threads and wait for it to complete.
+    
+    // Release the tasks left in the worker deques without running them
+    Callback task;
+    for (uint32_t index = 0; index < _threads.size(); ++index)
+        while (_workers[index].pop(task)) task = Callback{};
     status.store(POOL_INACTIVE);
 }
 void __INTERNAL__Pool::reset() {
     wait_until_complete();
     status.store(POOL_ACTIVE);
-    for (auto& thread : _threads)
-        thread = std::thread {
+    for (uint32_t index = 0; index < _threads.size(); ++index)
+        _threads[index] = std::thread {
             &__INTERNAL__Pool::process_tasks,
-            this
+            this, index
         };
 }
-void __INTERNAL__Pool::process_tasks() {
+bool __INTERNAL__Pool::next_task(uint32_t index, Callback& task, uint32_t& tick)
+{
+    // Periodically favor the injection queue over this worker's own tasks
+    if (++tick % GLOBAL_INTERVAL == 0 && _tasks.pop(task)) return true;
+    
+    if (_workers[index].pop(task)) return true;
+    if (_tasks.pop(task)) return true;
+    
+    // Steal, starting from a different victim each time
+    const uint32_t count = static_cast<uint32_t>(_threads.size());
+    for (uint32_t offset = 1; offset < count; ++offset)
+        if (_workers[(index + tick + offset) % count].steal(task)) return true;
+    return false;
+}
+void __INTERNAL__Pool::process_tasks(uint32_t index) {
     // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ //
     //  HEADER BLOCK                                    //
     // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ //
-    using namespace FIFO2;
-    Callback callback_entry;
-    Iterator<Callback> __it = _tasks.begin();
-    MutexLock task_lock     = MutexLock(_task_added_mtx, std::defer_lock);
+    Callback task;
+    uint32_t tick           = 0;
+    CURRENT_WORKER          = {this, index};
 
-    while (status == POOL_ACTIVE) {
-        // Wait for a task to be issued.
-        try {
-            task_lock.lock();
-            _task_added.wait_for(task_lock, std::chrono::seconds(1)); // Check every second
-            task_lock.unlock();
-        } catch (...) {
-            if (task_lock.owns_lock())
-                task_lock.unlock();
-            task_lock = MutexLock(_task_added_mtx, std::defer_lock);
+    while (!(status & POOL_TERMINATING)) {
+        if (next_task(index, task, tick)) {
+            RUN_TASK(task);
             continue;
         }
         
-        // Attempt to implement those tasks.
-        try {
-            while (__it.pop(callback_entry) && (status ^ POOL_TERMINATING)) {
-                // Get the entry at the iterator's location.
-
-                // Invoke the callback method and then release 
-                // it's context (to free captured vars).
-                callback_entry.callback();
-                callback_entry.callback = nullptr;
-                
-                // If there is a fence, trigger it to release any waiting threads.
-                auto fence = callback_entry.fenceOptional;
-                if (fence) {
-                    fence->complete = true;
-                    fence->complete.notify_all();
-                }
-            }
-        } catch (std::runtime_error& error) {
-            std::stringstream LOG;
-            LOG         << "[WARNING] Exception thrown on Arke Async callback thread: "
-                        << error.what() << "\n";
-            std::cerr   << LOG.str();
-            
-    
-            if (task_lock.owns_lock())
-                task_lock.unlock();
-            task_lock = MutexLock(_task_added_mtx, std::defer_lock);
+        // Nothing to do: spin briefly, as tasks often arrive in bursts
+        bool found = false;
+        for (uint32_t spin = 0; spin < SPIN_COUNT && !found; ++spin) {
+            std::this_thread::yield();
+            found = next_task(index, task, tick);
+        }
+        if (found) {
+            RUN_TASK(task);
+            continue;
+        }
+        
+        // Then park. Announce it before the final check for tasks (see wake)
+        const uint32_t epoch = _signal.load();
+        _parked.fetch_add(1);
+        if (next_task(index, task, tick)) {
+            _parked.fetch_sub(1);
+            RUN_TASK(task);
+            continue;
+        }
+        // A draining pool stops once no work is left anywhere
+        if (status != POOL_ACTIVE) {
+            _parked.fetch_sub(1);
+            break;
         }
+        _signal.wait(epoch);
+        _parked.fetch_sub(1);
     }
+    CURRENT_WORKER          = {};
 }
 } // END ASYNC NAMESPACE
 } // END IRIS NAMESAPCE
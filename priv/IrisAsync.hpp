@@ -7,6 +7,9 @@
 
 #ifndef IrisAsync_h
 #define IrisAsync_h
+#include <deque>
+#include <memory>
+#include "IrisFunction.hpp"
 
 #ifndef IRIS_CONCURRENCY
 #define IRIS_CONCURRENCY std::thread::hardware_concurrency()
@@ -16,15 +19,79 @@ namespace Iris {
 namespace Async {
 using Fence         = std::shared_ptr<struct __INTERNAL__Fence>;
 using ThreadPool    = std::shared_ptr<class __INTERNAL__Pool>;
-using TaskList      = Iris::FIFO2::Queue<struct Callback>;
 
 ThreadPool createThreadPool (uint32_t thread_pool_size = IRIS_CONCURRENCY);
 
+/**
+ * @brief Move-only task with inline storage for the server's closures
+ *
+ * Tasks are moved (never copied) from the issuing thread through the pool's
+ * queues to the worker. Closures up to TASK_CAPACITY bytes (a pool or server
+ * pointer, a couple of shared pointers, a vector and a timestamp) are stored
+ * within the task itself; issuing them does not allocate. A larger closure
+ * does not compile (see InlineFunction): pass bulky state by pointer or
+ * handle instead, as read-ahead does with its target lists.
+ */
+constexpr size_t TASK_CAPACITY = 64;
+using Task = InlineFunction<void(), TASK_CAPACITY>;
+
+/**
+ * @brief Event counter sharded across threads
+ *
+ * Counters bumped on every request (e.g. slide hits, tiles served) would
+ * otherwise bounce one cache line between every core serving requests. Each
+ * thread increments the shard it was assigned on first use; a read sums the
+ * shards and is only approximate while increments are in progress.
+ */
+class ShardedCounter {
+    static constexpr uint32_t           SHARDS      = 32;
+    struct alignas(64) Shard {
+        std::atomic<uint64_t>           count       {0};
+    };
+    Shard                               _shards[SHARDS];
+    static uint32_t THREAD_SHARD        ()
+    {
+        static std::atomic<uint32_t> next {0};
+        thread_local const uint32_t shard = next.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+        return shard;
+    }
+public:
+    void        operator +=             (uint64_t value)
+    { _shards[THREAD_SHARD()].count.fetch_add(value, std::memory_order_relaxed); }
+    void        operator ++             ()
+    { *this += 1; }
+    uint64_t    load                    () const
+    {
+        uint64_t total = 0;
+        for (auto& shard : _shards) total += shard.count.load(std::memory_order_relaxed);
+        return total;
+    }
+};
+
 struct Callback {
-    LambdaPtr                       callback        = nullptr;
+    Task                            callback        = nullptr;
     Fence                           fenceOptional   = nullptr;
 };
 
+/**
+ * @brief Injection queue of a pool: tasks issued from outside its workers
+ *
+ * Tasks go through a bounded lock-free ring (FIFO2::Ring). When the ring is
+ * full, push spills them into a locked overflow deque; while any remain
+ * spilled, new tasks spill behind them so that tasks keep their order.
+ * try_push instead reports the full ring to the caller (backpressure).
+ */
+struct TaskList {
+    static constexpr size_t         CAPACITY        = 1 << 12;
+    FIFO2::Ring<Callback>           ring            {CAPACITY};
+    Mutex                           mutex;
+    std::deque<Callback>            overflow;
+    std::atomic<size_t>             spilled         {0};
+    void        push                (Callback&&);
+    bool        try_push            (Callback&&);
+    bool        pop                 (Callback&);
+};
+
 struct __INTERNAL__Fence {
     atomic_bool                     complete;
     
@@ -43,11 +110,62 @@ enum __status : uint8_t {
 };
 using Status = std::atomic<__status>;
 
+/**
+ * @brief Work-stealing deque of a pool worker (Chase-Lev, fixed capacity)
+ *
+ * Only the owning worker pushes and pops, at the bottom (newest first);
+ * idle workers steal from the top (oldest first). The deque holds pointers to
+ * task slots of the worker's own arena: the owner takes free slots from its
+ * free list and recycles the slots it pops; thieves return the slots they
+ * steal through a lock-free stack the owner collects from. Issuing a task
+ * therefore never allocates. A full deque (or an exhausted arena, while
+ * thieves still hold slots) rejects the push and the task goes to the pool's
+ * shared injection queue instead.
+ */
+struct alignas(64) __INTERNAL__Worker {
+    static constexpr int64_t        CAPACITY        = 1 << 10;
+    static constexpr int64_t        MASK            = CAPACITY - 1;
+    struct Slot {
+        Callback                    task;
+        Slot*                       next            = nullptr;
+    };
+    alignas(64) std::atomic<int64_t> top            {0};
+    alignas(64) std::atomic<int64_t> bottom         {0};
+    std::atomic<Slot*>              tasks[CAPACITY] {};
+    alignas(64) std::atomic<Slot*>  returned        {nullptr};  // Slots released by thieves
+    Slot*                           free            = nullptr;  // Owner only
+    Slot                            slots[CAPACITY];
+    
+    explicit __INTERNAL__Worker     ();
+    __INTERNAL__Worker              (const __INTERNAL__Worker&) = delete;
+    __INTERNAL__Worker& operator =  (const __INTERNAL__Worker&) = delete;
+    bool        push                (Callback&);
+    bool        pop                 (Callback&);
+    bool        steal               (Callback&);
+private:
+    Slot*       take_slot           ();
+    Slot*       pop_slot            ();
+};
+
+/**
+ * @brief Work-stealing thread pool
+ *
+ * Tasks issued by a pool worker go to that worker's own deque; tasks issued
+ * from any other thread (network reactors) go to the shared injection queue.
+ * An idle worker takes from its own deque, then the injection queue, then
+ * steals from the other workers. Every GLOBAL_INTERVAL tasks the injection
+ * queue is checked first so that a worker busy with its own tasks still picks
+ * up new submissions. Workers with nothing to do spin briefly, then park on an
+ * atomic wait; issuing a task only wakes a worker if one is parked.
+ */
 class __INTERNAL__Pool {
-    TaskList        _tasks;
+    static constexpr uint32_t       GLOBAL_INTERVAL = 31;
+    static constexpr uint32_t       SPIN_COUNT      = 64;
+    TaskList        _tasks;          // Injection queue
     Threads         _threads;
-    Mutex           _task_added_mtx; // Used only for conditional variable
-    Notification    _task_added;     // Conditional variable notification
+    std::unique_ptr<__INTERNAL__Worker[]> _workers;
+    atomic_uint32   _signal;         // Epoch that parked workers wait upon
+    atomic_uint32   _parked;         // Workers parked (or about to park)
     Status          status;
     
 public:
@@ -55,13 +173,27 @@ public:
     __INTERNAL__Pool                (const __INTERNAL__Pool&) = delete;
     __INTERNAL__Pool& operator =    (const __INTERNAL__Pool&) = delete;
    ~__INTERNAL__Pool                ();
-    void    issue_task              (const LambdaPtr&);
-    Fence   issue_task_with_fence   (const LambdaPtr&);
+    void    issue_task              (Task&&);
+    /// Issue the task unless the pool's queues are full (false: not issued)
+    bool    try_issue_task          (Task&&);
+    Fence   issue_task_with_fence   (Task&&);
+    template <class Callable>
+    void    issue_task              (Callable&& callable)
+    { issue_task(Task(std::forward<Callable>(callable))); }
+    template <class Callable>
+    bool    try_issue_task          (Callable&& callable)
+    { return try_issue_task(Task(std::forward<Callable>(callable))); }
+    template <class Callable>
+    Fence   issue_task_with_fence   (Callable&& callable)
+    { return issue_task_with_fence(Task(std::forward<Callable>(callable))); }
     void    wait_until_complete     ();
     void    terminate               ();
     void    reset                   ();
 private:
-    void    process_tasks           ();
+    bool    submit                  (Callback&&, bool backpressure = false);
+    void    wake                    ();
+    bool    next_task               (uint32_t worker, Callback&, uint32_t& tick);
+    void    process_tasks           (uint32_t worker);
 };
 
 
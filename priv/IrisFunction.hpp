@@ -0,0 +1,109 @@
+/**
+ * @file IrisFunction.hpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief Move-only callable wrapper with inline (small-buffer) storage.
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ * std::function must be copyable and places any capture larger than a couple
+ * of pointers on the heap. InlineFunction stores the callable within the
+ * object itself and never allocates: a callable that does not fit within the
+ * capacity is rejected at compile time rather than silently spilled onto
+ * the heap. It is move-only, so it may own move-only captures.
+ */
+
+#ifndef IrisFunction_hpp
+#define IrisFunction_hpp
+#include <new>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+namespace Iris {
+template <class Signature, size_t Capacity = 64>
+class InlineFunction;
+
+template <class Return, class... Args, size_t Capacity>
+class InlineFunction<Return(Args...), Capacity> {
+    struct Operations {
+        Return  (*invoke)               (void*, Args&&...);
+        void    (*move)                 (void* destination, void* source);
+        void    (*destroy)              (void*);
+    };
+    template <class Callable>
+    static constexpr Operations OPERATIONS {
+        .invoke     = [](void* callable, Args&&... args) -> Return {
+            return (*static_cast<Callable*>(callable))(std::forward<Args>(args)...);
+        },
+        .move       = [](void* destination, void* source) {
+            new (destination) Callable (std::move(*static_cast<Callable*>(source)));
+            static_cast<Callable*>(source)->~Callable();
+        },
+        .destroy    = [](void* callable) {
+            static_cast<Callable*>(callable)->~Callable();
+        },
+    };
+    alignas(std::max_align_t) std::byte _storage[Capacity];
+    const Operations*                   _operations = nullptr;
+public:
+    InlineFunction                      () = default;
+    InlineFunction                      (std::nullptr_t) {}
+    template <class Callable, class = std::enable_if_t<
+        !std::is_same_v<std::decay_t<Callable>, InlineFunction> &&
+        std::is_invocable_r_v<Return, std::decay_t<Callable>&, Args...>>>
+    InlineFunction                      (Callable&& callable)
+    {
+        using Callable_ = std::decay_t<Callable>;
+        static_assert(sizeof(Callable_) <= Capacity,
+                      "InlineFunction capacity exceeded; reduce the captures or raise the capacity");
+        static_assert(alignof(Callable_) <= alignof(std::max_align_t),
+                      "InlineFunction does not support over-aligned callables");
+        static_assert(std::is_nothrow_move_constructible_v<Callable_>,
+                      "InlineFunction callables must be nothrow move constructible");
+        new (_storage) Callable_ (std::forward<Callable>(callable));
+        _operations = &OPERATIONS<Callable_>;
+    }
+    InlineFunction                      (InlineFunction&& other) noexcept
+    {
+        if (!other._operations) return;
+        other._operations->move(_storage, other._storage);
+        _operations = std::exchange(other._operations, nullptr);
+    }
+    InlineFunction& operator =          (InlineFunction&& other) noexcept
+    {
+        if (this == &other) return *this;
+        reset();
+        if (!other._operations) return *this;
+        other._operations->move(_storage, other._storage);
+        _operations = std::exchange(other._operations, nullptr);
+        return *this;
+    }
+    InlineFunction& operator =          (std::nullptr_t) noexcept
+    {
+        reset();
+        return *this;
+    }
+    InlineFunction                      (const InlineFunction&) = delete;
+    InlineFunction& operator =          (const InlineFunction&) = delete;
+   ~InlineFunction                      ()
+    {
+        reset();
+    }
+    explicit operator bool              () const
+    {
+        return _operations != nullptr;
+    }
+    Return operator ()                  (Args... args)
+    {
+        assert(_operations && "InlineFunction invoked without a callable");
+        return _operations->invoke(_storage, std::forward<Args>(args)...);
+    }
+    void reset                          () noexcept
+    {
+        if (_operations) std::exchange(_operations, nullptr)->destroy(_storage);
+    }
+};
+} // END IRIS
+#endif /* IrisFunction_hpp */
@@ -0,0 +1,66 @@
+/**
+ * @file IrisRestfulCache.hpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief Persistent slide-open cache. Stores the validation result, a
+ * compact tile table, and the serialized metadata per slide file so that
+ * reopening an unchanged slide skips IrisCodec::validate_file_structure
+ * and abstract_file_structure.
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ */
+
+#ifndef IrisRestfulCache_hpp
+#define IrisRestfulCache_hpp
+namespace Iris {
+namespace RESTful {
+/**
+ * @brief Identity of a slide file on disk. A cache entry is only valid
+ * for the exact same file (device and inode) with the same size and
+ * modification time; anything else marks the entry stale.
+ */
+struct FileIdentity {
+    uint64_t                            device      = 0;
+    uint64_t                            inode       = 0;
+    uint64_t                            size        = 0;
+    int64_t                             modified    = 0; // nanoseconds since epoch
+    bool operator ==                    (const FileIdentity&) const = default;
+};
+struct SlideTileEntry {
+    uint64_t                            offset      = 0;
+    uint32_t                            size        = 0;
+};
+/**
+ * @brief Compact, flattened tile table of a validated slide
+ *
+ * Entries of all layers are stored contiguously; layers[L] is the index of
+ * the first entry of layer L and layers.back() equals entries.size().
+ */
+struct SlideTileTable {
+    Format                              format      = FORMAT_UNDEFINED;
+    IrisCodec::Encoding                 encoding    = IrisCodec::TILE_ENCODING_UNDEFINED;
+    Extent                              extent;
+    std::vector<uint32_t>               layers;
+    std::vector<SlideTileEntry>         entries;
+};
+inline uint64_t FNV1A_64 (const char* data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+FileIdentity get_file_identity  (int fd, const std::filesystem::path& file_path);
+bool    read_slide_cache        (const std::filesystem::path& cache_dir,
+                                 const FileIdentity&, SlideTileTable&,
+                                 std::string& metadata_json);
+void    write_slide_cache       (const std::filesystem::path& cache_dir,
+                                 const FileIdentity&, const SlideTileTable&,
+                                 const std::string& metadata_json);
+} // END RESTFUL
+} // END IRIS
+#endif /* IrisRestfulCache_hpp */
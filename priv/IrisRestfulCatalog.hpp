@@ -0,0 +1,62 @@
+/**
+ * @file IrisRestfulCatalog.hpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief In-memory catalog of the slides within the slide root directory.
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ */
+
+#ifndef IrisRestfulCatalog_hpp
+#define IrisRestfulCatalog_hpp
+namespace Iris {
+namespace RESTful {
+using Catalog = std::unique_ptr<class __INTERNAL__Catalog>;
+/**
+ * @brief Slide catalog built by scanning the slide root at startup
+ *
+ * When the slide directory is watched, the catalog is kept current and is
+ * authoritative for slide lookups: an identifier that is not cataloged is
+ * rejected by a single hash probe without touching the file system. The scan
+ * validates every slide in parallel on the server's worker pool (priming the
+ * persistent slide-open cache, if configured) in the background; until it
+ * completes, uncataloged identifiers are looked up in the slide directory as
+ * if there were no catalog. Unwatched, the catalog only reflects the scan, so
+ * uncataloged identifiers are always looked up in the slide directory.
+ */
+class __INTERNAL__Catalog {
+    struct Record {
+        std::filesystem::path           path;
+        SlideCatalogEntry               entry;
+    };
+    struct Scan;
+    using OnCataloged                   = std::function<void(const std::string& id)>;
+    using Listing                       = std::shared_ptr<const std::vector<SlideCatalogEntry>>;
+    const std::filesystem::path         _root;
+    const std::filesystem::path         _cache_dir;
+    std::unordered_map<std::string, Record> _records;
+    std::unordered_set<std::string>     _erased;  // Erased during the initial scan; not re-added by it
+    mutable SharedMutex                 _mutex;
+    mutable std::atomic<Listing>        _listing; // Sorted listing; rebuilt lazily after changes
+    atomic_bool                         _scanned;
+    const bool                          _watched; // Kept current by the watcher (authoritative)
+public:
+    explicit __INTERNAL__Catalog        (const std::filesystem::path& root,
+                                         const std::filesystem::path& cache_dir, bool watched);
+    __INTERNAL__Catalog                 (const __INTERNAL__Catalog&) = delete;
+    __INTERNAL__Catalog& operator =     (const __INTERNAL__Catalog&) = delete;
+
+    void    scan                        (const Async::ThreadPool&, const OnCataloged&);
+    bool    find                        (const std::string& id, std::filesystem::path&) const;
+    void    insert                      (const std::string& id, const std::filesystem::path&, const Slide&);
+    bool    erase                       (const std::string& id);
+    size_t  size                        () const;
+    void    list                        (uint32_t offset, uint32_t limit, GetSlideListResponse&) const;
+private:
+    void    finish_scan                 (Scan&);
+};
+} // END RESTFUL
+} // END IRIS
+#endif /* IrisRestfulCatalog_hpp */
@@ -0,0 +1,79 @@
+/**
+ * @file IrisRestfulDirectory.hpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief Directory of the currently open slides with a lock-free read path.
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ * Every tile request resolves its slide through this directory, so lookups
+ * must scale with worker threads. Lookups take no lock and write no state
+ * shared across the directory: readers probe an immutable open-addressing
+ * table that is published through an atomic pointer (read-copy-update).
+ * Returning a live slide does take a reference to it (an atomic increment on
+ * that slide's control block), as any response that holds the slide must. Writers (slide opened, slide
+ * destroyed, slide file replaced) are rare; they serialize on a mutex, build
+ * a new table, publish it, and retire the previous table. A retired table is
+ * freed once no reader that could still be probing it remains (epoch based
+ * reclamation). Each reader only writes its own cache-line-sized epoch slot.
+ *
+ * The directory also interns slide identifiers: the first successful open of
+ * an identifier assigns it a compact SlideHandle that is kept while the slide
+ * is open (or its file replaced). Handles are never reused; an identifier that
+ * is opened again after its slide closed is assigned a new one. Identifiers
+ * that never opened (e.g. typos or probes) are never interned.
+ */
+
+#ifndef IrisRestfulDirectory_hpp
+#define IrisRestfulDirectory_hpp
+namespace Iris {
+namespace RESTful {
+class SlideDirectory {
+    struct Entry {
+        size_t                          hash        = 0;
+        bool                            used        = false;
+        SlideHandle                     handle      = NULL_SLIDE_HANDLE;
+        std::string                     id;
+        std::weak_ptr<__INTERNAL__Slide> slide;
+    };
+    struct Table {
+        std::vector<Entry>              buckets;    // Power of two; linear probing
+        size_t                          size        = 0;
+        const Entry* find               (const std::string_view&, size_t hash) const;
+    };
+    using Retired                       = std::vector<std::pair<uint64_t, std::unique_ptr<const Table>>>;
+    std::atomic<const Table*>           _table;
+    mutable Mutex                       _write_mutex;
+    Retired                             _retired;
+    SlideHandle                         _next_handle = 0;
+public:
+    explicit SlideDirectory             ();
+    SlideDirectory                      (const SlideDirectory&) = delete;
+    SlideDirectory& operator =          (const SlideDirectory&) = delete;
+   ~SlideDirectory                      ();
+
+    /// Lock-free lookup of a live slide (nullptr if absent or expired). The
+    /// handle is reported for any interned identifier, live or not.
+    Slide   find                        (const std::string_view& id, SlideHandle* = nullptr) const;
+    /// Lock-free lookup of the interned handle alone (no slide reference)
+    SlideHandle handle                  (const std::string_view& id) const;
+    /// Insert the slide unless a live slide already exists for the id;
+    /// returns whichever slide is now in the directory.
+    Slide   insert                      (const std::string& id, const Slide&, SlideHandle* = nullptr);
+    /// Swap the entry to the replacement (or clear it if null) if it still
+    /// refers to the expected slide. Returns false if it did not.
+    bool    replace                     (const std::string& id, const Slide& expected, const Slide& replacement);
+    /// Remove the entry if its slide has expired (slide destroyed callback)
+    void    erase_expired               (const std::string& id);
+    /// Snapshot of the identifiers with a currently open slide
+    std::vector<std::string> identifiers() const;
+
+private:
+    template <class Modify>
+    void    update                      (Modify&&);
+    void    publish                     (std::unique_ptr<Table>&&);
+};
+} // END RESTFUL
+} // END IRIS
+#endif /* IrisRestfulDirectory_hpp */
@@ -0,0 +1,55 @@
+/**
+ * @file IrisRestfulGovernor.hpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief Releases the pages of cold slides under cgroup memory pressure.
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ */
+
+#ifndef IrisRestfulGovernor_hpp
+#define IrisRestfulGovernor_hpp
+
+#if defined(__linux__)
+#define IRIS_GOVERNOR_SUPPORTED 1
+#else
+#define IRIS_GOVERNOR_SUPPORTED 0
+#endif
+
+namespace Iris {
+namespace RESTful {
+using MemoryGovernor = std::unique_ptr<class __INTERNAL__MemoryGovernor>;
+/**
+ * @brief Watches the server's cgroup (v2) for memory pressure
+ *
+ * Once a second the governor reads the cgroup's memory pressure stall
+ * information (memory.pressure, "some avg10") and its usage against its limit
+ * (memory.current against memory.high or memory.max). Under pressure, the
+ * pages of open slides not used within COLD_AGE are released, least recently
+ * used first, a quarter of the cold slides per second, until the pressure
+ * subsides. Slides pinned through the warm-up API are never released. Each release is logged with the resident bytes reclaimed.
+ */
+class __INTERNAL__MemoryGovernor {
+public:
+    using OpenSlides                    = std::function<std::vector<Slide>()>;
+    static constexpr double             HIGH_WATER  = 0.9;  // Fraction of the cgroup limit
+private:
+    const std::filesystem::path         _cgroup;
+    const OpenSlides                    _open_slides;
+    const float                         _pressure;          // PSI some avg10 (percent)
+    atomic_bool                         _active;
+    std::thread                         _thread;
+public:
+    explicit __INTERNAL__MemoryGovernor (float pressure, const OpenSlides&);
+    __INTERNAL__MemoryGovernor          (const __INTERNAL__MemoryGovernor&) = delete;
+    __INTERNAL__MemoryGovernor& operator = (const __INTERNAL__MemoryGovernor&) = delete;
+   ~__INTERNAL__MemoryGovernor          ();
+private:
+    void    govern                      ();
+    void    release_cold_slides         (const std::string& reason);
+};
+} // END RESTFUL
+} // END IRIS
+#endif /* IrisRestfulGovernor_hpp */
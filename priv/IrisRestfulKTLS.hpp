@@ -0,0 +1,231 @@
+/**
+ * @file IrisRestfulKTLS.hpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief Kernel TLS (kTLS) stream used by the optional kTLS serving mode.
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ * Boost ASIO's ssl::stream runs OpenSSL over memory BIOs, which prevents
+ * OpenSSL from handing record encryption to the kernel. This stream instead
+ * attaches OpenSSL directly to the socket descriptor and drives the non-blocking
+ * OpenSSL calls from the reactor. When the kernel accepts the offload, records
+ * are encrypted by the kernel and tile byte ranges can be sent with SSL_sendfile.
+ * When it does not, the same stream continues to work with user-space encryption.
+ *
+ * This header requires the Boost ASIO / Beast and OpenSSL headers and is
+ * only included by IrisRestfulNetworking.cpp.
+ */
+
+#ifndef IrisRestfulKTLS_hpp
+#define IrisRestfulKTLS_hpp
+
+#if defined(__linux__) && defined(SSL_OP_ENABLE_KTLS)
+#define IRIS_KTLS_SUPPORTED 1
+#else
+#define IRIS_KTLS_SUPPORTED 0
+#endif
+
+namespace Iris {
+namespace RESTful {
+class __INTERNAL__KtlsStream {
+    static constexpr size_t             COALESCE_LIMIT = 16 * 1024; // One TLS record
+    struct Impl {
+        ASIOSocket_t                    socket;
+        ASIOTimer_t                     timer;
+        SSL* const                      ssl;
+        bool                            timed_out   = false;
+        std::vector<char>               coalesced;  // Gathered write (see COALESCE)
+        Async::ShardedCounter&          copied;     // Bytes gathered into coalesced
+        explicit Impl                   (ASIOSocket_t&& __socket, ssl::context& ctx,
+                                         Async::ShardedCounter& __copied) :
+        socket                          (std::move(__socket)),
+        timer                           (socket.get_executor()),
+        ssl                             (SSL_new(ctx.native_handle())),
+        copied                          (__copied) {}
+       ~Impl                            () { if (ssl) SSL_free(ssl); }
+    };
+    using ImplPtr                       = std::shared_ptr<Impl>;
+    const ImplPtr                       _impl;
+
+public:
+    using executor_type                 = ASIOSocket_t::executor_type;
+    explicit __INTERNAL__KtlsStream     (ASIOSocket_t&& socket, ssl::context& ctx,
+                                         Async::ShardedCounter& copied) :
+    _impl                               (std::make_shared<Impl>(std::move(socket), ctx, copied))
+    {
+        if (!_impl->ssl) throw std::runtime_error
+            ("Failed to create an OpenSSL session for kTLS stream");
+        beast::error_code error;
+        _impl->socket.native_non_blocking(true, error);
+        if (error) throw std::runtime_error
+            ("Failed to set kTLS socket non-blocking: " + error.message());
+        SSL_set_fd(_impl->ssl, static_cast<int>(_impl->socket.native_handle()));
+        SSL_set_mode(_impl->ssl, SSL_MODE_ENABLE_PARTIAL_WRITE |
+                                 SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+    }
+    __INTERNAL__KtlsStream              (const __INTERNAL__KtlsStream&) = delete;
+    __INTERNAL__KtlsStream& operator =  (const __INTERNAL__KtlsStream&) = delete;
+
+    executor_type get_executor          () noexcept { return _impl->socket.get_executor(); }
+    ASIOSocket_t& socket                () noexcept { return _impl->socket; }
+    SSL*          native_handle         () noexcept { return _impl->ssl; }
+
+    /// Did the kernel accept the transmit offload (valid after the handshake)
+    bool ktls_send                      () const
+    {
+        return BIO_get_ktls_send(SSL_get_wbio(_impl->ssl));
+    }
+    /// Did the kernel accept the receive offload (valid after the handshake)
+    bool ktls_recv                      () const
+    {
+        return BIO_get_ktls_recv(SSL_get_rbio(_impl->ssl));
+    }
+    /// Mirrors beast::tcp_stream::expires_after; cancels outstanding
+    /// operations, which then complete with beast::error::timeout.
+    void expires_after                  (net::steady_timer::duration duration)
+    {
+        _impl->timed_out = false;
+        _impl->timer.expires_after(duration);
+        _impl->timer.async_wait([weak = std::weak_ptr<Impl>(_impl)]
+                                (beast::error_code error) {
+            auto impl = weak.lock();
+            if (error || !impl) return;
+            impl->timed_out = true;
+            impl->socket.cancel(error);
+        });
+    }
+    void expires_never                  ()
+    {
+        _impl->timed_out = false;
+        _impl->timer.cancel();
+    }
+    template <class Handler>
+    void async_handshake                (Handler&& handler)
+    {
+        ASYNC_SSL_OPERATION(_impl, [](SSL* ssl)->int64_t {
+            return SSL_accept(ssl);
+        }, [handler = std::move(handler)]
+           (beast::error_code error, size_t) mutable {
+            handler (error);
+        });
+    }
+    template <class MutableBufferSequence, class ReadHandler>
+    auto async_read_some                (const MutableBufferSequence& buffers, ReadHandler&& handler)
+    {
+        return net::async_initiate<ReadHandler, void(beast::error_code, std::size_t)>
+        ([impl = _impl](auto handler, const MutableBufferSequence& buffers) {
+            net::mutable_buffer buffer = FIRST_BUFFER<net::mutable_buffer>(buffers);
+            if (buffer.size() == 0) return COMPLETE(impl, std::move(handler), {}, 0);
+            ASYNC_SSL_OPERATION(impl, [buffer](SSL* ssl)->int64_t {
+                return SSL_read(ssl, buffer.data(), static_cast<int>(std::min<size_t>(buffer.size(), INT_MAX)));
+            }, std::move(handler));
+        }, handler, buffers);
+    }
+    template <class ConstBufferSequence, class WriteHandler>
+    auto async_write_some               (const ConstBufferSequence& buffers, WriteHandler&& handler)
+    {
+        return net::async_initiate<WriteHandler, void(beast::error_code, std::size_t)>
+        ([impl = _impl](auto handler, const ConstBufferSequence& buffers) {
+            net::const_buffer buffer = COALESCE(*impl, buffers);
+            if (buffer.size() == 0) return COMPLETE(impl, std::move(handler), {}, 0);
+            ASYNC_SSL_OPERATION(impl, [buffer](SSL* ssl)->int64_t {
+                return SSL_write(ssl, buffer.data(), static_cast<int>(std::min<size_t>(buffer.size(), INT_MAX)));
+            }, std::move(handler));
+        }, handler, buffers);
+    }
+    /// Send a byte range of a file through the kernel TLS socket. Only valid
+    /// when ktls_send() is true. Completes once the full range is written.
+    template <class Handler>
+    void async_sendfile                 (int fd, off_t offset, size_t remaining, Handler&& handler)
+    {
+        #if IRIS_KTLS_SUPPORTED
+        if (remaining == 0) return COMPLETE(_impl, std::move(handler), {}, 0);
+        ASYNC_SSL_OPERATION(_impl, [fd, offset, remaining](SSL* ssl)->int64_t {
+            return SSL_sendfile(ssl, fd, offset, remaining, 0);
+        }, [this, fd, offset, remaining, handler = std::move(handler)]
+           (beast::error_code error, size_t sent) mutable {
+            if (error || sent >= remaining) return handler(error, sent);
+            async_sendfile(fd, offset + sent, remaining - sent, std::move(handler));
+        });
+        #else
+        COMPLETE(_impl, std::move(handler), net::error::operation_not_supported, 0);
+        #endif
+    }
+    /// Best-effort close_notify; does not wait for the peer's reply.
+    void shutdown                       (beast::error_code& error)
+    {
+        ERR_clear_error();
+        if (SSL_shutdown(_impl->ssl) < 0)
+            error = net::error::broken_pipe;
+    }
+
+private:
+    template <class Buffer_, class BufferSequence>
+    static Buffer_ FIRST_BUFFER         (const BufferSequence& buffers)
+    {
+        // OpenSSL reads/writes a single contiguous region; a *_some operation
+        // may legally transfer fewer bytes than the full sequence.
+        for (auto it = net::buffer_sequence_begin(buffers);
+             it != net::buffer_sequence_end(buffers); ++it)
+            if (Buffer_(*it).size()) return Buffer_(*it);
+        return Buffer_();
+    }
+    template <class BufferSequence>
+    static net::const_buffer COALESCE   (Impl& impl, const BufferSequence& buffers)
+    {
+        // Gather a short header and body into a single SSL_write (one TLS
+        // record, one syscall) rather than a record per buffer, as beast's
+        // flat_stream does for ssl::stream. The gathered copy is kept in the
+        // stream until the write completes; OpenSSL retries must see the
+        // same bytes. It is counted in the server's bytes_copied statistic.
+        const auto first = FIRST_BUFFER<net::const_buffer>(buffers);
+        const auto total = net::buffer_size(buffers);
+        if (first.size() >= COALESCE_LIMIT || first.size() == total) return first;
+        impl.coalesced.resize(std::min(total, COALESCE_LIMIT));
+        net::buffer_copy(net::buffer(impl.coalesced), buffers);
+        impl.copied += impl.coalesced.size();
+        return net::buffer(impl.coalesced);
+    }
+    template <class Handler>
+    static void COMPLETE                (const ImplPtr& impl, Handler&& handler,
+                                         beast::error_code error, size_t bytes)
+    {
+        // Never invoke the completion inline from the initiating call
+        net::post(impl->socket.get_executor(),
+                  beast::bind_front_handler(std::move(handler), error, bytes));
+    }
+    template <class Operation, class Handler>
+    static void ASYNC_SSL_OPERATION     (const ImplPtr& impl, Operation operation, Handler&& handler)
+    {
+        ERR_clear_error();
+        errno       = 0;
+        auto result = operation(impl->ssl);
+        if (result > 0) return COMPLETE(impl, std::move(handler), {}, static_cast<size_t>(result));
+
+        tcp::socket::wait_type wait;
+        switch (SSL_get_error(impl->ssl, static_cast<int>(result))) {
+            case SSL_ERROR_WANT_READ:   wait = tcp::socket::wait_read;  break;
+            case SSL_ERROR_WANT_WRITE:  wait = tcp::socket::wait_write; break;
+            case SSL_ERROR_ZERO_RETURN: return COMPLETE(impl, std::move(handler), net::error::eof, 0);
+            case SSL_ERROR_SYSCALL:     return COMPLETE(impl, std::move(handler), errno ?
+                                                        beast::error_code(errno, boost::system::system_category()) :
+                                                        beast::error_code(net::error::eof), 0);
+            default:                    return COMPLETE(impl, std::move(handler),
+                                                        beast::error_code(static_cast<int>(ERR_get_error()),
+                                                                          net::error::get_ssl_category()), 0);
+        }
+        // OpenSSL needs the socket to become readable / writable; wait on the
+        // reactor and retry the identical call (required by OpenSSL semantics).
+        impl->socket.async_wait(wait, [impl, operation, handler = std::move(handler)]
+                                (beast::error_code error) mutable {
+            if (error && impl->timed_out) error = beast::error::timeout;
+            if (error) return handler(error, 0);
+            ASYNC_SSL_OPERATION(impl, std::move(operation), std::move(handler));
+        });
+    }
+};
+} // END RESTFUL
+} // END IRIS
+#endif /* IrisRestfulKTLS_hpp */
@@ -14,10 +14,78 @@
 
 namespace Iris {
 namespace RESTful {
+/**
+ * @brief Small per-connection cache of the slides a session is viewing
+ *
+ * Viewers showing several slides side by side share one keep-alive connection;
+ * each entry maps an interned slide handle to its slide. A request resolves its
+ * identifier to a handle once (SlideDirectory::handle, no slide reference) and
+ * then finds the slide here by comparing handles rather than identifiers.
+ * Least recently used entries are replaced once the cache is full.
+ */
+struct SessionSlides {
+    static constexpr size_t             CAPACITY    = 8;
+    struct Entry {
+        SlideHandle                     handle      = NULL_SLIDE_HANDLE;
+        RESTful::Slide                  slide       = nullptr;
+        uint32_t                        used        = 0;
+    };
+    Entry                               entries[CAPACITY];
+    uint32_t                            clock       = 0;
+    RESTful::Slide  find                (SlideHandle);
+    void            insert              (SlideHandle, const RESTful::Slide&);
+};
+/**
+ * @brief Recent tile requests of a session, used to predict its next ones
+ *
+ * Tile positions within the current layer are smoothed by a fast and a slow
+ * moving average; their difference estimates the pan velocity (in tiles), and
+ * the recent positions bound the visible region. Layer changes record the zoom
+ * direction. Updated by the worker processing the session's single in-flight
+ * request (see __INTERNAL__ReadAhead).
+ */
+struct SessionMotion {
+    static constexpr uint32_t           HISTORY     = 32;
+    struct Sample {
+        uint32_t                        x           = 0;
+        uint32_t                        y           = 0;
+    };
+    Sample                              history[HISTORY]; // Ring of recent tiles in the layer
+    uint32_t                            count       = 0;
+    uint32_t                            layer       = UINT32_MAX;
+    int32_t                             zoom        = 0;    // +1 zooming in, -1 zooming out
+    int64_t                             last        = 0;    // Steady clock time of the last tile
+    float                               fast_x      = 0.f;
+    float                               fast_y      = 0.f;
+    float                               slow_x      = 0.f;
+    float                               slow_y      = 0.f;
+};
+/**
+ * @brief Per-connection storage for the request currently in flight
+ *
+ * A connection processes one request at a time (a response is written before
+ * the next request is read), so the read buffer and parser (the reader), the
+ * target, the tile response header, and the response handler live in the
+ * session and are reused. Their capacity persists across keep-alive requests.
+ */
+using GetResponseHandler = InlineFunction<void(GetResponse&&)>;
+struct SessionReader;   // Read buffer, parser, deadline, and memory. See IrisRestfulNetworking.cpp
+struct TileBatchBody;
+using TileBatch                         = std::shared_ptr<TileBatchBody>;
+struct SessionRequest {
+    std::unique_ptr<SessionReader>      reader;     // Allocated with the session
+    std::string                         target;
+    std::string                         header;     // Buffer (tile / metadata) response header
+    std::string                         if_none_match;
+    RequestMethod                       method      = REQUEST_METHOD_GET;
+    GetResponseHandler                  on_response;
+};
 struct __INTERNAL__Session {
     const ASIOStream                    stream;
     const std::string                   remote;
-    RESTful::Slide                      slide = nullptr;
+    SessionSlides                       slides;
+    SessionMotion                       motion;
+    SessionRequest                      request;
     explicit __INTERNAL__Session        (ASIOSocket_t&&);
     __INTERNAL__Session                 (const __INTERNAL__Session&) = delete;
     __INTERNAL__Session& operator ==    (const __INTERNAL__Session&) = delete;
@@ -26,27 +94,60 @@ struct __INTERNAL__Session {
 struct __INTERNAL__SslSession {
     const ASIOSslStream                 stream;
     const std::string                   remote;
-    RESTful::Slide                      slide = nullptr;
+    SessionSlides                       slides;
+    SessionMotion                       motion;
+    SessionRequest                      request;
     explicit __INTERNAL__SslSession     (ASIOSocket_t&&, SSLContext_t&);
     __INTERNAL__SslSession              (const __INTERNAL__SslSession&) = delete;
     __INTERNAL__SslSession& operator == (const __INTERNAL__SslSession&) = delete;
    ~__INTERNAL__SslSession              ();
 };
+struct __INTERNAL__KtlsSession {
+    const ASIOKtlsStream                stream;
+    const std::string                   remote;
+    SessionSlides                       slides;
+    SessionMotion                       motion;
+    SessionRequest                      request;
+    explicit __INTERNAL__KtlsSession    (ASIOSocket_t&&, SSLContext_t&, Async::ShardedCounter& copied);
+    __INTERNAL__KtlsSession             (const __INTERNAL__KtlsSession&) = delete;
+    __INTERNAL__KtlsSession& operator ==(const __INTERNAL__KtlsSession&) = delete;
+   ~__INTERNAL__KtlsSession             ();
+};
+/**
+ * @brief Network reactors, acceptors, and the HTTP(S) session handlers
+ *
+ * See NetworkReactors. Shared reactors are a single Reactor (io_context and
+ * acceptor) run by every reactor thread; per-core reactors are one Reactor per
+ * core, each run by the thread pinned to that core.
+ */
 class __INTERNAL__Networking {
+    struct Reactor {
+        ASIOContext                     context     = nullptr;
+        ASIOGuard                       guard       = nullptr;
+        ASIOAcceptor                    acceptor    = nullptr;
+    };
     __INTERNAL__Server * const          _server;
+    const std::vector<int>              _cores;     // Cores of the per-core reactors
+    const NetworkReactors               _mode;
     const Threads                       _reactors;
-    const ASIOContext                   _context    = nullptr;
-    const ASIOGuard                     _guard      = nullptr;
+    std::vector<Reactor>                _contexts;
     const SSLContext                    _ssl        = nullptr;
     const Address                       _CORS       = "*";
-    ASIOAcceptor                        _acceptor   = nullptr;
+    const TileDelivery                  _delivery   = TILE_DELIVERY_BUFFER;
+    const bool                          _ktls       = false;
+    const std::string                   _cache_control;
     
     atomic_bool                         ACTIVE;
 public:
     explicit __INTERNAL__Networking     (__INTERNAL__Server* const &, bool https,
                                          const std::filesystem::path& cert_file,
                                          const std::filesystem::path& key_file,
-                                         const Address& CORS);
+                                         const Address& CORS,
+                                         TileDelivery delivery,
+                                         bool ktls,
+                                         uint32_t cache_max_age,
+                                         bool cache_immutable,
+                                         NetworkReactors reactors);
     __INTERNAL__Networking              (const __INTERNAL__Networking&) = delete;
     __INTERNAL__Networking& operator == (const __INTERNAL__Networking&) = delete;
    ~__INTERNAL__Networking              ();
@@ -59,13 +160,23 @@ private:
     void read_request                   (const Session_&);
     
     template <class Session_>
-    void interpret_request              (const Session_&, const HTTPRequest_t&);
+    void interpret_request              (const Session_&, HTTPRequest_t&&);
     
     template <class Session_>
     void send_response                  (const Session_&, const HTTPResponse&);
     
     template <class Session_>
-    void send_buffer                    (const Session_&, const HTTPResponseBuffer&, const Buffer&);
+    void send_header                    (const Session_&, const HTTPResponseHeader&);
+    
+    template <class Session_>
+    void send_slide_buffer              (const Session_&, const BYTE* data, size_t size,
+                                         const Slide&, bool keep_alive);
+    
+    template <class Session_>
+    void send_tile_range                (const Session_&, const GetTileResponse&, bool keep_alive);
+    
+    template <class Session_>
+    void send_tile_batch                (const Session_&, const TileBatch&, bool keep_alive);
     
     template <class Session_>
     void send_file                      (const Session_&, const HTTPResponseFile&);
@@ -11,21 +11,38 @@
 
 #include <assert.h>
 #include <iostream>
+#include <optional>
+#include <unordered_set>
 #include "IrisRestfulTypes.hpp"
+#include "IrisFunction.hpp"
 #include "IrisQueue.hpp"
 #include "IrisAsync.hpp"
 #include "IrisCodecPriv.hpp"
 #include "IrisRestfulNetworking.hpp"
+#include "IrisRestfulCache.hpp"
 #include "IrisRestfulSlide.hpp"
+#include "IrisRestfulDirectory.hpp"
+#include "IrisRestfulCatalog.hpp"
+#include "IrisRestfulWatcher.hpp"
+#include "IrisRestfulReadAhead.hpp"
+#include "IrisRestfulGovernor.hpp"
 #include "IrisRestfulServer.hpp"
 #include "IrisResfultCore.hpp"
 namespace Iris {
 namespace RESTful {
-std::unique_ptr<GetRequest>  parse_get_request   (const std::string_view& target);
+GetRequest                    parse_get_request   (const std::string_view& target);
 std::unique_ptr<PostRequest> parse_post_request  (const std::string_view& target); // Not defined yet
 std::unique_ptr<PutRequest>  parse_put_request   (const std::string_view& target); // Not defined yet
 // TODO: Consider just creating a JSON serializer
 std::string serialize_get_response (const GetResponse& response);
+std::string serialize_slide_metadata (const SlideInfo& info);
+/// UID root of a slide's DICOM objects: 2.25.<UUID derived from a hash of the
+/// slide identifier>. Study <root>.1, series <root>.2, instance <root>.3.<number>
+std::string dicom_uid_root (const std::string_view& id);
+/// DICOM JSON object of each instance (layer) of a slide, in layer order
+std::vector<std::string> serialize_dicom_instances (const SlideInfo& info, const std::string& uid_root);
+/// gzip content-coding of the bytes (empty on failure)
+std::string compress_gzip (const std::string_view& bytes);
 
 }
 }
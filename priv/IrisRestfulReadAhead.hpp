@@ -0,0 +1,75 @@
+/**
+ * @file IrisRestfulReadAhead.hpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief Spatial read-ahead of neighboring tiles into the page cache.
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ */
+
+#ifndef IrisRestfulReadAhead_hpp
+#define IrisRestfulReadAhead_hpp
+namespace Iris {
+namespace RESTful {
+using ReadAhead = std::unique_ptr<class __INTERNAL__ReadAhead>;
+/**
+ * @brief Advises the tiles a viewer is likely to request next
+ *
+ * After a tile (layer, i) is served, the byte ranges of the tiles the session
+ * is expected to request next are advised into the page cache (madvise
+ * MADV_WILLNEED) on the worker pool. A later read of those tiles then takes a
+ * minor rather than a major page fault. While a session pans steadily or
+ * changes layers, its motion (SessionMotion) predicts the next column or row
+ * of its visible region, or the next layer; otherwise the 8-neighborhood,
+ * parent, and children of the tile are advised. At most `budget` read-ahead
+ * tasks are in flight; tiles served beyond that are not followed. Each
+ * in-flight task holds one of `budget` target lists allocated up front, so
+ * that its closure fits a pool task's inline storage. Advised tiles are
+ * flagged within the slide so that hits can be counted.
+ */
+class __INTERNAL__ReadAhead {
+public:
+    static constexpr uint32_t           MAX_TARGETS = 32;
+    struct Target {
+        uint32_t                        layer       = 0;
+        uint32_t                        index       = 0;
+    };
+    struct Targets {
+        PrefetchKind                    kind        = PREFETCH_NEIGHBOR;
+        uint32_t                        count       = 0;
+        Target                          tiles[MAX_TARGETS];
+    };
+private:
+    const Async::ThreadPool             _threads;
+    const uint32_t                      _budget;
+    const std::unique_ptr<Targets[]>    _targets;   // One target list per in-flight task
+    FIFO2::Ring<uint32_t>               _free;      // Indices of the unused target lists
+    std::atomic<uint32_t>               _in_flight;
+    struct {
+        Async::ShardedCounter           issued;     // Tile ranges advised
+        Async::ShardedCounter           predicted;  // ...of which predicted from session motion
+        Async::ShardedCounter           dropped;    // Served tiles not followed (budget or full pool)
+        Async::ShardedCounter           hits;       // Served tiles that had been advised
+        Async::ShardedCounter           predicted_hits;
+        Async::ShardedCounter           misses;     // Served tiles that had not
+        Async::ShardedCounter           bytes;      // Bytes advised
+        Async::ShardedCounter           hit_bytes;  // Bytes advised and then served
+    }                                   _counters;
+public:
+    explicit __INTERNAL__ReadAhead      (const Async::ThreadPool&, uint32_t budget);
+    __INTERNAL__ReadAhead               (const __INTERNAL__ReadAhead&) = delete;
+    __INTERNAL__ReadAhead& operator =   (const __INTERNAL__ReadAhead&) = delete;
+   ~__INTERNAL__ReadAhead               ();
+
+    void    on_tile_served              (const Slide&, uint32_t layer, uint32_t tile, SessionMotion&);
+    void    get_statistics              (ServerStatistics&) const;
+
+private:
+    void    advise                      (const Slide&, const Targets&);
+    void    release                     (uint32_t index);
+};
+} // END RESTFUL
+} // END IRIS
+#endif /* IrisRestfulReadAhead_hpp */
@@ -13,31 +13,104 @@
 #define IrisRestfulServer_hpp
 namespace Iris {
 namespace RESTful {
+/**
+ * @brief Lock-free histogram of request service times (microseconds)
+ *
+ * Log-linear buckets, 8 per power of two: a reported percentile is the upper
+ * bound of its bucket and within 12.5% of the recorded value.
+ */
+class LatencyHistogram {
+    static constexpr uint32_t           SUB_BUCKETS = 8;
+    static constexpr uint32_t           BUCKETS     = SUB_BUCKETS * 62;
+    std::atomic<uint64_t>               _counts[BUCKETS] {};
+public:
+    void        record                  (Time::steady_clock::duration);
+    uint64_t    percentile              (double fraction) const;
+};
 
 class __INTERNAL__Server {
     friend class __INTERNAL__Networking;
     const std::filesystem::path     _root;
     const std::filesystem::path     _doc_root;
-    struct : public std::unordered_map<std::string,
-    std::weak_ptr<__INTERNAL__Slide>> {
+    const std::filesystem::path     _cache_dir;
+    SlideDirectory                  _directory;
+    struct : public std::unordered_map<std::string, Slide> {
+        Mutex                       mutex;
+        uint64_t                    bytes       = 0;
+        std::atomic<int64_t>        next_sweep  = 0;
+        std::unordered_map<std::string, Slide> pinned; // Warm-up API; exempt from the policy
+    }                               _retained;
+    const uint32_t                  _retain_slides;
+    const uint64_t                  _retain_bytes;
+    const Time::seconds             _retain_ttl;
+    struct {
+        std::thread                 thread;     // Sweeps retained slides while idle
+        Mutex                       mutex;
+        Notification                notification;
+        bool                        active      = false;
+    }                               _housekeeping;
+    const bool                      _warm_api;
+    struct {
         SharedMutex                 mutex;
-    }                               _directory;
+        std::unordered_map<std::string, std::string> ids; // One per slide opened or cataloged
+    }                               _dicom_series;          // Series UID -> slide identifier
+    struct {
+        std::atomic<uint32_t>       jobs;       // Warm-ups with a task queued or running
+        atomic_bool                 cancel;     // Set when the server shuts down
+    }                               _warming;
+    struct {
+        Async::ShardedCounter       slide_hits;
+        Async::ShardedCounter       slide_misses;
+        Async::ShardedCounter       slide_evictions;
+        Async::ShardedCounter       tiles_inline;
+        Async::ShardedCounter       tiles_offloaded;
+        Async::ShardedCounter       tile_bytes;
+        Async::ShardedCounter       bytes_copied;
+    }                               _counters;
+    const RequestDispatch           _dispatch;
+    LatencyHistogram                _tile_latency;
+    Catalog                         _catalog;
     Networking                      _networking;
     Async::ThreadPool               _threads;
+    ReadAhead                       _readahead; // Optional; uses _threads
+    MemoryGovernor                  _governor;  // Optional; uses _directory
+    Watcher                         _watcher;   // Last: stops before anything it calls into
 public:
     explicit __INTERNAL__Server     (const ServerCreateInfo&);
     __INTERNAL__Server              (const __INTERNAL__Server&) = delete;
     __INTERNAL__Server& operator == (const __INTERNAL__Server&) = delete;
+   ~__INTERNAL__Server              ();
     void listen                     (uint16_t port);
+    ServerStatistics get_statistics ();
     
 protected:
+    /// Processes the session's in-flight GET request (session->request.target)
+    /// on a worker thread and passes the response to the handler.
+    template <class Session_>
+    void    on_get_request          (const Session_&, GetResponseHandler&&);
+    
+private:
+    /// Serves a tile request on the calling (reactor) thread if the session
+    /// has the slide open and the tile is resident; false to offload it.
     template <class Session_>
-    void    on_get_request          (const Session_&,
-                                     const std::string&,
-                                     const std::function<void(const std::unique_ptr<GetResponse>&)>);
+    bool    serve_resident_tile     (const Session_&, GetResponseHandler&, Time::steady_clock::time_point received);
     
 private:
-    Slide   get_slide               (const std::string& idenfifier);
+    Slide   get_slide               (SessionSlides&, const std::string_view& idenfifier);
+    Slide   get_slide               (const std::string_view& idenfifier, SlideHandle* = nullptr);
+    void    retain_slide            (const Slide&);
+    void    register_dicom_series   (const std::string& idenfifier);
+    void    unregister_dicom_series (const std::string& idenfifier);
+    void    resolve_dicom_series    (GetRequest&);
+    void    on_slide_destroyed      (const std::string& idenfifier);
+    void    on_slide_file_changed   (const std::string& idenfifier, bool removed);
+    void    sweep_retained_slides   (bool force);
+    void    housekeeping            ();
+    void    pin_slide               (const Slide&, bool pin);
+    GetResponse process_warm_request(const WarmSlideRequest&, RequestMethod);
+    void    warm_slide              (const Slide&, std::vector<uint32_t>&& layers);
+    void    warm_tiles              (const Slide&, std::vector<uint32_t>&& layers, size_t layer,
+                                     uint32_t tile, bool counting);
     
 //    void on_post_request            (const Session&,
 //                                     const std::string_view&,
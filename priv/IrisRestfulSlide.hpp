@@ -13,24 +13,138 @@
 #define IrisRestfulSlide_hpp
 namespace Iris {
 namespace RESTful {
-Slide validate_and_open_slide (const std::filesystem::path& file_path);
+/**
+ * @brief Open a slide file, validating it unless an up-to-date entry for the
+ * file exists in the persistent slide-open cache (see IrisRestfulCache.hpp).
+ * Pass an empty cache_dir to always validate and never write cache entries.
+ */
+Slide validate_and_open_slide (const std::filesystem::path& file_path,
+                               const std::filesystem::path& cache_dir = {});
+/**
+ * @brief Validate a slide file (or find its slide-open cache entry) and report
+ * its size and extent without opening it for serving: no read descriptor is
+ * opened and the mapping is neither advised nor retained. Throws on failure.
+ */
+void validate_slide (const std::filesystem::path& file_path,
+                     const std::filesystem::path& cache_dir,
+                     uint64_t& bytes, Extent& extent);
+/**
+ * @brief Metadata response body of a slide, serialized once when it opens
+ *
+ * Metadata never changes for an open slide; every metadata request is served
+ * from these bytes by reference. Each content-coding has its own strong ETag.
+ */
+struct SlideMetadata {
+    std::string                         json;
+    std::string                         gzip;       // Empty if compression did not help
+    std::string                         etag;
+    std::string                         gzip_etag;
+};
+/**
+ * @brief DICOM JSON (WADO-RS) metadata of a slide, generated on first use
+ *
+ * The series body is an array of all instances (one per layer); each
+ * instance body is an array holding that instance alone.
+ */
+struct DicomMetadata {
+    std::string                         series;
+    std::string                         series_etag;
+    std::vector<std::string>            instances;
+    std::vector<std::string>            instance_etags;
+};
+/**
+ * @brief HTTP cache validators of a slide, derived from its file identity
+ *
+ * Tile bytes never change for a given file. A tile's ETag is the slide tag
+ * with its layer and tile index appended; replacing the file changes the tag.
+ */
+struct SlideValidators {
+    std::string                         tag;            // Hex hash of the file identity (unquoted)
+    std::string                         last_modified;  // IMF-fixdate; empty if unavailable
+    int64_t                             modified    = -1;// Seconds since the epoch; -1 if unavailable
+};
+/**
+ * @brief Why a tile was advised into the page cache by read-ahead
+ */
+enum PrefetchKind : uint8_t {
+    PREFETCH_NONE                       = 0,
+    PREFETCH_NEIGHBOR,                  // Static neighborhood of a served tile
+    PREFETCH_PREDICTED,                 // Predicted from the session's motion
+};
+/**
+ * @brief Progress of the slide's latest warm-up (see __INTERNAL__Server::warm_slide)
+ *
+ * The totals are counted by the warm-up tasks ahead of the tiles they warm.
+ */
+struct WarmProgress {
+    std::atomic<bool>                   active;     // A warm-up is counting or warming
+    std::atomic<uint32_t>               tiles;
+    std::atomic<uint32_t>               tiles_warmed;
+    std::atomic<uint64_t>               bytes;
+    std::atomic<uint64_t>               bytes_warmed;
+};
 class __INTERNAL__Slide {
     friend class __INTERNAL__Server;
+    static constexpr auto               PREFETCH_EPOCH = Time::seconds(30);
+    static constexpr auto               TOUCH_INTERVAL = Time::seconds(1);
     const std::string                   _id;
     const IrisCodec::File               _file;
-    const IrisCodec::Abstraction::File  _abstraction;
+    const int                           _fd; // Read-only descriptor for kernel tile delivery
+    const FileIdentity                  _identity;
+    const SlideTileTable                _table;
+    const SlideMetadata                 _metadata;
+    const SlideValidators               _validators;
+    // The full abstraction is only needed for metadata and is built on first use
+    using SlideAbstraction              = std::shared_ptr<const IrisCodec::Abstraction::File>;
+    mutable std::once_flag              _abstraction_flag;
+    mutable SlideAbstraction            _abstraction;
+    mutable std::once_flag              _dicom_flag;
+    mutable DicomMetadata               _dicom;
+    // Two bits per tile entry: the PrefetchKind of a tile advised and not yet
+    // served. Flags expire with their epoch (the pages may since have been
+    // evicted) and are cleared when the slide's pages are released.
+    const std::unique_ptr<std::atomic<uint64_t>[]> _prefetched;
+    mutable std::atomic<int64_t>        _prefetch_epoch;
+    WarmProgress                        _warm;
     std::function<void()>               _remove_from_server_dir;
+    std::atomic<int64_t>                _last_used;
+    atomic_bool                         _retained;
+    atomic_bool                         _stale;    // The file was replaced or removed
 protected:
     void  set_on_destroyed_callback     (const std::function<void()>);
+private:
+    void  reset_prefetched              () const;
 public:
-    explicit __INTERNAL__Slide          (const IrisCodec::File&);
+    explicit __INTERNAL__Slide          (const std::string& id, const IrisCodec::File&, int fd,
+                                         const FileIdentity&, SlideTileTable&&,
+                                         std::string&& metadata_json,
+                                         const SlideAbstraction& = nullptr);
     __INTERNAL__Slide                   (const __INTERNAL__Server&) = delete;
     __INTERNAL__Slide& operator ==      (const __INTERNAL__Server&) = delete;
    ~__INTERNAL__Slide                   ();
     
-    bool operator !=                    (std::string&) const;
+    bool operator !=                    (const std::string&) const;
+    const std::string&  get_id          () const;
+    void                touch           ();
+    bool                is_stale        () const;
+    Time::steady_clock::time_point
+                        last_used       () const;
+    void                advise_layers   () const;
+    size_t              get_mapped_bytes() const;
+    uint64_t            release_pages   () const;
+    bool                is_resident     (const TileData&) const;
+    const FileIdentity& get_identity    () const;
+    const Extent&       get_extent      () const;
     SlideInfo           get_slide_info  () const;
-    Buffer              get_tile_entry  (uint32_t layer, uint32_t tile_indx) const;
+    const SlideMetadata& get_metadata   () const;
+    const SlideValidators& get_validators () const;
+    const DicomMetadata& get_dicom_metadata () const;
+    TileData            get_tile_entry  (uint32_t layer, uint32_t tile_indx) const;
+    bool                flag_prefetched (uint32_t layer, uint32_t tile_indx, PrefetchKind) const;
+    PrefetchKind        clear_prefetched(uint32_t layer, uint32_t tile_indx) const;
+    void                warm_tile       (uint32_t layer, uint32_t tile_indx);
+    const WarmProgress& get_warm_progress () const;
+    int                 get_file_descriptor () const;
 };
 }
 }
@@ -0,0 +1,53 @@
+/**
+ * @file IrisRestfulWatcher.hpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief Slide directory watcher. Reports slide files that were written,
+ * replaced, or removed within the slide root (Linux inotify).
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ */
+
+#ifndef IrisRestfulWatcher_hpp
+#define IrisRestfulWatcher_hpp
+
+#if defined(__linux__)
+#define IRIS_WATCHER_SUPPORTED 1
+#else
+#define IRIS_WATCHER_SUPPORTED 0
+#endif
+
+namespace Iris {
+namespace RESTful {
+using Watcher = std::unique_ptr<class __INTERNAL__Watcher>;
+/**
+ * @brief Watches the slide root for changes to slide files
+ *
+ * Events are only reported once a writer is finished with a file (closed after
+ * writing, or renamed into place) so that partially written slides are never
+ * opened. The callback is invoked on the watcher's own thread, one event at a time.
+ * An empty identifier signals that events were lost (queue overflow) and that
+ * the receiver should re-check the slides it currently depends upon.
+ */
+class __INTERNAL__Watcher {
+public:
+    using Callback                      = std::function<void(const std::string& id, bool removed)>;
+private:
+    const std::filesystem::path         _root;
+    const Callback                      _on_change;
+    const int                           _inotify;
+    atomic_bool                         _active;
+    std::thread                         _thread;
+public:
+    explicit __INTERNAL__Watcher        (const std::filesystem::path& root, const Callback&);
+    __INTERNAL__Watcher                 (const __INTERNAL__Watcher&) = delete;
+    __INTERNAL__Watcher& operator =     (const __INTERNAL__Watcher&) = delete;
+   ~__INTERNAL__Watcher                 ();
+private:
+    void    process_events              ();
+};
+} // END RESTFUL
+} // END IRIS
+#endif /* IrisRestfulWatcher_hpp */
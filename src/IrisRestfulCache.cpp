@@ -0,0 +1,219 @@
+/**
+ * @file IrisRestfulCache.cpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief Persistent slide-open cache
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ * Each validated slide gets one cache file named after its device and inode.
+ * The file records the full file identity (including size and modification
+ * time) followed by the compact tile table. Entries whose identity does not
+ * match the slide on disk are stale and are rebuilt by the caller.
+ *
+ * Layout (native byte order; the cache is local to the host that wrote it):
+ *  [magic u32][version u32][device u64][inode u64][size u64][modified i64]
+ *  [format u32][encoding u32][width u32][height u32][layer count u32]
+ *  per layer:  [x tiles u32][y tiles u32][scale f32][downsample f32][tile count u32]
+ *  per tile:   [offset u64][size u32]
+ *  [metadata JSON length u32][metadata JSON bytes]
+ *  [FNV-1a checksum u64 of all preceding bytes]
+ */
+#include <fstream>
+#include <sstream>
+#include "IrisRestfulPriv.hpp"
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Iris {
+namespace RESTful {
+constexpr uint32_t CACHE_MAGIC      = 0x43535249; // "IRSC"
+constexpr uint32_t CACHE_VERSION    = 2;
+constexpr char     CACHE_EXTENSION[]= ".iriscache";
+
+inline std::filesystem::path CACHE_FILE_PATH (const std::filesystem::path& cache_dir, const FileIdentity& identity)
+{
+    std::stringstream name;
+    name << std::hex << identity.device << "-" << identity.inode << CACHE_EXTENSION;
+    return cache_dir / name.str();
+}
+FileIdentity get_file_identity (int fd, const std::filesystem::path& file_path)
+{
+    FileIdentity identity;
+    #ifndef _WIN32
+    struct stat info;
+    if ((fd > -1 ? fstat(fd, &info) : stat(file_path.c_str(), &info)) != 0)
+        throw std::runtime_error ("Failed to stat slide file (" + file_path.string() + ")");
+    identity.device     = static_cast<uint64_t>(info.st_dev);
+    identity.inode      = static_cast<uint64_t>(info.st_ino);
+    identity.size       = static_cast<uint64_t>(info.st_size);
+    #if defined(__APPLE__)
+    identity.modified   = static_cast<int64_t>(info.st_mtimespec.tv_sec) * 1000000000LL + info.st_mtimespec.tv_nsec;
+    #else
+    identity.modified   = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000LL + info.st_mtim.tv_nsec;
+    #endif
+    #else
+    // No inode on Windows; the canonical path stands in for it.
+    auto canonical      = std::filesystem::canonical(file_path);
+    identity.inode      = std::hash<std::wstring>{}(canonical.wstring());
+    identity.size       = std::filesystem::file_size(canonical);
+    identity.modified   = std::filesystem::last_write_time(canonical).time_since_epoch().count();
+    #endif
+    return identity;
+}
+class CacheWriter {
+    std::string                         _bytes;
+public:
+    template <typename T> void write    (const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        _bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    void reserve                        (size_t size) { _bytes.reserve(size); }
+    std::string& bytes                  () { return _bytes; }
+};
+class CacheReader {
+    const char*                         _ptr;
+    const char* const                   _end;
+public:
+    explicit CacheReader                (const std::string& bytes) :
+    _ptr                                (bytes.data()),
+    _end                                (bytes.data() + bytes.size()) {}
+    template <typename T> T read        ()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (_ptr + sizeof(T) > _end) throw std::runtime_error("cache entry truncated");
+        T value;
+        std::memcpy(&value, _ptr, sizeof(T));
+        _ptr += sizeof(T);
+        return value;
+    }
+    size_t remaining                    () const { return _end - _ptr; }
+};
+bool read_slide_cache (const std::filesystem::path& cache_dir, const FileIdentity& identity, SlideTileTable& table,
+                       std::string& metadata_json)
+{
+    if (cache_dir.empty()) return false;
+
+    std::ifstream file (CACHE_FILE_PATH(cache_dir, identity), std::ios::binary);
+    if (!file) return false;
+    std::string bytes ((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (bytes.size() < sizeof(uint64_t)) return false;
+
+    try {
+        // Verify the checksum before trusting any of the contents
+        const size_t body = bytes.size() - sizeof(uint64_t);
+        uint64_t checksum;
+        std::memcpy(&checksum, bytes.data() + body, sizeof(uint64_t));
+        if (checksum != FNV1A_64(bytes.data(), body)) return false;
+
+        CacheReader reader (bytes);
+        if (reader.read<uint32_t>() != CACHE_MAGIC)   return false;
+        if (reader.read<uint32_t>() != CACHE_VERSION) return false;
+        FileIdentity cached;
+        cached.device   = reader.read<uint64_t>();
+        cached.inode    = reader.read<uint64_t>();
+        cached.size     = reader.read<uint64_t>();
+        cached.modified = reader.read<int64_t>();
+        if (!(cached == identity)) return false; // Stale entry
+
+        SlideTileTable result;
+        result.format           = static_cast<Format>(reader.read<uint32_t>());
+        result.encoding         = static_cast<IrisCodec::Encoding>(reader.read<uint32_t>());
+        result.extent.width     = reader.read<uint32_t>();
+        result.extent.height    = reader.read<uint32_t>();
+        auto layer_count        = reader.read<uint32_t>();
+        if (layer_count > reader.remaining()) return false;
+        result.extent.layers.resize(layer_count);
+        result.layers.reserve(layer_count + 1);
+        uint64_t tiles          = 0;
+        for (auto&& layer : result.extent.layers) {
+            layer.xTiles        = reader.read<uint32_t>();
+            layer.yTiles        = reader.read<uint32_t>();
+            layer.scale         = reader.read<float>();
+            layer.downsample    = reader.read<float>();
+            result.layers.push_back(static_cast<uint32_t>(tiles));
+            tiles              += reader.read<uint32_t>();
+        }
+        result.layers.push_back(static_cast<uint32_t>(tiles));
+        if (tiles * 12 > reader.remaining()) return false;
+        result.entries.resize(tiles);
+        for (auto&& entry : result.entries) {
+            entry.offset        = reader.read<uint64_t>();
+            entry.size          = reader.read<uint32_t>();
+            // Never trust a cache entry to point outside the slide mapping
+            if (entry.offset + entry.size > identity.size) return false;
+        }
+        auto metadata_length    = reader.read<uint32_t>();
+        if (metadata_length + sizeof(uint64_t) != reader.remaining()) return false;
+        metadata_json.assign(bytes.data() + body - metadata_length, metadata_length);
+        table = std::move(result);
+        return true;
+    } catch (std::runtime_error&) {
+        return false;
+    }
+}
+void write_slide_cache (const std::filesystem::path& cache_dir, const FileIdentity& identity, const SlideTileTable& table,
+                        const std::string& metadata_json)
+{
+    if (cache_dir.empty()) return;
+
+    CacheWriter writer;
+    writer.reserve(64 + table.extent.layers.size() * 20 + table.entries.size() * 12 + metadata_json.size());
+    writer.write<uint32_t>(CACHE_MAGIC);
+    writer.write<uint32_t>(CACHE_VERSION);
+    writer.write<uint64_t>(identity.device);
+    writer.write<uint64_t>(identity.inode);
+    writer.write<uint64_t>(identity.size);
+    writer.write<int64_t>(identity.modified);
+    writer.write<uint32_t>(table.format);
+    writer.write<uint32_t>(table.encoding);
+    writer.write<uint32_t>(table.extent.width);
+    writer.write<uint32_t>(table.extent.height);
+    writer.write<uint32_t>(static_cast<uint32_t>(table.extent.layers.size()));
+    for (size_t layer = 0; layer < table.extent.layers.size(); ++layer) {
+        auto& extent = table.extent.layers[layer];
+        writer.write<uint32_t>(extent.xTiles);
+        writer.write<uint32_t>(extent.yTiles);
+        writer.write<float>(extent.scale);
+        writer.write<float>(extent.downsample);
+        writer.write<uint32_t>(table.layers[layer+1] - table.layers[layer]);
+    }
+    for (auto&& entry : table.entries) {
+        writer.write<uint64_t>(entry.offset);
+        writer.write<uint32_t>(entry.size);
+    }
+    writer.write<uint32_t>(static_cast<uint32_t>(metadata_json.size()));
+    writer.bytes().append(metadata_json);
+    auto& bytes = writer.bytes();
+    writer.write<uint64_t>(FNV1A_64(bytes.data(), bytes.size()));
+
+    // Write to a private temporary file and atomically rename it over any
+    // stale entry so that concurrent readers never see a partial file.
+    auto path = CACHE_FILE_PATH(cache_dir, identity);
+    std::stringstream suffix;
+    suffix << ".tmp." << std::this_thread::get_id();
+    auto temp = path; temp += suffix.str();
+    {
+        std::ofstream file (temp, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!file) {
+            std::cerr   << "[WARNING] Failed to write slide cache entry " << temp << "\n";
+            std::error_code error;
+            std::filesystem::remove(temp, error);
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temp, path, error);
+    if (error) {
+        std::cerr   << "[WARNING] Failed to commit slide cache entry " << path
+                    << ": " << error.message() << "\n";
+        std::filesystem::remove(temp, error);
+    }
+}
+} // END RESTFUL
+} // END IRIS
@@ -0,0 +1,178 @@
+/**
+ * @file IrisRestfulCatalog.cpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ */
+#include <algorithm>
+#include "IrisRestfulPriv.hpp"
+
+namespace Iris {
+namespace RESTful {
+constexpr char SLIDE_EXTENSION[] = ".iris";
+__INTERNAL__Catalog::__INTERNAL__Catalog(const std::filesystem::path& root,
+                                         const std::filesystem::path& cache_dir, bool watched) :
+_root       (root),
+_cache_dir  (cache_dir),
+_listing    (nullptr),
+_scanned    (false),
+_watched    (watched)
+{
+
+}
+struct __INTERNAL__Catalog::Scan {
+    const Time::steady_clock::time_point start = Time::steady_clock::now();
+    OnCataloged                         on_cataloged;   // Called per slide the scan adds
+    std::vector<std::filesystem::path> files;
+    std::atomic<size_t>                 next        {0};
+    std::atomic<size_t>                 workers     {0};    // Scanning tasks still running
+    std::atomic<uint64_t>               bytes       {0};
+    std::atomic<uint32_t>               failures    {0};
+    Mutex                               mutex;
+    std::vector<std::pair<std::string, Record>> results;
+};
+void __INTERNAL__Catalog::scan(const Async::ThreadPool& threads, const OnCataloged& on_cataloged)
+{
+    // Listing the directory is cheap; opening and validating each slide
+    // is not. Gather the candidate files here and fan the validation out.
+    // The scan completes in the background on the pool; until it does,
+    // lookups fall back to the slide directory (see find).
+    auto scan = std::make_shared<Scan>();
+    scan->on_cataloged = on_cataloged;
+    std::error_code error;
+    for (auto&& entry : std::filesystem::directory_iterator(_root, error))
+        if (entry.is_regular_file(error) && entry.path().extension() == SLIDE_EXTENSION)
+            scan->files.push_back(entry.path());
+    if (error) std::cerr    << "[WARNING] Slide catalog scan of " << _root
+                            << " was incomplete: " << error.message() << "\n";
+    scan->results.reserve(scan->files.size());
+
+    auto SCAN_FILES = [this, scan]() {
+        std::vector<std::pair<std::string, Record>> local;
+        for (size_t index = scan->next++; index < scan->files.size(); index = scan->next++) {
+            auto& path = scan->files[index];
+            // Exceptions must not escape; the last task finishes the scan.
+            try {
+                // Only the record is needed: validate without opening the
+                // slide for serving (no descriptor, no read-ahead advice).
+                auto id = path.stem().string();
+                Record record {
+                    .path   = path,
+                    .entry  = SlideCatalogEntry {.id = id},
+                };
+                validate_slide(path, _cache_dir, record.entry.bytes, record.entry.extent);
+                scan->bytes += record.entry.bytes;
+                local.emplace_back(std::move(id), std::move(record));
+            } catch (std::exception& e) {
+                ++scan->failures;
+                std::cerr   << "[WARNING] Slide catalog skipped " << path
+                            << ": " << e.what() << "\n";
+            }
+        }
+        MutexLock lock (scan->mutex);
+        std::move(local.begin(), local.end(), std::back_inserter(scan->results));
+        lock.unlock();
+        if (--scan->workers == 0) finish_scan(*scan);
+    };
+
+    const size_t workers = std::max<size_t>(1, std::min<size_t>(scan->files.size(), IRIS_CONCURRENCY));
+    scan->workers = workers;
+    for (size_t worker = 0; worker < workers; ++worker)
+        threads->issue_task(SCAN_FILES);
+}
+void __INTERNAL__Catalog::finish_scan(Scan& scan)
+{
+    // Slides added, replaced, or removed by the watcher during the scan are newer
+    std::vector<std::string> added;
+    ExclusiveLock lock (_mutex);
+    for (auto&& result : scan.results)
+        if (!_erased.contains(result.first) &&
+            _records.try_emplace(result.first, std::move(result.second)).second)
+            added.push_back(std::move(result.first));
+    _erased.clear();
+    _listing.store(nullptr);
+    const auto cataloged = _records.size();
+    _scanned.store(true, std::memory_order_release);
+    lock.unlock();
+    if (scan.on_cataloged)
+        for (auto&& id : added) scan.on_cataloged(id);
+
+    const auto bytes    = scan.bytes.load();
+    const auto seconds  = std::max(Time::duration<double>(Time::steady_clock::now() - scan.start).count(), 1e-6);
+    std::cout   << "[NOTE] Slide catalog: " << cataloged << " slides ("
+                << (bytes >> 20) << " MB) cataloged, " << scan.failures.load()
+                << " skipped, in " << seconds << " s ("
+                << static_cast<uint64_t>(scan.files.size() / seconds) << " slides/s, "
+                << static_cast<uint64_t>((bytes >> 20) / seconds) << " MB/s)\n";
+}
+bool __INTERNAL__Catalog::find(const std::string& id, std::filesystem::path& path) const
+{
+    ReadLock lock (_mutex);
+    auto record = _records.find(id);
+    if (record != _records.end()) {
+        path = record->second.path;
+        return true;
+    }
+    // Until the initial scan completes, or without a watcher to add slides
+    // created since, the catalog is not authoritative
+    if (_watched && _scanned.load(std::memory_order_acquire)) return false;
+    path = _root / (id + SLIDE_EXTENSION);
+    return true;
+}
+void __INTERNAL__Catalog::insert(const std::string& id, const std::filesystem::path& path, const Slide& slide)
+{
+    ExclusiveLock lock (_mutex);
+    _erased.erase(id);
+    _records.insert_or_assign(id, Record {
+        .path   = path,
+        .entry  = SlideCatalogEntry {
+            .id     = id,
+            .bytes  = slide->get_mapped_bytes(),
+            .extent = slide->get_extent(),
+        },
+    });
+    _listing.store(nullptr);
+}
+bool __INTERNAL__Catalog::erase(const std::string& id)
+{
+    ExclusiveLock lock (_mutex);
+    // The scan may have validated the file before it was removed
+    if (!_scanned.load(std::memory_order_relaxed)) _erased.insert(id);
+    if (!_records.erase(id)) return false;
+    _listing.store(nullptr);
+    return true;
+}
+size_t __INTERNAL__Catalog::size() const
+{
+    ReadLock lock (_mutex);
+    return _records.size();
+}
+void __INTERNAL__Catalog::list(uint32_t offset, uint32_t limit, GetSlideListResponse& response) const
+{
+    // Pages are served from an immutable, sorted snapshot so that
+    // consecutive pages are stable while the catalog is unchanged.
+    ReadLock lock (_mutex);
+    Listing listing = _listing.load();
+    if (!listing) {
+        auto sorted = std::make_shared<std::vector<SlideCatalogEntry>>();
+        sorted->reserve(_records.size());
+        for (auto&& record : _records) sorted->push_back(record.second.entry);
+        std::sort(sorted->begin(), sorted->end(), [](auto& a, auto& b) { return a.id < b.id; });
+        listing = sorted;
+        _listing.store(listing);
+    }
+    lock.unlock();
+
+    response.total  = listing->size();
+    response.offset = offset;
+    if (offset >= listing->size()) return;
+    auto first  = listing->begin() + offset;
+    auto last   = first + std::min<size_t>(limit, listing->end() - first);
+    response.slides.assign(first, last);
+}
+} // END RESTFUL
+} // END IRIS
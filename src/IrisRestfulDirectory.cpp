@@ -0,0 +1,228 @@
+/**
+ * @file IrisRestfulDirectory.cpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ */
+#include "IrisRestfulPriv.hpp"
+
+namespace Iris {
+namespace RESTful {
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ //
+//  EPOCH BASED RECLAMATION                         //
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ //
+// A reader publishes the global epoch into its own slot before loading the
+// table pointer and clears it when finished. A table retired at epoch E may
+// be freed once every occupied slot is either clear or holds an epoch >= E,
+// as those readers necessarily loaded the table after it was replaced.
+constexpr size_t EPOCH_SLOTS = 512;
+struct alignas(64) EpochSlot {
+    std::atomic<uint64_t>               epoch       {0};
+    atomic_bool                         owned       {false};
+};
+struct EpochDomain {
+    std::atomic<uint64_t>               global      {1};
+    EpochSlot                           slots[EPOCH_SLOTS];
+};
+inline EpochDomain& EPOCH_DOMAIN ()
+{
+    static EpochDomain domain;
+    return domain;
+}
+struct ThreadEpochSlot {
+    EpochSlot*                          slot        = nullptr;
+    ThreadEpochSlot                     ()
+    {
+        for (auto& candidate : EPOCH_DOMAIN().slots) {
+            bool owned = false;
+            if (candidate.owned.compare_exchange_strong(owned, true)) {
+                slot = &candidate;
+                return;
+            }
+        }
+    }
+   ~ThreadEpochSlot                     ()
+    {
+        if (slot) slot->owned.store(false);
+    }
+};
+inline EpochSlot* THREAD_EPOCH_SLOT ()
+{
+    thread_local ThreadEpochSlot thread_slot;
+    return thread_slot.slot;
+}
+inline uint64_t OLDEST_ACTIVE_EPOCH ()
+{
+    uint64_t oldest = UINT64_MAX;
+    for (auto& slot : EPOCH_DOMAIN().slots)
+        if (auto epoch = slot.epoch.load()) oldest = std::min(oldest, epoch);
+    return oldest;
+}
+inline size_t HASH_IDENTIFIER (const std::string_view& id)
+{
+    return std::hash<std::string_view>{}(id);
+}
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ //
+//  SLIDE DIRECTORY                                 //
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ //
+const SlideDirectory::Entry* SlideDirectory::Table::find(const std::string_view& id, size_t hash) const
+{
+    const size_t mask = buckets.size() - 1;
+    for (size_t index = hash & mask;; index = (index + 1) & mask) {
+        auto& entry = buckets[index];
+        if (!entry.used) return nullptr;
+        if (entry.hash == hash && entry.id == id) return &entry;
+    }
+}
+SlideDirectory::SlideDirectory() :
+_table (new Table { .buckets = std::vector<Entry>(16) })
+{
+
+}
+SlideDirectory::~SlideDirectory()
+{
+    delete _table.load();
+}
+Slide SlideDirectory::find(const std::string_view& id, SlideHandle* handle) const
+{
+    const size_t hash = HASH_IDENTIFIER(id);
+    auto slot = THREAD_EPOCH_SLOT();
+
+    // Out of reader slots (more than EPOCH_SLOTS threads): fall back to
+    // excluding writers, which also keeps the current table alive.
+    if (!slot) {
+        MutexLock lock (_write_mutex);
+        auto entry = _table.load()->find(id, hash);
+        if (handle) *handle = entry ? entry->handle : NULL_SLIDE_HANDLE;
+        return entry ? entry->slide.lock() : nullptr;
+    }
+
+    slot->epoch.store(EPOCH_DOMAIN().global.load());
+    auto entry  = _table.load()->find(id, hash);
+    Slide slide = entry ? entry->slide.lock() : nullptr;
+    if (handle) *handle = entry ? entry->handle : NULL_SLIDE_HANDLE;
+    slot->epoch.store(0, std::memory_order_release);
+    return slide;
+}
+SlideHandle SlideDirectory::handle(const std::string_view& id) const
+{
+    const size_t hash = HASH_IDENTIFIER(id);
+    auto slot = THREAD_EPOCH_SLOT();
+    if (!slot) {
+        MutexLock lock (_write_mutex);
+        auto entry = _table.load()->find(id, hash);
+        return entry ? entry->handle : NULL_SLIDE_HANDLE;
+    }
+    slot->epoch.store(EPOCH_DOMAIN().global.load());
+    auto entry  = _table.load()->find(id, hash);
+    auto handle = entry ? entry->handle : NULL_SLIDE_HANDLE;
+    slot->epoch.store(0, std::memory_order_release);
+    return handle;
+}
+std::vector<std::string> SlideDirectory::identifiers() const
+{
+    MutexLock lock (_write_mutex);
+    std::vector<std::string> ids;
+    for (auto&& entry : _table.load()->buckets)
+        if (entry.used && !entry.slide.expired()) ids.push_back(entry.id);
+    return ids;
+}
+Slide SlideDirectory::insert(const std::string& id, const Slide& slide, SlideHandle* handle)
+{
+    Slide result = slide;
+    update([&](std::vector<Entry>& entries) {
+        for (auto&& entry : entries) if (entry.id == id) {
+            if (handle) *handle = entry.handle;
+            // A competing request / thread may have just opened one as well
+            if (auto existing = entry.slide.lock()) { result = existing; return false; }
+            entry.slide = slide;
+            return true;
+        }
+        // First successful open of this identifier: intern it
+        entries.push_back(Entry {
+            .hash   = HASH_IDENTIFIER(id),
+            .used   = true,
+            .handle = _next_handle++,
+            .id     = id,
+            .slide  = slide,
+        });
+        if (handle) *handle = entries.back().handle;
+        return true;
+    });
+    return result;
+}
+bool SlideDirectory::replace(const std::string& id, const Slide& expected, const Slide& replacement)
+{
+    bool replaced = false;
+    update([&](std::vector<Entry>& entries) {
+        for (auto&& entry : entries)
+            if (entry.id == id) {
+                // Compare owners without locking; a temporary strong reference
+                // could run a slide's destructor (and its callback) in here.
+                if (entry.slide.owner_before(expected) ||
+                    expected.owner_before(entry.slide)) return false;
+                entry.slide = replacement;
+                return replaced = true;
+            }
+        return false;
+    });
+    return replaced;
+}
+void SlideDirectory::erase_expired(const std::string& id)
+{
+    // Avoid a table rebuild when the entry has since been replaced
+    if (find(id)) return;
+    update([&](std::vector<Entry>& entries) {
+        for (auto entry = entries.begin(); entry != entries.end(); ++entry)
+            if (entry->id == id) {
+                if (!entry->slide.expired()) return false;
+                entries.erase(entry);
+                return true;
+            }
+        return false;
+    });
+}
+template <class Modify>
+void SlideDirectory::update(Modify&& modify)
+{
+    MutexLock lock (_write_mutex);
+
+    // Copy the entries, apply the change, and rebuild a table sized
+    // for a load factor of at most one half (probes stay short).
+    std::vector<Entry> entries;
+    auto current = _table.load();
+    entries.reserve(current->size + 1);
+    for (auto&& entry : current->buckets)
+        if (entry.used) entries.push_back(entry);
+    if (!modify(entries)) return;
+
+    size_t capacity = 16;
+    while (capacity < entries.size() * 2) capacity <<= 1;
+    auto table      = std::make_unique<Table>();
+    table->buckets.resize(capacity);
+    table->size     = entries.size();
+    for (auto&& entry : entries) {
+        size_t index = entry.hash & (capacity - 1);
+        while (table->buckets[index].used) index = (index + 1) & (capacity - 1);
+        table->buckets[index] = std::move(entry);
+    }
+    publish(std::move(table));
+}
+void SlideDirectory::publish(std::unique_ptr<Table>&& table)
+{
+    // Called with the write mutex held
+    auto previous   = _table.exchange(table.release());
+    auto epoch      = EPOCH_DOMAIN().global.fetch_add(1) + 1;
+    _retired.emplace_back(epoch, std::unique_ptr<const Table>(previous));
+
+    const auto oldest = OLDEST_ACTIVE_EPOCH();
+    std::erase_if(_retired, [oldest](auto& retired) {
+        return retired.first <= oldest;
+    });
+}
+} // END RESTFUL
+} // END IRIS
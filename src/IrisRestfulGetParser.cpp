@@ -1,12 +1,18 @@
 /**
  * @file IrisRestfulGetParser.cpp
  * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
- * @brief 
+ * @brief
  * @version 0.1
  * @date 2025-06-07
- * 
+ *
  * @copyright Copyright (c) 2025 Iris Developers
- * 
+ *
+ * GET request router. The IrisRESTful and WADO-RS grammars are described by
+ * a static route table (ROUTES). A target is split into path segments in a
+ * single pass and matched against the table; the result is returned by value
+ * as a GetRequest variant that references the target (no allocation). API
+ * keywords are matched case-insensitively while slide identifiers keep their
+ * case, as slide file names are case sensitive on most file systems.
  */
 
 #include <cstring>
@@ -15,273 +21,337 @@
 
 namespace Iris {
 namespace RESTful {
-
-constexpr char target_delin = '/';
-inline std::string_view PARSE_FRONT_TOKEN (const char*& ptr, const char* const end)
+constexpr size_t MAX_TARGET_SEGMENTS = 10;
+struct Target {
+    std::string_view                    path;       // Target without the query
+    std::string_view                    query;      // Following the '?', if any
+    std::string_view                    segments[MAX_TARGET_SEGMENTS];
+    uint8_t                             count       = 0;
+    bool                                overflow    = false;
+};
+enum SegmentKind : uint8_t {
+    SEGMENT_LITERAL,                    // API keyword (case-insensitive)
+    SEGMENT_ANY,                        // Ignored value (e.g. DICOM study UID)
+    SEGMENT_ID,                         // Slide identifier (case preserved)
+    SEGMENT_NUMBER,                     // Unsigned index (layer, then tile)
+    SEGMENT_LIST,                       // Comma separated indices (DICOM frame list)
+    SEGMENT_INSTANCE,                   // Layer index, or a SOP Instance UID ending in its instance number
+};
+struct RouteSegment {
+    SegmentKind                         kind        = SEGMENT_LITERAL;
+    std::string_view                    literal;
+};
+enum RouteType : uint8_t {
+    ROUTE_TILE,
+    ROUTE_TILE_BATCH,
+    ROUTE_FRAMES,
+    ROUTE_VIEWPORT,
+    ROUTE_METADATA,
+    ROUTE_SLIDE_LIST,
+    ROUTE_WARM,
+};
+struct Route {
+    RequestProtocol                     protocol;
+    RouteType                           type;
+    uint8_t                             count;
+    RouteSegment                        segments[MAX_TARGET_SEGMENTS];
+};
+constexpr RouteSegment LITERAL (std::string_view literal) { return RouteSegment {SEGMENT_LITERAL, literal}; }
+constexpr RouteSegment ANY      {SEGMENT_ANY};
+constexpr RouteSegment ID       {SEGMENT_ID};
+constexpr RouteSegment NUMBER   {SEGMENT_NUMBER};
+constexpr RouteSegment LIST     {SEGMENT_LIST};
+constexpr RouteSegment INSTANCE {SEGMENT_INSTANCE};
+constexpr Route ROUTES[] = {
+    // GET /slides/<id>/layers/<layer>/tiles/<tile>
+    {REQUEST_PROTOCOL_IRIS,  ROUTE_TILE,       6, {LITERAL("slides"), ID, LITERAL("layers"), NUMBER, LITERAL("tiles"), NUMBER}},
+    // GET /slides/<id>/layers/<layer>/tiles?indices=<a>,<b>,<c>-<d>
+    {REQUEST_PROTOCOL_IRIS,  ROUTE_TILE_BATCH, 5, {LITERAL("slides"), ID, LITERAL("layers"), NUMBER, LITERAL("tiles")}},
+    // GET /slides/<id>/layers/<layer>/viewport?x=<N>&y=<N>&width=<N>&height=<N>[&space=slide]
+    {REQUEST_PROTOCOL_IRIS,  ROUTE_VIEWPORT,   5, {LITERAL("slides"), ID, LITERAL("layers"), NUMBER, LITERAL("viewport")}},
+    // GET /slides/<id>/metadata
+    {REQUEST_PROTOCOL_IRIS,  ROUTE_METADATA,   3, {LITERAL("slides"), ID, LITERAL("metadata")}},
+    // GET | POST | DELETE /slides/<id>/warm[?layers=<a>,<b>-<c>]
+    {REQUEST_PROTOCOL_IRIS,  ROUTE_WARM,       3, {LITERAL("slides"), ID, LITERAL("warm")}},
+    // GET /slides?offset=<N>&limit=<N>
+    {REQUEST_PROTOCOL_IRIS,  ROUTE_SLIDE_LIST, 1, {LITERAL("slides")}},
+    // Series are addressed by slide identifier or series UID and instances by
+    // layer index or SOP instance UID (see dicom_uid_root)
+    // GET /studies/<study>/series/<UID>/instances/<layer>/frames/<frame> (frame = tile + 1)
+    {REQUEST_PROTOCOL_DICOM, ROUTE_TILE,       8, {LITERAL("studies"), ANY, LITERAL("series"), ID,
+                                                   LITERAL("instances"), INSTANCE, LITERAL("frames"), NUMBER}},
+    // GET /studies/<study>/series/<UID>/instances/<layer>/frames/<frame>,<frame>,...
+    {REQUEST_PROTOCOL_DICOM, ROUTE_FRAMES,     8, {LITERAL("studies"), ANY, LITERAL("series"), ID,
+                                                   LITERAL("instances"), INSTANCE, LITERAL("frames"), LIST}},
+    // GET /studies/<study>/series/<UID>/metadata
+    {REQUEST_PROTOCOL_DICOM, ROUTE_METADATA,   5, {LITERAL("studies"), ANY, LITERAL("series"), ID, LITERAL("metadata")}},
+    // GET /studies/<study>/series/<UID>/instances/<layer>/metadata
+    {REQUEST_PROTOCOL_DICOM, ROUTE_METADATA,   7, {LITERAL("studies"), ANY, LITERAL("series"), ID,
+                                                   LITERAL("instances"), INSTANCE, LITERAL("metadata")}},
+};
+struct MimeType {
+    std::string_view                    extension;
+    std::string_view                    mime;
+};
+constexpr MimeType MIME_TYPES[] = {
+    {".htm",    "text/html"},
+    {".html",   "text/html"},
+    {".php",    "text/html"},
+    {".css",    "text/css"},
+    {".txt",    "text/plain"},
+    {".js",     "application/javascript"},
+    {".json",   "application/json"},
+    {".map",    "application/json"},
+    {".xml",    "application/xml"},
+    {".dzi",    "image/dzi"},
+    {".png",    "image/png"},
+    {".jpe",    "image/jpeg"},
+    {".jpeg",   "image/jpeg"},
+    {".jpg",    "image/jpeg"},
+    {".gif",    "image/gif"},
+    {".bmp",    "image/bmp"},
+    {".ico",    "image/vnd.microsoft.icon"},
+    {".tiff",   "image/tiff"},
+    {".tif",    "image/tiff"},
+    {".svg",    "image/svg+xml"},
+    {".svgz",   "image/svg+xml"},
+    // WARNING! DO NOT ADD THIS LINE UNLESS YOU ARE EXTREMELY SURE YOU
+    // KNOW WHAT YOU ARE DOING AND ACCEPT THIS RISK.
+    // Iris RESTful does not want to allow the full download of Iris files
+    // as a security measure against clients scraping all of your slides.
+    // {".iris",  "image/iris"},
+};
+inline char ASCII_LOWER (char c)
 {
-    // This is basically a safe version of strtok; updates ptr loc as it goes
-    // so that's where the statefulness is.
-    const char* const front = ++ptr; // front skips the delineator
-    unsigned count = 0;
-    for (;ptr < end+1 && *ptr != target_delin; ++ptr,++count);
-    return std::string_view(front, count);
+    // API keywords are ASCII; std::tolower consults the C locale per character
+    return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
 }
-inline std::string_view PARSE_BACK_TOKEN (const char* const front, const char* const end)
+inline bool EQUALS_IGNORE_CASE (const std::string_view& a, const std::string_view& b)
 {
-    // NON stateful; this will NOT change front or end (unlike PARSE_FRONT_TOKEN above)
-    // This just lets you sample the URL end to see if there's a file or command there.
-    const char* r_it = end;
-    unsigned count = 0;
-    for (;r_it != front && *r_it != target_delin; --r_it,++count);
-    return std::string_view(r_it+1, count);
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i)
+        if (ASCII_LOWER(a[i]) != b[i]) return false;
+    return true;
 }
-inline bool PARSE_MIME (const char* const front, const char* const end, std::string* mime)
+inline void SPLIT_TARGET (const std::string_view& target, Target& result)
 {
-    auto token = PARSE_BACK_TOKEN(front, end);
-    const char* r_it = token.end();
-    unsigned count = 0;
-    for (;r_it != token.data() && *r_it != '.'; --r_it,++count);
-    
-    // A file was not indicated
-    if (r_it == token.data()) return false;
-    
-    auto mime_view = std::string_view (r_it,count);
-    if (!mime_view.compare(".htm")) {if(mime)*mime="text/html";}
-    else if (!mime_view.compare(".html")) {if(mime)*mime="text/html";}
-    else if (!mime_view.compare(".php")) {if(mime)*mime="text/html";}
-    else if (!mime_view.compare(".css")) {if(mime)*mime="text/css";}
-    else if (!mime_view.compare(".txt")) {if(mime)*mime="text/plain";}
-    else if (!mime_view.compare(".js")) {if(mime)*mime="application/javascript";}
-    else if (!mime_view.compare(".json")) {if(mime)*mime="application/json";}
-    else if (!mime_view.compare(".map")) {if (mime)*mime="application/json";}
-    else if (!mime_view.compare(".xml")) {if(mime)*mime="application/xml";}
-    else if (!mime_view.compare(".dzi")) {if(mime)*mime="image/dzi";}
-    else if (!mime_view.compare(".png")) {if(mime)*mime="image/png";}
-    else if (!mime_view.compare(".jpe")) {if(mime)*mime="image/jpeg";}
-    else if (!mime_view.compare(".jpeg")) {if(mime)*mime="image/jpeg";}
-    else if (!mime_view.compare(".jpg")) {if(mime)*mime="image/jpeg";}
-    else if (!mime_view.compare(".gif")) {if(mime)*mime="image/gif";}
-    else if (!mime_view.compare(".bmp")) {if(mime)*mime="image/bmp";}
-    else if (!mime_view.compare(".ico")) {if(mime)*mime="image/vnd.microsoft.icon";}
-    else if (!mime_view.compare(".tiff")) {if(mime)*mime="image/tiff";}
-    else if (!mime_view.compare(".tif")) {if(mime)*mime="image/tiff";}
-    else if (!mime_view.compare(".svg")) {if(mime)*mime="image/svg+xml";}
-    else if (!mime_view.compare(".svgz")) {if(mime)*mime="image/svg+xml";}
-    // WARNING! DO NOT UNCOMMENT THIS LINE UNLESS YOU ARE EXTREMELY SURE YOU
-    // KNOW WHAT YOU ARE DOING AND ACCEPT THIS RISK.
-    // Iris RESTful does not want to allow the full download of Iris files
-    // as a security measure against clients scraping all of your slides.
-    // else if (!mime_view.compare(".iris")) {if(mime)*mime="image/iris";}
-    else return false;
+    // Single pass: split path segments on '/' (skipping empty segments)
+    // and stop at the start of the query string.
+    size_t front = 0, index = 0;
+    for (; index <= target.size(); ++index) {
+        const bool end = index == target.size() || target[index] == '?';
+        if (!end && target[index] != '/') continue;
+        if (index > front) {
+            if (result.count == MAX_TARGET_SEGMENTS) result.overflow = true;
+            else result.segments[result.count++] = target.substr(front, index - front);
+        }
+        front = index + 1;
+        if (end) break;
+    }
+    result.path     = target.substr(0, std::min(index, target.size()));
+    if (index < target.size()) result.query = target.substr(index + 1);
+}
+inline bool PARSE_NUMBER (const std::string_view& segment, uint32_t& value)
+{
+    auto result = std::from_chars(segment.data(), segment.data() + segment.size(), value);
+    return result.ec == std::errc{} && result.ptr == segment.data() + segment.size();
+}
+inline bool PARSE_INSTANCE (const std::string_view& segment, uint32_t& layer)
+{
+    // The instance number (the last UID component) counts layers from one
+    if (PARSE_NUMBER(segment, layer)) return true;
+    const auto split = segment.rfind('.');
+    if (split == std::string_view::npos || !PARSE_NUMBER(segment.substr(split + 1), layer) || !layer)
+        return false;
+    --layer;
     return true;
 }
-inline GetRequest::Protocol PARSE_PROTOCOL (const char* loc, const char* const end)
+inline GetRequest PARSE_SLIDE_LIST_QUERY (std::string_view query)
 {
-    auto token = PARSE_FRONT_TOKEN(loc, end);
-    for (; token.size() == 0 && loc < end+1;
-         token = PARSE_FRONT_TOKEN(loc, end));
-    if (token.compare("slides") == 0)
-        return GetRequest::GET_REQUEST_IRIS;
-    else if (token.compare("studies") == 0)
-        return GetRequest::GET_REQUEST_DICOM;
-    else if (PARSE_MIME(loc, end, NULL))
-        return GetRequest::GET_REQUEST_FILE;
-    else return GetRequest::GET_REQUEST_MALFORMED;
+    // Query parameters: offset=<N>&limit=<N> (either optional, any order)
+    GetSlideListRequest request;
+    while (query.size()) {
+        auto param      = query.substr(0, query.find('&'));
+        query.remove_prefix(std::min(query.size(), param.size() + 1));
+        auto split      = param.find('=');
+        if (split == std::string_view::npos) continue;
+        auto key        = param.substr(0, split);
+        uint32_t* field = EQUALS_IGNORE_CASE(key, "offset") ? &request.offset :
+                          EQUALS_IGNORE_CASE(key, "limit")  ? &request.limit  : nullptr;
+        if (field && !PARSE_NUMBER(param.substr(split + 1), *field))
+            return GetMalformedRequest {"Expected numerical 'offset' and 'limit' values in IrisRESTful slide listing query."};
+    }
+    return request;
 }
-inline GetRequest::Type PARSE_COMMAND (const char* const front, const char* const end)
+inline GetRequest PARSE_TILE_BATCH_QUERY (std::string_view query, const std::string_view& id, uint32_t layer)
 {
-    auto back_token = PARSE_BACK_TOKEN(front, end);
-    if (std::isdigit(*end))
-        return GetRequest::GET_REQUEST_TILE;
-    else if (back_token.compare("metadata") == 0)
-        return GetRequest::GET_REQUEST_METADATA;
-    else if (back_token.compare("thumbnail") == 0)
-        assert(false&&"NOT BUILT YET");
-    else if (back_token.compare("slide_label") == 0)
-        assert(false&&"NOT BUILT YET");
-    else if (back_token.compare("rendered") == 0)
-        assert(false&&"NOT BUILT  YET");
-    
-    return GetRequest::GET_REQUEST_UNDEFINED;
+    // Query parameter: indices=<a>,<b>,<c>-<d> (expanded by the server)
+    while (query.size()) {
+        auto param      = query.substr(0, query.find('&'));
+        query.remove_prefix(std::min(query.size(), param.size() + 1));
+        auto split      = param.find('=');
+        if (split == std::string_view::npos || !EQUALS_IGNORE_CASE(param.substr(0, split), "indices")) continue;
+        auto indices    = param.substr(split + 1);
+        if (indices.empty() || indices.find_first_not_of("0123456789,-") != std::string_view::npos) break;
+        return GetTileBatchRequest {
+            .id         = id,
+            .layer      = layer,
+            .indices    = indices,
+        };
+    }
+    return GetMalformedRequest {"Expected a tile 'indices' list (e.g. indices=0,4,8-12) in IrisRESTful tile batch query."};
 }
-inline std::unique_ptr<GetRequest> PARSE_IRIS_REQUEST (const char* loc, const char* const end) {
-    std::string error_string;
-    if (PARSE_FRONT_TOKEN(loc, end).compare("slides"))
-        throw std::runtime_error(std::string("PARSE_IRIS_REQUEST called on non-IrisRESTful API GET request. Go to file ") +
-                                 __FILE__ + " line " +std::to_string(__LINE__) + " to debug.");
-    
-    switch (PARSE_COMMAND(loc, end)) {
-        case GetRequest::GET_REQUEST_UNDEFINED:
-            error_string = "Undefined command sequence (last token) in IrisRESTful target URL. Please ensure your command conforms to the IrisRestful API.";
-            goto MALFORMED_IRIS_REQUEST;
-            
-        case GetRequest::GET_REQUEST_TILE: {
-            auto request = std::make_unique<GetTileRequest>();
-            request->protocol   = GetRequest::GET_REQUEST_IRIS;
-            request->type       = GetRequest::GET_REQUEST_TILE;
-            request->id         = PARSE_FRONT_TOKEN(loc, end);
-            auto layer_str      = PARSE_FRONT_TOKEN(loc, end);
-            if (layer_str.compare("layers")){ //PARSE_FRONT_TOKEN(loc, end).compare("layers")) {
-                error_string = "Expected 'layers' following slide identifier in IrisRESTful GET tile command target URL";
-                goto MALFORMED_IRIS_REQUEST;
-            }
-            auto layer          = PARSE_FRONT_TOKEN(loc, end);
-            auto result         = std::from_chars (layer.data(), layer.data()+layer.size(), request->layer);
-            if (result.ec == std::errc::invalid_argument) {
-                error_string = "Expected numerical 'layers' value in IrisRESTful GET tile command target URL.";
-                goto MALFORMED_IRIS_REQUEST;
-            }
-            if (PARSE_FRONT_TOKEN(loc, end).compare("tiles")) {
-                error_string = "Expected 'tiles' following layer index in IrisRESTful GET tile command target URL";
-                goto MALFORMED_IRIS_REQUEST;
-            }
-            auto tile           = PARSE_FRONT_TOKEN(loc, end);
-            result              = std::from_chars (tile.data(), tile.data()+tile.size(), request->tile);
-            if (result.ec == std::errc::invalid_argument) {
-                error_string = "Expected single numerical 'tiles' value in IrisRESTful GET tile command target URL.";
-                goto MALFORMED_IRIS_REQUEST;
-            }
-            return request;
-        }
-        case GetRequest::GET_REQUEST_METADATA: {
-            auto request = std::make_unique<GetMetadataRequest>();
-            request->protocol   = GetRequest::GET_REQUEST_IRIS;
-            request->type       = GetRequest::GET_REQUEST_METADATA;
-            request->id         = PARSE_FRONT_TOKEN(loc, end);
-            return request;
+inline GetRequest PARSE_VIEWPORT_QUERY (std::string_view query, const std::string_view& id, uint32_t layer)
+{
+    // Query parameters: x, y, width, height (layer pixels unless space=slide)
+    GetViewportRequest request {
+        .id     = id,
+        .layer  = layer,
+    };
+    while (query.size()) {
+        auto param      = query.substr(0, query.find('&'));
+        query.remove_prefix(std::min(query.size(), param.size() + 1));
+        auto split      = param.find('=');
+        if (split == std::string_view::npos) continue;
+        auto key        = param.substr(0, split);
+        auto value      = param.substr(split + 1);
+        if (EQUALS_IGNORE_CASE(key, "space")) {
+            if (EQUALS_IGNORE_CASE(value, "slide")) request.slide_space = true;
+            else if (!EQUALS_IGNORE_CASE(value, "layer"))
+                return GetMalformedRequest {"Expected 'space=layer' or 'space=slide' in IrisRESTful viewport query."};
+            continue;
         }
+        uint32_t* field = EQUALS_IGNORE_CASE(key, "x")      ? &request.x      :
+                          EQUALS_IGNORE_CASE(key, "y")      ? &request.y      :
+                          EQUALS_IGNORE_CASE(key, "width")  ? &request.width  :
+                          EQUALS_IGNORE_CASE(key, "height") ? &request.height : nullptr;
+        if (field && !PARSE_NUMBER(value, *field))
+            return GetMalformedRequest {"Expected numerical 'x', 'y', 'width', and 'height' values in IrisRESTful viewport query."};
     }
-    
-    error_string = "Undefined command sequence in IrisRESTful target URL. Please ensure your command conforms to the IrisRestful API.";
-    
-    MALFORMED_IRIS_REQUEST:
-    auto request = std::make_unique<GetRequest>();
-    request->protocol = GetRequest::GET_REQUEST_MALFORMED;
-    request->error_msg = error_string;
+    if (!request.width || !request.height)
+        return GetMalformedRequest {"Expected non-zero 'width' and 'height' values in IrisRESTful viewport query."};
     return request;
 }
-
-inline std::unique_ptr<GetRequest> PARSE_DICOM_REQUEST (const char* loc, const char* const end) {
-    std::string error_string;
-    
-    if (PARSE_FRONT_TOKEN(loc, end).compare("studies"))
-        throw std::runtime_error(std::string("PARSE_DICOM_REQUEST called on non-WADO-RS API GET request. Go to file ") +
-                                 __FILE__ + " line " +std::to_string(__LINE__) + " to debug.");
-    
-    // Get the study identifier
-    //    std::string_view study =
-    PARSE_FRONT_TOKEN(loc, end); // STUDY Currently unused
-    
-    switch (PARSE_COMMAND(loc, end)) {
-        case GetRequest::GET_REQUEST_UNDEFINED:
-            error_string = "Undefined command sequence (last token) in DICOM/WADO-RS target URL. Please ensure your command conforms to IrisRestful API compliant WADO-RS commands.";
-            goto MALFORMED_DICOM_REQUEST;
-            
-        case GetRequest::GET_REQUEST_TILE: {
-            auto request = std::make_unique<GetTileRequest>();
-            request->protocol   = GetRequest::GET_REQUEST_DICOM;
-            request->type       = GetRequest::GET_REQUEST_TILE;
-            if (PARSE_FRONT_TOKEN(loc, end).compare("series")) {
-                error_string = "Expected 'series' following study identifier in DICOM/WADO-RS target URL.";
-                goto MALFORMED_DICOM_REQUEST;
-            }
-            request->id         = PARSE_FRONT_TOKEN(loc, end);
-            if (PARSE_FRONT_TOKEN(loc, end).compare("instances")) {
-                error_string = "Expected 'instances' following series in DICOM/WADO-RS target URL.";
-                goto MALFORMED_DICOM_REQUEST;
-            }
-            auto layer          = PARSE_FRONT_TOKEN(loc, end);
-            auto result         = std::from_chars (layer.data(), layer.data()+layer.size(), request->layer);
-            if (result.ec == std::errc::invalid_argument) {
-                error_string = "Expected numerical 'instances' value in DICOM/WADO-RS target URL representing the resolution layer.";
-                goto MALFORMED_DICOM_REQUEST;
-            }
-            if (PARSE_FRONT_TOKEN(loc, end).compare("frames")) {
-                error_string = "Expected 'instances' following series in DICOM/WADO-RS target URL.";
-                goto MALFORMED_DICOM_REQUEST;
-            }
-            auto tile           = PARSE_FRONT_TOKEN(loc, end);
-            result              = std::from_chars (tile.data(), tile.data()+tile.size(), request->tile);
-            if (result.ec == std::errc::invalid_argument) {
-                error_string = "Expected numerical 'instances' value in DICOM/WADO-RS target URL representing the resolution layer.";
-                goto MALFORMED_DICOM_REQUEST;
-            }
-            return request;
-        }
-        case GetRequest::GET_REQUEST_METADATA: {
-            auto request = std::make_unique<GetMetadataRequest>();
-            request->protocol   = GetRequest::GET_REQUEST_DICOM;
-            request->type       = GetRequest::GET_REQUEST_METADATA;
-            if (PARSE_FRONT_TOKEN(loc, end).compare("series")) {
-                error_string = "Expected 'series' following study in DICOM/WADO-RS target URL. Please ensure metadata requests conform to IrisRestful API compliant WADO-RS commands.";
-                goto MALFORMED_DICOM_REQUEST;
-            }
-            request->id         = PARSE_FRONT_TOKEN(loc, end);
-            return request;
-        }
+inline GetRequest PARSE_WARM_QUERY (std::string_view query, const std::string_view& id)
+{
+    // Query parameter: layers=<a>,<b>-<c> (optional; expanded by the server)
+    WarmSlideRequest request {
+        .id     = id,
+    };
+    while (query.size()) {
+        auto param      = query.substr(0, query.find('&'));
+        query.remove_prefix(std::min(query.size(), param.size() + 1));
+        auto split      = param.find('=');
+        if (split == std::string_view::npos || !EQUALS_IGNORE_CASE(param.substr(0, split), "layers")) continue;
+        request.layers  = param.substr(split + 1);
+        if (request.layers.empty() || request.layers.find_first_not_of("0123456789,-") != std::string_view::npos)
+            return GetMalformedRequest {"Expected a 'layers' list (e.g. layers=0-3) in IrisRESTful slide warm-up query."};
     }
-    
-    // Any fall through
-    error_string = "Undefined command sequence (last token) in DICOM/WADO-RS target URL. Please ensure your command conforms to IrisRestful API compliant WADO-RS commands.";
-    
-MALFORMED_DICOM_REQUEST:
-    auto request = std::make_unique<GetRequest>();
-    request->protocol = GetRequest::GET_REQUEST_MALFORMED;
-    request->error_msg = error_string;
     return request;
 }
-inline std::unique_ptr<GetRequest> PARSE_FILE_REQUEST (const char* loc, const char* const end) {
-    std::string error_string;
-    auto test = std::string(loc);
-    if (std::strcmp(loc, "/") == 0) {
-        auto request        = std::make_unique<GetFileRequest>();
-        request->protocol   = GetRequest::GET_REQUEST_FILE;
-        request->path       = std::string("/index.html");
-    } else if (loc[0] != '/' || std::string(loc).find("..") != std::string::npos) {
-        error_string = "Illegal request-target";
-        goto MALFORMED_FILE_REQUEST;
-    } else {
-        auto request        = std::make_unique<GetFileRequest>();
-        request->protocol   = GetRequest::GET_REQUEST_FILE;
-        request->path       = std::string(loc);
-        if (!PARSE_MIME(loc, end, &request->mime)) {
-            auto file_token = std::string(PARSE_BACK_TOKEN(loc, end));
-            error_string = std::string("Unrecognized file type ") + file_token;
-            goto MALFORMED_FILE_REQUEST;
+inline GetRequest MATCH_ROUTE (const Target& target, const Route& route)
+{
+    std::string_view id, list;
+    uint32_t numbers[2] = {0, 0};
+    uint8_t  number     = 0;
+    for (uint8_t index = 0; index < route.count; ++index) {
+        auto& segment   = target.segments[index];
+        auto& pattern   = route.segments[index];
+        switch (pattern.kind) {
+            case SEGMENT_LITERAL:
+                if (!EQUALS_IGNORE_CASE(segment, pattern.literal)) goto NO_MATCH;
+                break;
+            case SEGMENT_ANY:
+                break;
+            case SEGMENT_ID:
+                id = segment;
+                break;
+            case SEGMENT_NUMBER:
+                if (number == 2 || !PARSE_NUMBER(segment, numbers[number++])) goto NO_MATCH;
+                break;
+            case SEGMENT_INSTANCE:
+                if (number == 2 || !PARSE_INSTANCE(segment, numbers[number++])) goto NO_MATCH;
+                break;
+            case SEGMENT_LIST:
+                if (segment.find_first_not_of("0123456789,") != std::string_view::npos) goto NO_MATCH;
+                list = segment;
+                break;
         }
-        return request;
     }
-    
-    
-MALFORMED_FILE_REQUEST:
-    auto request = std::make_unique<GetRequest>();
-    request->protocol = GetRequest::GET_REQUEST_MALFORMED;
-    request->error_msg = error_string;
-    return request;
+    switch (route.type) {
+        case ROUTE_TILE:
+            // DICOMweb frame numbers are 1-based (frame N is tile N - 1)
+            if (route.protocol == REQUEST_PROTOCOL_DICOM && numbers[1]-- == 0)
+                return GetMalformedRequest {"DICOM frame numbers start at 1."};
+            return GetTileRequest {
+                .protocol   = route.protocol,
+                .id         = id,
+                .layer      = numbers[0],
+                .tile       = numbers[1],
+            };
+        case ROUTE_TILE_BATCH:
+            return PARSE_TILE_BATCH_QUERY(target.query, id, numbers[0]);
+        case ROUTE_FRAMES:
+            return GetTileBatchRequest {
+                .protocol   = route.protocol,
+                .id         = id,
+                .layer      = numbers[0],
+                .indices    = list,
+            };
+        case ROUTE_VIEWPORT:
+            return PARSE_VIEWPORT_QUERY(target.query, id, numbers[0]);
+        case ROUTE_METADATA:
+            return GetMetadataRequest {
+                .protocol   = route.protocol,
+                .id         = id,
+                .instance   = number ? static_cast<int32_t>(std::min<uint32_t>(numbers[0], INT32_MAX)) : -1,
+            };
+        case ROUTE_SLIDE_LIST:
+            return PARSE_SLIDE_LIST_QUERY(target.query);
+        case ROUTE_WARM:
+            return PARSE_WARM_QUERY(target.query, id);
+    }
+    NO_MATCH:
+    return GetMalformedRequest {};
 }
-std::unique_ptr<Iris::RESTful::GetRequest>  parse_get_request (const std::string_view& target)
+inline GetRequest PARSE_FILE_REQUEST (const Target& target)
 {
-    // Make sure the request is lower-case to avoid non-match d/t case
-    for (auto& c : target) const_cast<char&>(c) = tolower(c);
-    const char* loc = &target.front();
-    const char* const end = &target.back();
-    
-    // Parse the protocol. This will identify undefined protocols early and return
-    // without having to parse the entire thing.
-    switch (PARSE_PROTOCOL(loc, end)) {
-        case GetRequest::GET_REQUEST_IRIS:
-            return PARSE_IRIS_REQUEST(loc, end);
-        case GetRequest::GET_REQUEST_DICOM:
-            return PARSE_DICOM_REQUEST(loc, end);
-        case GetRequest::GET_REQUEST_FILE:
-            return PARSE_FILE_REQUEST(loc,end);
-        default: {
-            auto request = std::make_unique<GetRequest>();
-            request->protocol = GetRequest::GET_REQUEST_MALFORMED;
-            request->error_msg = "Undefined GET request protocol. Please follow either IrisRESTful or DICOMweb WADO-RS API";
+    auto& path = target.path;
+    if (path.empty() || path.front() != '/' || path.find("..") != std::string_view::npos)
+        return GetMalformedRequest {"Illegal request-target"};
+
+    auto name       = path.substr(path.rfind('/') + 1);
+    auto extension  = name.rfind('.');
+    if (extension != std::string_view::npos)
+        for (auto&& type : MIME_TYPES)
+            if (EQUALS_IGNORE_CASE(name.substr(extension), type.extension))
+                return GetFileRequest {
+                    .mime   = type.mime,
+                    .path   = path,
+                };
+    return GetMalformedRequest {"Undefined GET request protocol. Please follow either IrisRESTful or DICOMweb WADO-RS API"};
+}
+GetRequest parse_get_request (const std::string_view& target)
+{
+    Target parsed;
+    SPLIT_TARGET(target, parsed);
+    if (parsed.count == 0 || parsed.overflow) return PARSE_FILE_REQUEST(parsed);
+
+    // Only routes of the same depth and API root can match
+    const bool iris  = EQUALS_IGNORE_CASE(parsed.segments[0], "slides");
+    const bool dicom = !iris && EQUALS_IGNORE_CASE(parsed.segments[0], "studies");
+    if (!iris && !dicom) return PARSE_FILE_REQUEST(parsed);
+
+    for (auto&& route : ROUTES) {
+        if (route.count != parsed.count) continue;
+        auto request = MATCH_ROUTE(parsed, route);
+        if (!std::holds_alternative<GetMalformedRequest>(request) ||
+            std::get<GetMalformedRequest>(request).error_msg.size())
             return request;
-        }
     }
+    return GetMalformedRequest {iris ?
+        "Undefined command sequence in IrisRESTful target URL. Please ensure your command conforms to the IrisRestful API." :
+        "Undefined command sequence in DICOM/WADO-RS target URL. Please ensure your command conforms to IrisRestful API compliant WADO-RS commands."};
 }
+} // END RESTFUL
 } // END IRIS
-} // END 
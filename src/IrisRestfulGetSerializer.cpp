@@ -1,97 +1,384 @@
 /**
  * @file IrisRestfulGetSerializer.cpp
  * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
- * @brief 
+ * @brief
  * @version 0.1
  * @date 2025-06-07
- * 
+ *
  * @copyright Copyright (c) 2025 Iris Developers
- * 
+ *
  */
-#include <sstream>
-#include <streambuf>
+#include <cmath>
+#include <algorithm>
+#include <charconv>
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Weverything"
+#endif // __clang__
+#include <boost/beast/zlib/deflate_stream.hpp>  // Header-only raw deflate
+#include <boost/crc.hpp>                        // gzip trailer CRC-32
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif // __clang__
 #include "IrisRestfulPriv.hpp"
 
 namespace Iris {
 namespace RESTful {
-inline std::string SERIALIZE_FORMAT (const Iris::Format &format)
+/**
+ * @brief Minimal JSON emitter appending directly to a string.
+ *
+ * Numbers are written with std::to_chars (locale independent, shortest
+ * round-trip form for floating point); commas are placed automatically.
+ */
+class JSONWriter {
+    std::string&                        _out;
+    bool                                _first      = true;
+public:
+    explicit JSONWriter                 (std::string& out) : _out(out) {}
+    JSONWriter& begin_object            () { separate(); _out += '{'; _first = true; return *this; }
+    JSONWriter& end_object              () { _out += '}'; _first = false; return *this; }
+    JSONWriter& begin_array             () { separate(); _out += '['; _first = true; return *this; }
+    JSONWriter& end_array               () { _out += ']'; _first = false; return *this; }
+    JSONWriter& key                     (const std::string_view& key)
+    {
+        string(key);
+        _out += ':';
+        _first = true; // The value follows without a comma
+        return *this;
+    }
+    JSONWriter& string                  (const std::string_view& value)
+    {
+        constexpr char HEX[] = "0123456789abcdef";
+        separate();
+        _out += '"';
+        for (char c : value) switch (c) {
+            case '"':   _out += "\\\""; break;
+            case '\\':  _out += "\\\\"; break;
+            case '\n':  _out += "\\n"; break;
+            case '\r':  _out += "\\r"; break;
+            case '\t':  _out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    _out += "\\u00";
+                    _out += HEX[c >> 4];
+                    _out += HEX[c & 0xF];
+                } else _out += c;
+        }
+        _out += '"';
+        _first = false;
+        return *this;
+    }
+    JSONWriter& boolean                 (bool value)
+    {
+        separate();
+        _out += value ? "true" : "false";
+        return *this;
+    }
+    template <class Number>
+    JSONWriter& number                  (Number value)
+    {
+        separate();
+        if constexpr (std::is_floating_point_v<Number>)
+            if (!std::isfinite(value)) { _out += "null"; _first = false; return *this; }
+        char buffer[32];
+        auto end = std::to_chars(buffer, buffer + sizeof(buffer), value).ptr;
+        _out.append(buffer, end);
+        _first = false;
+        return *this;
+    }
+private:
+    void separate                       ()
+    {
+        if (!_first) _out += ',';
+        _first = false;
+    }
+};
+inline std::string_view SERIALIZE_FORMAT (const Iris::Format &format)
 {
     switch (format) {
-        case FORMAT_UNDEFINED:  return "\"FORMAT_UNDEFINED\"";
-        case FORMAT_B8G8R8:     return "\"FORMAT_B8G8R8\"";
-        case FORMAT_R8G8B8:     return "\"FORMAT_R8G8B8\"";
-        case FORMAT_B8G8R8A8:   return "\"FORMAT_B8G8R8A8\"";
-        case FORMAT_R8G8B8A8:   return "\"FORMAT_R8G8B8A8\"";
+        case FORMAT_UNDEFINED:  return "FORMAT_UNDEFINED";
+        case FORMAT_B8G8R8:     return "FORMAT_B8G8R8";
+        case FORMAT_R8G8B8:     return "FORMAT_R8G8B8";
+        case FORMAT_B8G8R8A8:   return "FORMAT_B8G8R8A8";
+        case FORMAT_R8G8B8A8:   return "FORMAT_R8G8B8A8";
     }
-    return "\"UNDEFINED FORMAT\"";
+    return "UNDEFINED FORMAT";
 }
-inline std::string SERIALIZE_ENCODING (const IrisCodec::Encoding &encoding)
+inline std::string_view SERIALIZE_ENCODING (const IrisCodec::Encoding &encoding)
 {
     switch (encoding) {
-        case IrisCodec::TILE_ENCODING_UNDEFINED:    return "\"ENCODING_UNDEFINED\"";
-        case IrisCodec::TILE_ENCODING_IRIS:         return "\"image/iris\"";
-        case IrisCodec::TILE_ENCODING_JPEG:         return "\"image/jpeg\"";
-        case IrisCodec::TILE_ENCODING_AVIF:         return "\"image/avif\"";
+        case IrisCodec::TILE_ENCODING_UNDEFINED:    return "ENCODING_UNDEFINED";
+        case IrisCodec::TILE_ENCODING_IRIS:         return "image/iris";
+        case IrisCodec::TILE_ENCODING_JPEG:         return "image/jpeg";
+        case IrisCodec::TILE_ENCODING_AVIF:         return "image/avif";
     }
-    return "\"UNDEFINED ENCODING\"";
+    return "UNDEFINED ENCODING";
 }
-inline void SERIALIZE_LAYER_EXTENT (const LayerExtents &extent, std::stringstream& stream)
+inline void SERIALIZE_LAYER_EXTENT (const LayerExtents &extent, JSONWriter& json)
 {
-    stream << "[";
+    json.begin_array();
     for (auto&& layer : extent) {
-        stream  << "{"
-                << "\"x_tiles\": " << layer.xTiles << ","
-                << "\"y_tiles\": " << layer.yTiles << ","
-                << "\"scale\": " << layer.scale
-                << "},";
+        json.begin_object();
+        json.key("x_tiles").number(layer.xTiles);
+        json.key("y_tiles").number(layer.yTiles);
+        json.key("scale").number(layer.scale);
+        json.end_object();
     }
-    stream.seekp(-1,stream.cur) << "]";
+    json.end_array();
 }
-inline void SERALIZE_SLIDE_EXTENT (const Extent &extent, std::stringstream& stream)
+inline void SERALIZE_SLIDE_EXTENT (const Extent &extent, JSONWriter& json)
 {
-    stream  << "{"
-            << "\"width\": " << extent.width << ","
-            << "\"height\": " << extent.height << ","
-            << "\"layers\": ";
-    
-    SERIALIZE_LAYER_EXTENT(extent.layers, stream);
-    stream << "},";
+    json.begin_object();
+    json.key("width").number(extent.width);
+    json.key("height").number(extent.height);
+    json.key("layers");
+    SERIALIZE_LAYER_EXTENT(extent.layers, json);
+    json.end_object();
 }
-inline std::string SERIALIZE_SLIDE_METADATA_JSON (const GetResponse& response)
+inline void SERIALIZE_ATTRIBUTES (const IrisCodec::Attributes &attributes, JSONWriter& json)
 {
-    assert(response.type == GetResponse::GET_RESPONSE_METADATA && "");
-    auto& info = reinterpret_cast<const GetMetadataResponse&>(response).slideInfo;
-    
-    std::stringstream stream;
-    stream << "{";
-    stream << "\"type\": \"slide_metadata\",";
+    // Sort the attributes so that identical metadata always
+    // produces identical bytes (and thus an identical ETag).
+    std::vector<const IrisCodec::Attributes::value_type*> sorted;
+    sorted.reserve(attributes.size());
+    for (auto&& attribute : attributes) sorted.push_back(&attribute);
+    std::sort(sorted.begin(), sorted.end(), [](auto a, auto b) { return a->first < b->first; });
+
+    json.begin_object();
+    for (auto attribute : sorted) json.key(attribute->first).string(std::string_view
+        (reinterpret_cast<const char*>(attribute->second.data()), attribute->second.size()));
+    json.end_object();
+}
+inline void SERIALIZE_METADATA (const IrisCodec::Metadata &metadata, JSONWriter& json)
+{
+    // Members of the slide metadata object (see README Metadata Structure)
+    if (metadata.micronsPerPixel > 0.f)
+        json.key("microns_per_pixel").number(metadata.micronsPerPixel);
+    if (metadata.magnification > 0.f)
+        json.key("magnification").number(metadata.magnification);
+    json.key("attributes");
+    SERIALIZE_ATTRIBUTES(metadata.attributes, json);
+    json.key("associated_images").begin_array();
+    for (auto&& image : metadata.associatedImages) json.string(image);
+    json.end_array();
+}
+std::string serialize_slide_metadata (const SlideInfo& info)
+{
+    std::string out;
+    JSONWriter json (out);
+    json.begin_object();
+    json.key("type").string("slide_metadata");
     if (info.format)
-        stream  <<"\"format\": " << SERIALIZE_FORMAT (info.format) << ",";
+        json.key("format").string(SERIALIZE_FORMAT(info.format));
     if (info.encoding)
-        stream  <<"\"encoding\": " << SERIALIZE_ENCODING(info.encoding) << ",";
+        json.key("encoding").string(SERIALIZE_ENCODING(info.encoding));
+    json.key("extent");
+    SERALIZE_SLIDE_EXTENT(info.extent, json);
+    SERIALIZE_METADATA(info.metadata, json);
+    json.end_object();
+    return out;
+}
+// DICOM JSON model (PS3.18 F.2): attributes keyed by tag in ascending order
+inline void DICOM_ATTRIBUTE (JSONWriter& json, const std::string_view& tag, const std::string_view& vr)
+{
+    json.key(tag).begin_object();
+    json.key("vr").string(vr);
+    json.key("Value").begin_array();
+}
+inline void DICOM_STRING (JSONWriter& json, const std::string_view& tag, const std::string_view& vr,
+                          std::initializer_list<std::string_view> values)
+{
+    DICOM_ATTRIBUTE(json, tag, vr);
+    for (auto&& value : values) json.string(value);
+    json.end_array().end_object();
+}
+template <class Number>
+inline void DICOM_NUMBER (JSONWriter& json, const std::string_view& tag, const std::string_view& vr,
+                          std::initializer_list<Number> values)
+{
+    DICOM_ATTRIBUTE(json, tag, vr);
+    for (auto&& value : values) json.number(value);
+    json.end_array().end_object();
+}
+std::string dicom_uid_root (const std::string_view& id)
+{
+    // A name-based UUID (version 8) from two hashes of the identifier, written
+    // as a decimal integer under the UUID-derived root (PS3.5 B.2). It depends
+    // only on the identifier so that viewers may keep the UIDs across restarts.
+    const std::string salted = "dicom:" + std::string(id);
+    uint64_t high = FNV1A_64(id.data(), id.size());
+    uint64_t low  = FNV1A_64(salted.data(), salted.size());
+    high = (high & ~0xF000ULL) | 0x8000ULL;                             // Version
+    low  = (low & 0x3FFFFFFFFFFFFFFFULL) | 0x8000000000000000ULL;       // Variant
     
-    stream <<"\"extent\": ";
-    SERALIZE_SLIDE_EXTENT(info.extent,stream);
+    // 128-bit decimal conversion by repeated division of 32-bit limbs
+    uint32_t limbs[4] = {
+        static_cast<uint32_t>(high >> 32), static_cast<uint32_t>(high),
+        static_cast<uint32_t>(low >> 32),  static_cast<uint32_t>(low),
+    };
+    char digits[40];
+    size_t count = 0;
+    for (bool nonzero = true; nonzero;) {
+        uint64_t remainder = 0;
+        nonzero = false;
+        for (auto& limb : limbs) {
+            const uint64_t value = (remainder << 32) | limb;
+            limb        = static_cast<uint32_t>(value / 10);
+            remainder   = value % 10;
+            nonzero     |= limb != 0;
+        }
+        digits[count++] = static_cast<char>('0' + remainder);
+    }
+    std::string root = "2.25.";
+    root.append(std::make_reverse_iterator(digits + count), std::make_reverse_iterator(digits));
+    return root;
+}
+std::vector<std::string> serialize_dicom_instances (const SlideInfo& info, const std::string& uid_root)
+{
+    constexpr uint32_t TILE_PIXELS      = 256;
+    constexpr std::string_view VL_WSI   = "1.2.840.10008.5.1.4.1.1.77.1.6";
+    constexpr std::string_view JPEG     = "1.2.840.10008.1.2.4.50";
+    auto& layers        = info.extent.layers;
+    const bool jpeg     = info.encoding == IrisCodec::TILE_ENCODING_JPEG;
+    // Iris micrometers per pixel describe the highest resolution layer
+    const float top     = layers.size() ? layers.back().scale : 1.f;
+    const float mpp     = info.metadata.micronsPerPixel;
+    const auto study_uid    = uid_root + ".1";
+    const auto series_uid   = uid_root + ".2";
     
-    stream.seekp(-1,stream.cur) << "}";
-    return stream.str();
+    std::vector<std::string> instances;
+    instances.reserve(layers.size());
+    for (size_t index = 0; index < layers.size(); ++index) {
+        auto& layer     = layers[index];
+        const bool base = index + 1 == layers.size();
+        const uint32_t columns  = static_cast<uint32_t>(std::lround(info.extent.width  * layer.scale));
+        const uint32_t rows     = static_cast<uint32_t>(std::lround(info.extent.height * layer.scale));
+        // Pixel spacing of this layer in millimeters, if known
+        const double spacing    = mpp > 0.f ? mpp * (top / layer.scale) / 1000.0 : 0.0;
+        std::string out;
+        out.reserve(1024);
+        JSONWriter json (out);
+        json.begin_object();
+        DICOM_STRING (json, "00080008", "CS", {base ? "ORIGINAL" : "DERIVED", "PRIMARY", "VOLUME", "NONE"});
+        DICOM_STRING (json, "00080016", "UI", {VL_WSI});
+        DICOM_STRING (json, "00080018", "UI", {uid_root + ".3." + std::to_string(index + 1)});
+        DICOM_STRING (json, "00080060", "CS", {"SM"});
+        if (jpeg) DICOM_STRING (json, "00083002", "UI", {JPEG});
+        DICOM_STRING (json, "0020000D", "UI", {study_uid});
+        DICOM_STRING (json, "0020000E", "UI", {series_uid});
+        DICOM_NUMBER (json, "00200013", "IS", {static_cast<uint32_t>(index + 1)});
+        DICOM_STRING (json, "00209311", "CS", {"TILED_FULL"});
+        DICOM_NUMBER (json, "00280002", "US", {3u});
+        DICOM_STRING (json, "00280004", "CS", {jpeg ? "YBR_FULL_422" : "RGB"});
+        DICOM_NUMBER (json, "00280008", "IS", {layer.xTiles * layer.yTiles});
+        DICOM_NUMBER (json, "00280010", "US", {TILE_PIXELS});
+        DICOM_NUMBER (json, "00280011", "US", {TILE_PIXELS});
+        DICOM_NUMBER (json, "00280100", "US", {8u});
+        DICOM_NUMBER (json, "00280101", "US", {8u});
+        DICOM_NUMBER (json, "00280102", "US", {7u});
+        DICOM_NUMBER (json, "00280103", "US", {0u});
+        if (spacing > 0.0) {
+            DICOM_NUMBER (json, "00480001", "FL", {columns * spacing});
+            DICOM_NUMBER (json, "00480002", "FL", {rows * spacing});
+        }
+        DICOM_NUMBER (json, "00480006", "UL", {columns});
+        DICOM_NUMBER (json, "00480007", "UL", {rows});
+        if (spacing > 0.0) {
+            DICOM_ATTRIBUTE (json, "52009229", "SQ");   // Shared Functional Groups
+            json.begin_object();
+            DICOM_ATTRIBUTE (json, "00289110", "SQ");   // Pixel Measures
+            json.begin_object();
+            DICOM_NUMBER (json, "00280030", "DS", {spacing, spacing});
+            json.end_object();
+            json.end_array().end_object();
+            json.end_object();
+            json.end_array().end_object();
+        }
+        json.end_object();
+        instances.push_back(std::move(out));
+    }
+    return instances;
 }
-std::string serialize_get_response (const GetResponse& response)
+inline std::string SERIALIZE_SLIDE_LIST_JSON (const GetSlideListResponse& list)
 {
-    switch (response.type) {
-        case GetResponse::GET_RESPONSE_UNDEFINED:
-        case GetResponse::GET_RESPONSE_MALFORMED_REQ:
-        case GetResponse::GET_RESPONSE_FILE_NOT_FOUND:
-            return response.error_msg.size()?response.error_msg:
-            "Undefined GET request error. IrisRESTful server did elaborate on what happened.";
-        case GetResponse::GET_RESPONSE_METADATA:
-            return SERIALIZE_SLIDE_METADATA_JSON(response);
-        case GetResponse::GET_RESPONSE_FILE:
-        case GetResponse::GET_RESPONSE_TILE:
-            assert(false && "ERROR: cannot perform serialize_get_response on GET_RESPONSE_TILE response; this is a binary response");
-            throw std::runtime_error("ERROR: cannot serialize_get_response a GET_RESPONSE_TILE response; this is a binary response");
+    std::string out;
+    out.reserve(64 + list.slides.size() * 160);
+    JSONWriter json (out);
+    json.begin_object();
+    json.key("type").string("slide_list");
+    json.key("total").number(list.total);
+    json.key("offset").number(list.offset);
+    json.key("slides").begin_array();
+    for (auto&& slide : list.slides) {
+        json.begin_object();
+        json.key("id").string(slide.id);
+        json.key("bytes").number(slide.bytes);
+        json.key("extent");
+        SERALIZE_SLIDE_EXTENT(slide.extent, json);
+        json.end_object();
     }
-    throw std::runtime_error("ERROR: cannot serialize_get_response; undefined GetResponse type");
+    json.end_array();
+    json.end_object();
+    return out;
+}
+inline std::string SERIALIZE_WARM_STATUS_JSON (const WarmSlideResponse& warm)
+{
+    std::string out;
+    JSONWriter json (out);
+    json.begin_object();
+    json.key("type").string("slide_warm");
+    json.key("id").string(warm.id);
+    json.key("pinned").boolean(warm.pinned);
+    json.key("tiles").number(warm.tiles);
+    json.key("tiles_warmed").number(warm.tiles_warmed);
+    json.key("bytes").number(warm.bytes);
+    json.key("bytes_warmed").number(warm.bytes_warmed);
+    json.key("complete").boolean(!warm.warming && warm.tiles_warmed >= warm.tiles);
+    json.end_object();
+    return out;
+}
+std::string compress_gzip (const std::string_view& bytes)
+{
+    // gzip member (RFC 1952): fixed header, raw deflate data, CRC-32 and size
+    namespace zlib = boost::beast::zlib;
+    constexpr unsigned char GZIP_HEADER[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff};
+    zlib::deflate_stream stream;
+    stream.reset(6, 15, 8, zlib::Strategy::normal);
+
+    std::string out (reinterpret_cast<const char*>(GZIP_HEADER), sizeof(GZIP_HEADER));
+    out.resize(sizeof(GZIP_HEADER) + stream.upper_bound(bytes.size()));
+    zlib::z_params params;
+    params.next_in      = bytes.data();
+    params.avail_in     = bytes.size();
+    params.next_out     = out.data() + sizeof(GZIP_HEADER);
+    params.avail_out    = out.size() - sizeof(GZIP_HEADER);
+    boost::beast::error_code error;
+    stream.write(params, zlib::Flush::finish, error);
+    // Raw deflate streams report end_of_stream once finished
+    if (error && error != zlib::error::end_of_stream) return std::string();
+    out.resize(sizeof(GZIP_HEADER) + params.total_out);
+
+    boost::crc_32_type crc;
+    crc.process_bytes(bytes.data(), bytes.size());
+    const uint32_t trailer[2] = {crc.checksum(), static_cast<uint32_t>(bytes.size())};
+    for (uint32_t value : trailer)
+        for (int shift = 0; shift < 32; shift += 8)
+            out += static_cast<char>((value >> shift) & 0xFF);
+    return out;
+}
+std::string serialize_get_response (const GetResponse& response)
+{
+    if (auto error = std::get_if<GetErrorResponse>(&response))
+        return error->error_msg.size()?error->error_msg:
+        "Undefined GET request error. IrisRESTful server did elaborate on what happened.";
+    if (auto metadata = std::get_if<GetMetadataResponse>(&response))
+        return metadata->slide->get_metadata().json;
+    if (auto list = std::get_if<GetSlideListResponse>(&response))
+        return SERIALIZE_SLIDE_LIST_JSON(*list);
+    if (auto warm = std::get_if<WarmSlideResponse>(&response))
+        return SERIALIZE_WARM_STATUS_JSON(*warm);
+    assert(false && "ERROR: cannot perform serialize_get_response on a tile, tile batch, or file response; these are binary responses");
+    throw std::runtime_error("ERROR: cannot serialize_get_response a tile, tile batch, or file response; these are binary responses");
 }
 } // END RESTFUL
 } // END IRIS
@@ -0,0 +1,115 @@
+/**
+ * @file IrisRestfulGovernor.cpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ */
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include "IrisRestfulPriv.hpp"
+
+namespace Iris {
+namespace RESTful {
+constexpr auto COLD_AGE = Time::seconds(30);
+inline std::filesystem::path FIND_CGROUP ()
+{
+    // cgroup v2: /proc/self/cgroup holds a single "0::<path>" line
+    #if IRIS_GOVERNOR_SUPPORTED
+    std::ifstream file ("/proc/self/cgroup");
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.rfind("0::", 0) != 0) continue;
+        auto path = std::filesystem::path("/sys/fs/cgroup") / line.substr(3).erase(0, 1);
+        std::error_code error;
+        if (std::filesystem::exists(path / "memory.current", error)) return path;
+    }
+    std::cerr   << "[WARNING] The memory governor requires a cgroup v2 memory controller; "
+                << "cold slide pages will not be released under memory pressure\n";
+    #else
+    std::cerr   << "[WARNING] The memory governor is not supported on this platform\n";
+    #endif
+    return std::filesystem::path();
+}
+inline bool READ_PRESSURE (const std::filesystem::path& cgroup, float& avg10)
+{
+    // memory.pressure: "some avg10=1.23 avg60=0.50 avg300=0.10 total=12345"
+    std::ifstream file (cgroup / "memory.pressure");
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.rfind("some ", 0) != 0) continue;
+        auto field = line.find("avg10=");
+        if (field == std::string::npos) return false;
+        avg10 = std::strtof(line.c_str() + field + 6, nullptr);
+        return true;
+    }
+    return false;
+}
+inline bool READ_BYTES (const std::filesystem::path& file_path, uint64_t& bytes)
+{
+    // memory.current / memory.high / memory.max ("max" when unlimited)
+    std::ifstream file (file_path);
+    std::string value;
+    if (!(file >> value) || value == "max") return false;
+    bytes = std::strtoull(value.c_str(), nullptr, 10);
+    return true;
+}
+__INTERNAL__MemoryGovernor::__INTERNAL__MemoryGovernor(float pressure, const OpenSlides& open_slides) :
+_cgroup         (FIND_CGROUP()),
+_open_slides    (open_slides),
+_pressure       (pressure),
+_active         (!_cgroup.empty())
+{
+    if (_active) _thread = std::thread(&__INTERNAL__MemoryGovernor::govern, this);
+}
+__INTERNAL__MemoryGovernor::~__INTERNAL__MemoryGovernor()
+{
+    _active = false;
+    if (_thread.joinable()) _thread.join();
+}
+void __INTERNAL__MemoryGovernor::govern()
+{
+    while (_active) {
+        std::this_thread::sleep_for(Time::seconds(1));
+        if (!_active) return;
+
+        float avg10 = 0.f;
+        uint64_t current = 0, limit = 0;
+        const bool stalled  = READ_PRESSURE(_cgroup, avg10) && avg10 >= _pressure;
+        const bool high     = READ_BYTES(_cgroup / "memory.current", current) &&
+                              (READ_BYTES(_cgroup / "memory.high", limit) ||
+                               READ_BYTES(_cgroup / "memory.max", limit)) &&
+                              current >= limit * HIGH_WATER;
+        if (!stalled && !high) continue;
+
+        std::stringstream reason;
+        reason  << "memory pressure " << avg10 << "%, "
+                << (current >> 20) << " MB in use";
+        if (limit) reason << " of " << (limit >> 20) << " MB";
+        release_cold_slides(reason.str());
+    }
+}
+void __INTERNAL__MemoryGovernor::release_cold_slides(const std::string& reason)
+{
+    // Least recently used first among the slides idle for at least COLD_AGE
+    const auto now  = Time::steady_clock::now();
+    auto slides     = _open_slides();
+    std::erase_if(slides, [&now](const Slide& slide) { return now - slide->last_used() < COLD_AGE; });
+    if (slides.empty()) return;
+    std::sort(slides.begin(), slides.end(), [](const Slide& a, const Slide& b) {
+        return a->last_used() < b->last_used();
+    });
+    slides.resize((slides.size() + 3) / 4);
+
+    uint64_t released = 0;
+    for (auto&& slide : slides) released += slide->release_pages();
+    std::cout   << "[NOTE] Memory governor (" << reason << "): released "
+                << (released >> 20) << " MB of resident pages from "
+                << slides.size() << " cold slide" << (slides.size() == 1 ? "" : "s") << "\n";
+}
+} // END RESTFUL
+} // END IRIS
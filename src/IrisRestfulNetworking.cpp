@@ -21,6 +21,24 @@
 #pragma clang diagnostic pop
 #endif // __clang__
 
+#include <array>
+#include <span>
+#include <ctime>
+#include <charconv>
+#if defined(__linux__)
+#include <sys/sendfile.h>           // Kernel file-to-socket transfer
+#define IRIS_SENDFILE_SUPPORTED 1
+#else
+#define IRIS_SENDFILE_SUPPORTED 0
+#endif
+#if defined(__linux__) && defined(SO_REUSEPORT)
+#include <sched.h>                  // Reactor thread core affinity
+#include <pthread.h>
+#define IRIS_PER_CORE_REACTORS_SUPPORTED 1
+#else
+#define IRIS_PER_CORE_REACTORS_SUPPORTED 0
+#endif
+
 #define BOOST_IMPLEMENT // Allow for class definitions
 namespace   net       = boost::asio;
 namespace   beast     = boost::beast;
@@ -29,6 +47,7 @@ namespace   ip        = net::ip;
 using       tcp       = ip::tcp;
 namespace   http      = beast::http;
 #include "IrisRestfulPriv.hpp"
+#include "IrisRestfulKTLS.hpp"
 
 namespace Iris {
 namespace RESTful {
@@ -36,8 +55,218 @@ namespace RESTful {
 // Forward declare SSL context creation. See IrisRestfulSSL.cpp
 using fs_path = std::filesystem::path;
 std::shared_ptr<boost::asio::ssl::context> CREATE_SSL_CONTEXT
- (const fs_path& cert_path, const fs_path& key_path);
+ (const fs_path& cert_path, const fs_path& key_path, bool ktls);
 
+// Define the per-session slide cache
+Slide SessionSlides::find(SlideHandle handle)
+{
+    if (handle == NULL_SLIDE_HANDLE) return nullptr;
+    for (auto& entry : entries) {
+        if (entry.handle != handle || !entry.slide) continue;
+        // Drop slides whose files were replaced or removed
+        if (entry.slide->is_stale()) { entry = Entry(); return nullptr; }
+        entry.used = ++clock;
+        return entry.slide;
+    }
+    return nullptr;
+}
+void SessionSlides::insert(SlideHandle handle, const Slide& slide)
+{
+    Entry* target = &entries[0];
+    for (auto& entry : entries) {
+        if (entry.handle == handle) { target = &entry; break; }
+        if (entry.used < target->used) target = &entry;
+    }
+    *target = Entry {
+        .handle = handle,
+        .slide  = slide,
+        .used   = ++clock,
+    };
+}
+// Define the per-session memory. A connection has a single request in flight
+// and only a few operations outstanding for it (its read or its write, and the
+// dispatch of their completion through the session strand), so their handlers
+// and the header fields of the request being read fit within the session:
+// keep-alive requests do not touch the heap. Larger or surplus allocations
+// fall back to it. Handlers may outlive the session (an io_context destroyed
+// with operations pending), so the memory is freed by the last of the session
+// and its outstanding handler blocks.
+struct SessionMemory {
+    static constexpr size_t             HANDLER_BLOCKS  = 4;
+    static constexpr size_t             HANDLER_SIZE    = 512;
+    static constexpr size_t             FIELDS_SIZE     = 2048;     // The header limit is 1024 bytes
+    struct alignas(std::max_align_t) Block {
+        char                            bytes[HANDLER_SIZE];
+    };
+    Block                               handlers[HANDLER_BLOCKS];
+    std::atomic_flag                    handler_used[HANDLER_BLOCKS];
+    std::atomic<uint32_t>               references  {1};
+    alignas(std::max_align_t) char      fields[FIELDS_SIZE];
+    size_t                              fields_used = 0;
+};
+inline bool WITHIN (const void* pointer, const void* begin, size_t size)
+{
+    auto address = reinterpret_cast<uintptr_t>(pointer);
+    auto start   = reinterpret_cast<uintptr_t>(begin);
+    return address >= start && address < start + size;
+}
+inline void RELEASE_SESSION_MEMORY (SessionMemory* memory)
+{
+    if (memory->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete memory;
+}
+inline void* ALLOCATE_HANDLER (SessionMemory* memory, size_t size)
+{
+    if (size <= SessionMemory::HANDLER_SIZE)
+        for (size_t block = 0; block < SessionMemory::HANDLER_BLOCKS; ++block)
+            if (!memory->handler_used[block].test_and_set(std::memory_order_acquire)) {
+                memory->references.fetch_add(1, std::memory_order_relaxed);
+                return memory->handlers[block].bytes;
+            }
+    return ::operator new(size);
+}
+inline void DEALLOCATE_HANDLER (SessionMemory* memory, void* pointer)
+{
+    if (!WITHIN(pointer, memory->handlers, sizeof(memory->handlers)))
+        return ::operator delete(pointer);
+    auto block = (reinterpret_cast<uintptr_t>(pointer) -
+                  reinterpret_cast<uintptr_t>(memory->handlers)) / sizeof(SessionMemory::Block);
+    memory->handler_used[block].clear(std::memory_order_release);
+    RELEASE_SESSION_MEMORY(memory);
+}
+inline void* ALLOCATE_FIELDS (SessionMemory* memory, size_t size)
+{
+    constexpr size_t ALIGN = alignof(std::max_align_t);
+    const size_t offset = (memory->fields_used + ALIGN - 1) / ALIGN * ALIGN;
+    if (offset + size > SessionMemory::FIELDS_SIZE) return ::operator new(size);
+    memory->fields_used = offset + size;
+    return memory->fields + offset;
+}
+inline void DEALLOCATE_FIELDS (SessionMemory* memory, void* pointer)
+{
+    // Arena bytes are reclaimed all at once, before the next request is read
+    if (!WITHIN(pointer, memory->fields, SessionMemory::FIELDS_SIZE))
+        ::operator delete(pointer);
+}
+/**
+ * @brief Allocates completion handlers of a session's operations from its memory
+ *
+ * Associated with a handler by SESSION_HANDLER; ASIO and Beast allocate the
+ * operation (and the strand dispatch) holding the handler with it.
+ */
+template <class T>
+class HandlerAllocator {
+    template <class> friend class HandlerAllocator;
+    SessionMemory*                      _memory;
+public:
+    using value_type                    = T;
+    explicit HandlerAllocator           (SessionMemory* memory) noexcept : _memory(memory) {}
+    template <class U>
+    HandlerAllocator                    (const HandlerAllocator<U>& other) noexcept : _memory(other._memory) {}
+    T*   allocate                       (size_t count)
+    {
+        return static_cast<T*>(ALLOCATE_HANDLER(_memory, sizeof(T) * count));
+    }
+    void deallocate                     (T* pointer, size_t) noexcept
+    {
+        DEALLOCATE_HANDLER(_memory, pointer);
+    }
+    template <class U>
+    bool operator==                     (const HandlerAllocator<U>& other) const noexcept
+    {
+        return _memory == other._memory;
+    }
+    template <class U>
+    bool operator!=                     (const HandlerAllocator<U>& other) const noexcept
+    {
+        return _memory != other._memory;
+    }
+};
+/**
+ * @brief Allocates the header fields of a session's request from its arena
+ *
+ * A default constructed allocator (no session) allocates from the heap.
+ */
+template <class T>
+class RequestAllocator {
+    template <class> friend class RequestAllocator;
+    SessionMemory*                      _memory     = nullptr;
+public:
+    using value_type                    = T;
+    RequestAllocator                    () noexcept = default;
+    explicit RequestAllocator           (SessionMemory* memory) noexcept : _memory(memory) {}
+    template <class U>
+    RequestAllocator                    (const RequestAllocator<U>& other) noexcept : _memory(other._memory) {}
+    T*   allocate                       (size_t count)
+    {
+        if (!_memory) return static_cast<T*>(::operator new(sizeof(T) * count));
+        return static_cast<T*>(ALLOCATE_FIELDS(_memory, sizeof(T) * count));
+    }
+    void deallocate                     (T* pointer, size_t) noexcept
+    {
+        if (!_memory) return ::operator delete(pointer);
+        DEALLOCATE_FIELDS(_memory, pointer);
+    }
+    template <class U>
+    bool operator==                     (const RequestAllocator<U>& other) const noexcept
+    {
+        return _memory == other._memory;
+    }
+    template <class U>
+    bool operator!=                     (const RequestAllocator<U>& other) const noexcept
+    {
+        return _memory != other._memory;
+    }
+};
+// Define the per-session request reader
+struct SessionReader {
+    using Deadline                      = std::atomic<Time::steady_clock::time_point>;
+    SessionMemory* const                memory;     // Handler blocks and request fields
+    ASIOBuffer_t                        buffer;     // Persists across reads (pipelined bytes)
+    std::optional<HTTPRequestParser_t>  parser;     // Constructed in place for each request
+    ASIOTimer_t                         timer;      // Waits for the deadline. See WATCH_DEADLINE
+    Deadline                            deadline;   // Extended by each request read
+    explicit SessionReader              (const ASIOExecutor_t& executor) :
+    memory                              (new SessionMemory),
+    timer                               (executor) {}
+    SessionReader                       (const SessionReader&) = delete;
+    SessionReader& operator =           (const SessionReader&) = delete;
+   ~SessionReader                       ()
+    {
+        parser.reset();
+        RELEASE_SESSION_MEMORY(memory);
+    }
+};
+/**
+ * @brief Associates a completion handler with its session's handler memory
+ *
+ * The equivalent of net::bind_allocator, which Boost versions before 1.79 lack.
+ */
+template <class Handler>
+struct SessionHandler {
+    using allocator_type                = HandlerAllocator<void>;
+    Handler                             handler;
+    allocator_type                      allocator;
+    allocator_type get_allocator        () const noexcept { return allocator; }
+    template <class... Args>
+    void operator()                     (Args&&... args) { handler(std::forward<Args>(args)...); }
+    template <class... Args>
+    void operator()                     (Args&&... args) const { handler(std::forward<Args>(args)...); }
+};
+template <class Handler>
+inline SessionHandler<std::decay_t<Handler>> SESSION_HANDLER (const HandlerAllocator<void>& allocator, Handler&& handler)
+{
+    return SessionHandler<std::decay_t<Handler>> {
+        .handler    = std::forward<Handler>(handler),
+        .allocator  = allocator,
+    };
+}
+template <class Session_, class Handler>
+inline SessionHandler<std::decay_t<Handler>> SESSION_HANDLER (const Session_& session, Handler&& handler)
+{
+    return SESSION_HANDLER(HandlerAllocator<void>(session->request.reader->memory),
+                           std::forward<Handler>(handler));
+}
 // Define Session
 inline std::string ADDRESS_TO_STRING (const tcp::endpoint& endpoint) {
     return endpoint.address().to_string()+":"+std::to_string(endpoint.port());
@@ -46,7 +275,7 @@ __INTERNAL__Session::__INTERNAL__Session(ASIOSocket_t&& socket) :
 stream(std::make_unique<ASIOStream_t>(std::move(socket))),
 remote(ADDRESS_TO_STRING(stream->socket().remote_endpoint()))
 {
-    
+    request.reader = std::make_unique<SessionReader>(stream->get_executor());
 }
 __INTERNAL__Session::~__INTERNAL__Session()
 {
@@ -56,37 +285,115 @@ __INTERNAL__SslSession::__INTERNAL__SslSession(ASIOSocket_t&& socket, SSLContext
 stream(std::make_unique<ASIOSslStream_t>(std::move(socket), ctx)),
 remote(ADDRESS_TO_STRING(stream->lowest_layer().remote_endpoint()))
 {
-    
+    request.reader = std::make_unique<SessionReader>(stream->get_executor());
 }
 __INTERNAL__SslSession::~__INTERNAL__SslSession()
 {
     
+}
+__INTERNAL__KtlsSession::__INTERNAL__KtlsSession(ASIOSocket_t&& socket, SSLContext_t& ctx,
+                                                 Async::ShardedCounter& copied) :
+stream(std::make_unique<ASIOKtlsStream_t>(std::move(socket), ctx, copied)),
+remote(ADDRESS_TO_STRING(stream->socket().remote_endpoint()))
+{
+    request.reader = std::make_unique<SessionReader>(stream->get_executor());
+}
+__INTERNAL__KtlsSession::~__INTERNAL__KtlsSession()
+{
+    
 }
 
+// Cache-Control of tile and metadata responses. Without a max-age clients
+// store responses but revalidate them (answered with 304 Not Modified).
+inline std::string FORMAT_CACHE_CONTROL (uint32_t max_age, bool immutable)
+{
+    constexpr uint32_t ONE_YEAR = 31536000;
+    if (!max_age && !immutable) return "no-cache";
+    std::string value = "max-age=" + std::to_string(max_age ? max_age : ONE_YEAR);
+    if (immutable) value += ", immutable";
+    return value;
+}
+// The cores this process may run on, one per-core reactor each. Empty when
+// per-core reactors are not supported (the shared reactors are used instead).
+inline std::vector<int> REACTOR_CORES (NetworkReactors mode)
+{
+    std::vector<int> cores;
+    if (mode != NETWORK_REACTORS_PER_CORE) return cores;
+    #if IRIS_PER_CORE_REACTORS_SUPPORTED
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (int core = 0; core < CPU_SETSIZE; ++core)
+            if (CPU_ISSET(core, &allowed)) cores.push_back(core);
+    } else for (int core = 0; core < static_cast<int>(IRIS_CONCURRENCY); ++core)
+        cores.push_back(core);
+    #else
+    std::cout   << "[WARNING] Per-core network reactors require Linux (SO_REUSEPORT); "
+                << "using the shared network reactors instead.\n";
+    #endif
+    return cores;
+}
+inline void PIN_TO_CORE (std::thread& thread, int core)
+{
+    #if IRIS_PER_CORE_REACTORS_SUPPORTED
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    if (pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set))
+        std::cout   << "[WARNING] Failed to pin a network reactor to core "
+                    << core << "; it may migrate between cores.\n";
+    #endif
+}
 // Define Networking hub
 __INTERNAL__Networking::__INTERNAL__Networking (__INTERNAL__Server* const & server,
                                                 bool https,
                                                 const fs_path& cert,
                                                 const fs_path& key,
-                                                const Address& CORS) :
+                                                const Address& CORS,
+                                                TileDelivery delivery,
+                                                bool ktls,
+                                                uint32_t cache_max_age,
+                                                bool cache_immutable,
+                                                NetworkReactors reactors) :
 _server     (server),
-_reactors   (IRIS_CONCURRENCY * 3),
-_context    (std::make_shared<ASIOContext_t>(_reactors.size())),
-_guard      (std::make_shared<ASIOGuard_t>(_context->get_executor())),
-_ssl        (https?CREATE_SSL_CONTEXT(cert, key):nullptr),
+_cores      (REACTOR_CORES(reactors)),
+_mode       (_cores.size()?NETWORK_REACTORS_PER_CORE:NETWORK_REACTORS_SHARED),
+_reactors   (_cores.size()?_cores.size():IRIS_CONCURRENCY * 3),
+_contexts   (_cores.size()?_cores.size():1),
+_ssl        (https?CREATE_SSL_CONTEXT(cert, key, ktls):nullptr),
 _CORS       (CORS),
-_acceptor   (nullptr),
+_delivery   (delivery),
+_ktls       (https && ktls && IRIS_KTLS_SUPPORTED),
+_cache_control (FORMAT_CACHE_CONTROL(cache_max_age, cache_immutable)),
 ACTIVE      (true)
 {
 //    if (!_ssl) throw std::runtime_error ("Failed to create SSL context");
     
-    for (auto&& thread : const_cast<Threads&>(_reactors))
-        thread = std::thread {[this](){
+    if (_delivery == TILE_DELIVERY_SENDFILE && !IRIS_SENDFILE_SUPPORTED)
+        std::cout   << "[WARNING] Sendfile tile delivery is not supported on this platform. "
+                    << "Tiles will be written from the slide mapping instead.\n";
+    else if (_delivery == TILE_DELIVERY_SENDFILE && _ssl && !_ktls)
+        std::cout   << "[WARNING] Sendfile tile delivery requires plain HTTP (--no-https) or kernel TLS. "
+                    << "TLS streams will write tiles from the slide mapping instead.\n";
+    if (ktls && !https)
+        std::cout   << "[WARNING] Kernel TLS was requested with TLS disabled; ignoring.\n";
+    
+    // A shared context is run by all of the reactor threads; a per-core
+    // context by its thread alone (which lets ASIO skip scheduler contention).
+    const int concurrency = static_cast<int>(_reactors.size() / _contexts.size());
+    for (auto&& reactor : _contexts) {
+        reactor.context = std::make_shared<ASIOContext_t>(concurrency);
+        reactor.guard   = std::make_shared<ASIOGuard_t>(reactor.context->get_executor());
+    }
+    for (size_t index = 0; index < _reactors.size(); ++index) {
+        auto& thread    = const_cast<Threads&>(_reactors)[index];
+        auto  context   = _contexts[index % _contexts.size()].context;
+        thread = std::thread {[this, context](){
             // Run the context run loop within
             // a controlled try catch enviornment
             // for runtime exception recovery
             while (ACTIVE) try {
-                _context->run();
+                context->run();
             } catch (std::runtime_error& error) {
                 std::string msg = error.what() ? error.what() :
                 std::string("[undefined error in file") + __FILE__ + "]";
@@ -99,20 +406,24 @@ ACTIVE      (true)
                 std::cout   << "[ERROR] Undefined network error thrown\n";
             }
         }};
+        if (_mode == NETWORK_REACTORS_PER_CORE) PIN_TO_CORE(thread, _cores[index]);
+    }
 }
 __INTERNAL__Networking::~__INTERNAL__Networking ()
 {
     // Inactivate the context loops
     ACTIVE = false;
     
-    // Interrupt the oustanding acceptor call
-    _acceptor->cancel();
-    
-    // remove the execution guard
-    const_cast<ASIOGuard&>(_guard) = nullptr;
-    
-    // Pump the event loop to unblock the reactor threads
-    _context->poll();
+    for (auto&& reactor : _contexts) {
+        // Interrupt the oustanding acceptor call
+        if (reactor.acceptor) reactor.acceptor->cancel();
+        
+        // remove the execution guard
+        reactor.guard = nullptr;
+        
+        // Pump the event loop to unblock the reactor threads
+        reactor.context->poll();
+    }
     
     // And wait for all reactor threads to exit.
     for (auto&& thread : const_cast<Threads&>(_reactors)) {
@@ -121,53 +432,134 @@ __INTERNAL__Networking::~__INTERNAL__Networking ()
     }
 }
 void __INTERNAL__Networking::listen(uint16_t port){
-    if (_acceptor && _acceptor->is_open()) throw std::runtime_error
-        ("networking acceptor already active");
+    for (auto&& reactor : _contexts)
+        if (reactor.acceptor && reactor.acceptor->is_open()) throw std::runtime_error
+            ("networking acceptor already active");
     
     beast::error_code error;
     // NOTE: If set to IPv6, IPv4 connections will fire 2 acceptions (once for downgraded protocol)
     tcp::endpoint endpoint = tcp::endpoint(ip::tcp::v4(), port);
     
-    // Create a new acceptor and give it a separate strand. It will pass the strand to the new socket.
-    _acceptor = std::make_shared<ASIOAcceptor_t>(net::make_strand(_context->get_executor()));
-    if (!_acceptor) throw std::runtime_error
-        ("failed to create acceptor");
-   
-    // Open the acceptor
-    _acceptor->open(endpoint.protocol(), error);
-    if (error) throw std::runtime_error
-        ("Failed to open acceptor: " + error.message() +
-          "[FILE " + __FILE__ + "; LINE " + std::to_string(__LINE__) + "]");
+    for (auto&& reactor : _contexts) {
+        // Create a new acceptor. Shared reactors give it a separate strand;
+        // it will pass the strand to the new socket. A per-core reactor has
+        // a single thread and needs no strand.
+        auto& _acceptor = reactor.acceptor;
+        if (_mode == NETWORK_REACTORS_PER_CORE)
+            _acceptor = std::make_shared<ASIOAcceptor_t>(reactor.context->get_executor());
+        else _acceptor = std::make_shared<ASIOAcceptor_t>(net::make_strand(reactor.context->get_executor()));
+        if (!_acceptor) throw std::runtime_error
+            ("failed to create acceptor");
+       
+        // Open the acceptor
+        _acceptor->open(endpoint.protocol(), error);
+        if (error) throw std::runtime_error
+            ("Failed to open acceptor: " + error.message() +
+              "[FILE " + __FILE__ + "; LINE " + std::to_string(__LINE__) + "]");
 
-    // Allow socket to be bound to a used address (maybe don't need to)
-    _acceptor->set_option(net::socket_base::reuse_address(true), error);
-    if (error) throw std::runtime_error
-        ("Failed to set acceptor to reuse address option: " + error.message());
+        // Allow socket to be bound to a used address (maybe don't need to)
+        _acceptor->set_option(net::socket_base::reuse_address(true), error);
+        if (error) throw std::runtime_error
+            ("Failed to set acceptor to reuse address option: " + error.message());
+        
+        #if IRIS_PER_CORE_REACTORS_SUPPORTED
+        // Per-core acceptors share the port; the kernel balances connections across them
+        if (_mode == NETWORK_REACTORS_PER_CORE) {
+            using reuse_port = net::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+            _acceptor->set_option(reuse_port(true), error);
+            if (error) throw std::runtime_error
+                ("Failed to set acceptor to reuse port option: " + error.message());
+        }
+        #endif
 
-    // Bind to the server address
-    _acceptor->bind(endpoint, error);
-    if (error) throw std::runtime_error
-        ("Failed to bind endpoint to acceptor: " + error.message() +
-         "[FILE " + __FILE__ + "; LINE " + std::to_string(__LINE__) + "]");
+        // Bind to the server address
+        _acceptor->bind(endpoint, error);
+        if (error) throw std::runtime_error
+            ("Failed to bind endpoint to acceptor: " + error.message() +
+             "[FILE " + __FILE__ + "; LINE " + std::to_string(__LINE__) + "]");
 
-    // Start listening for connections
-    _acceptor->listen(net::socket_base::max_listen_connections, error);
-    if (error) throw std::runtime_error
-        ("Failed to listen with acceptor: " + error.message() +
-         "[FILE " + __FILE__ + "; LINE " + std::to_string(__LINE__) + "]");
+        // Start listening for connections
+        _acceptor->listen(net::socket_base::max_listen_connections, error);
+        if (error) throw std::runtime_error
+            ("Failed to listen with acceptor: " + error.message() +
+             "[FILE " + __FILE__ + "; LINE " + std::to_string(__LINE__) + "]");
+        
+        // Resolve an ephemeral port once, so all per-core acceptors share it
+        endpoint = _acceptor->local_endpoint();
+    }
     
     // Report out to the console the local endpoint
-    std::cout   << "[NOTE] Iris RESTful server is now listening at "
-                << _acceptor->local_endpoint() << "\n";
+    std::cout   << "[NOTE] Iris RESTful server is now listening at " << endpoint;
+    if (_mode == NETWORK_REACTORS_PER_CORE)
+        std::cout << " (" << _contexts.size() << " per-core reactors)";
+    std::cout   << "\n";
 
-    accept_connection(_acceptor);
+    for (auto&& reactor : _contexts)
+        accept_connection(reactor.acceptor);
+}
+inline void REPORT_KTLS_OFFLOAD (__INTERNAL__KtlsStream& stream)
+{
+    // Report the first connection on which the kernel accepts or declines
+    // the offload. Declined connections remain encrypted by OpenSSL.
+    static std::atomic_flag reported_accepted, reported_declined;
+    if (stream.ktls_send()) {
+        if (!reported_accepted.test_and_set())
+            std::cout   << "[NOTE] Kernel accepted TLS offload (transmit"
+                        << (stream.ktls_recv()?" and receive":" only")
+                        << "); tile ranges will be sent with SSL_sendfile.\n";
+    } else if (!reported_declined.test_and_set())
+        std::cout   << "[WARNING] Kernel declined TLS offload for a connection; "
+                    << "it will be encrypted by OpenSSL in user space.\n";
+}
+template<class Session_> bool IS_STREAM_OPEN (const Session_& session)
+{
+    return beast::get_lowest_layer(*session->stream).socket().is_open();
+}
+// Connections idle (or stalled mid-response) for this long are closed
+constexpr auto SESSION_TIMEOUT = Time::seconds(30);
+template<class Session_> void EXTEND_DEADLINE (const Session_& session)
+{
+    session->request.reader->deadline.store(Time::steady_clock::now() + SESSION_TIMEOUT,
+                                            std::memory_order_relaxed);
+}
+template<class Session_> void WATCH_DEADLINE (const Session_& session)
+{
+    // A single wait per session, renewed to the extended deadline when it
+    // fires. Extending the deadline per request is a store; re-arming the
+    // stream's own timeout for every read and write would allocate.
+    // Once expired, cancel the outstanding read, write, or sendfile wait;
+    // its handler closes the stream.
+    auto& reader = *session->request.reader;
+    reader.timer.expires_at(reader.deadline.load(std::memory_order_relaxed));
+    reader.timer.async_wait([weak = std::weak_ptr(session)](beast::error_code error) {
+        auto session = weak.lock();
+        if (error || !session || !IS_STREAM_OPEN(session)) return;
+        auto& reader = *session->request.reader;
+        if (Time::steady_clock::now() >= reader.deadline.load(std::memory_order_relaxed)) {
+            beast::get_lowest_layer(*session->stream).socket().cancel(error);
+            EXTEND_DEADLINE(session);
+        }
+        WATCH_DEADLINE(session);
+    });
+}
+template<class Session_> void START_DEADLINE (const Session_& session)
+{
+    // Handshakes run under the stream's own timeout; requests under the session's
+    beast::get_lowest_layer(*session->stream).expires_never();
+    EXTEND_DEADLINE(session);
+    WATCH_DEADLINE(session);
 }
 void __INTERNAL__Networking::accept_connection(const ASIOAcceptor &acceptor)
 {
     // Accept incoming connections
     // Note: If the sever is set to IPv6, this will fire twice upon a IPv4 request
-    // Create a new strand; each acceptance carries the strand with the generated socket
-    acceptor->async_accept(net::make_strand(acceptor->get_executor()),[this, acceptor]
+    // Create a new strand; each acceptance carries the strand with the generated socket.
+    // A per-core reactor is single threaded and never contends for it, but
+    // sessions share one concrete executor type (see ASIOExecutor_t).
+    auto& context = static_cast<net::io_context&>
+                    (net::query(acceptor->get_executor(), net::execution::context));
+    auto executor = net::make_strand(context.get_executor());
+    acceptor->async_accept(executor,[this, acceptor]
                            (beast::error_code error, ASIOSocket_t socket){
         
         // Do not log an aborted operation; it means we are shutting the server down.
@@ -179,7 +571,25 @@ void __INTERNAL__Networking::accept_connection(const ASIOAcceptor &acceptor)
         // If we have closed the acceptor, then gracefully exit and destroy acceptor
         if (acceptor->is_open()) accept_connection (acceptor);
     
-        if (_ssl) {
+        if (_ktls) {
+            // Handshake in OpenSSL on the socket itself so that the kernel
+            // can take over record encryption once it completes.
+            auto session = std::make_shared<__INTERNAL__KtlsSession>
+                           (std::move(socket), *_ssl, _server->_counters.bytes_copied);
+            beast::get_lowest_layer(*session->stream).expires_after(Time::seconds(30));
+            session->stream->async_handshake([this,session]
+                                             (beast::error_code error){
+                if (error) {
+                    std::cerr   << "["<<session->remote<<"]"
+                                << "Error in performing SSL handshake: "
+                                << error.message() << "\n";
+                    return;
+                }
+                REPORT_KTLS_OFFLOAD (*session->stream);
+                START_DEADLINE (session);
+                read_request (session);
+            });
+        } else if (_ssl) {
             // Create a stream and begin reading messages
             auto session = std::make_shared<__INTERNAL__SslSession>(std::move(socket), *_ssl);
             beast::get_lowest_layer(*session->stream).expires_after(Time::seconds(30));
@@ -189,46 +599,57 @@ void __INTERNAL__Networking::accept_connection(const ASIOAcceptor &acceptor)
                     std::cerr   << "["<<session->remote<<"]"
                                 << "Error in performing SSL handshake: "
                                 << error.message() << "\n";
-                } else read_request (session);
-         });
+                    return;
+                }
+                START_DEADLINE (session);
+                read_request (session);
+            });
         } else {
             // Create a stream and begin reading messages
             auto session = std::make_shared<__INTERNAL__Session>(std::move(socket));
-            beast::get_lowest_layer(*session->stream).expires_after(Time::seconds(30));
+            START_DEADLINE (session);
             read_request (session);
         }
     });
 }
-template<class Session_> bool IS_STREAM_OPEN (const Session_& session)
-{
-    return beast::get_lowest_layer(*session->stream).socket().is_open();
-}
 template<class Session_>
 void __INTERNAL__Networking::read_request(const Session_ &session)
 {
     // Extend the expiration time
     // This is ABSOLUTELY VITAL. Failure to do this will signficantly affect performance
-    beast::get_lowest_layer(*session->stream).expires_after(Time::seconds(30));
+    EXTEND_DEADLINE (session);
     
-    auto buffer  = std::make_shared<ASIOBuffer_t>();
-    auto parser  = std::make_shared<http::request_parser<http::string_body>>();
+    // A parser only reads a single message; construct a new one in place
+    // within the session. The session's read buffer persists across reads
+    // so that any bytes of a following (pipelined) request are kept.
+    // The previous request is gone; its header fields' arena is reused.
+    auto& reader = *session->request.reader;
+    reader.parser.reset();
+    reader.memory->fields_used = 0;
+    auto& parser = reader.parser.emplace(std::piecewise_construct, std::make_tuple(),
+                                         std::make_tuple(RequestAllocator<char>(reader.memory)));
     // This is a light-weight server; we don't expect big requests
-    parser->header_limit(1024);
-    parser->body_limit(2048);
+    parser.header_limit(1024);
+    parser.body_limit(2048);
     
-    http::async_read(*session->stream, *buffer, *parser,
-                     [this, session, buffer, parser]
+    http::async_read(*session->stream, reader.buffer, parser,
+                     SESSION_HANDLER(session, [this, session]
                      (beast::error_code error, size_t bytes_transferred) {
+        auto& reader = *session->request.reader;
+        auto& parser = *reader.parser;
         if (error) {
+            // Closed by the client, or cancelled by the session deadline
             if(error == http::error::end_of_stream ||
-               error == beast::error::timeout)
+               error == beast::error::timeout ||
+               error == net::error::operation_aborted)
                 return close_stream (session);
             
             const auto response = std::make_shared<HTTPResponse_t>();
             response->version(11);
             response->set(http::field::content_type, "text/plain");
-            response->keep_alive(parser->is_header_done()?parser->keep_alive():false);
+            response->keep_alive(parser.is_header_done()?parser.keep_alive():false);
             response->set(http::field::server, "IrisRESTful");
+            reader.buffer.clear();
             if (error == http::error::header_limit) {
                 // PROTECTION FROM DOS ATTACKS
                 response->result(http::status::request_header_fields_too_large);
@@ -247,38 +668,29 @@ void __INTERNAL__Networking::read_request(const Session_ &session)
         }
         
         // Begin interpreting the request
-        interpret_request(session, HTTPRequest_t(parser->release()));
-    });
+        interpret_request(session, parser.release());
+    }));
 }
 inline HTTPResponse GENERATE_STRING_GET_RESPONSE (const GetResponse &response) {
     HTTPResponse msg = std::make_shared<HTTPResponse_t>();
-    switch (response.type) {
-        case GetResponse::GET_RESPONSE_UNDEFINED:
-        case GetResponse::GET_RESPONSE_MALFORMED_REQ:
-            msg->result(http::status::bad_request);
-            msg->set(http::field::content_type, "application/text");
-            break;
-        case GetResponse::GET_RESPONSE_FILE_NOT_FOUND:
-            msg->result(http::status::not_found);
-            msg->set(http::field::content_type, "application/text");
-            break;
-        case GetResponse::GET_RESPONSE_METADATA:
-            msg->result(http::status::ok);
-            msg->set(http::field::content_type, "application/json");
-            break;
-        case GetResponse::GET_RESPONSE_FILE:
-        case GetResponse::GET_RESPONSE_TILE:
-            goto MALFORMATTED_RESPONSE;
+    if (auto error = std::get_if<GetErrorResponse>(&response)) {
+        switch (error->type) {
+            case GetErrorResponse::GET_RESPONSE_MALFORMED_REQ:
+                msg->result(http::status::bad_request); break;
+            case GetErrorResponse::GET_RESPONSE_FILE_NOT_FOUND:
+                msg->result(http::status::not_found); break;
+            case GetErrorResponse::GET_RESPONSE_METHOD_NOT_ALLOWED:
+                msg->result(http::status::method_not_allowed);
+                msg->set(http::field::allow, "GET, HEAD"); break;
+        }
+        msg->set(http::field::content_type, "application/text");
+    } else {
+        msg->result(http::status::ok);
+        msg->set(http::field::content_type, "application/json");
     }
+    // Throws for binary (tile / file) responses. See serialize_get_response
     msg->body() = serialize_get_response(response);
     return msg;
-    
-    MALFORMATTED_RESPONSE:
-    std::stringstream error;
-    error   << "[ERROR] Cannot generate http::string_body for non-string response."
-            <<" Set a breakpoint in " << __FILE__ << " line no " << __LINE__ << "to debug.";
-    assert (false && error.str().c_str());
-    throw std::runtime_error(error.str());
 }
 inline HTTPResponseFile GENERATE_FILE_RESPONSE (const GetFileResponse& file_response)
 {
@@ -296,27 +708,204 @@ inline HTTPResponseFile GENERATE_FILE_RESPONSE (const GetFileResponse& file_resp
     }
     return msg;
 }
-inline HTTPResponseBuffer GENERATE_TILE_RESPONSE (const GetTileResponse &tile_response)
+// Only unencrypted streams and kernel TLS streams may have their bodies written by the kernel.
+template <class Session_> constexpr bool SENDFILE_STREAM = false;
+template <> constexpr bool SENDFILE_STREAM<Session> = IRIS_SENDFILE_SUPPORTED;
+template <> constexpr bool SENDFILE_STREAM<KtlsSession> = IRIS_KTLS_SUPPORTED;
+inline bool SENDFILE_ACTIVE (const Session&, TileDelivery delivery)
 {
-    HTTPResponseBuffer msg  = std::make_shared<HTTPResponseBuffer_t>();
-    msg->result(http::status::ok);
-    msg->set(http::field::content_type, "image/jpeg");
-    msg->body().data        = tile_response.pixelData->data();
-    msg->body().size        = tile_response.pixelData->size();
-    msg->body().more        = false;
-    return msg;
+    return delivery == TILE_DELIVERY_SENDFILE;
+}
+inline bool SENDFILE_ACTIVE (const KtlsSession& session, TileDelivery)
+{
+    // Only if the kernel accepted the transmit offload for this connection
+    return session->stream->ktls_send();
+}
+// The parts of a request that its response depends upon. Copied out so
+// that the (heap allocated) request message can be released immediately.
+// If-None-Match is copied into the session (SessionRequest::if_none_match).
+struct RequestContext {
+    unsigned    version             = 11;
+    bool        keep_alive          = false;
+    bool        accept_gzip         = false;
+    bool        head                = false;
+    int64_t     if_modified_since   = -1;   // Seconds since the epoch; -1 if absent
+};
+inline bool ACCEPTS_GZIP (const std::string_view& accept_encoding)
+{
+    // Accept-Encoding: gzip, deflate, br / gzip;q=0.5 / *;q=0 ...
+    // gzip is acceptable if listed without a zero quality value.
+    for (size_t front = 0; front < accept_encoding.size();) {
+        auto back   = std::min(accept_encoding.find(',', front), accept_encoding.size());
+        auto coding = accept_encoding.substr(front, back - front);
+        front       = back + 1;
+        while (coding.size() && coding.front() == ' ') coding.remove_prefix(1);
+        auto params = coding.find(';');
+        auto name   = coding.substr(0, params);
+        while (name.size() && name.back() == ' ') name.remove_suffix(1);
+        if (!beast::iequals(name, "gzip")) continue;
+        if (params == std::string_view::npos) return true;
+        auto quality = coding.substr(params + 1);
+        while (quality.size() && quality.front() == ' ') quality.remove_prefix(1);
+        return !(quality.starts_with("q=0") && quality.find_first_not_of("0.", 3) == std::string_view::npos);
+    }
+    return false;
 }
 // Generic Formatter Function. Applies generic server information to finalize response payloads.
 template <class T>
-inline void FORMAT_RESPONSE (http::response<T>& response, const HTTPRequest_t &request, const Address& CORS) {
-    response.version(request.version());
+inline void FORMAT_RESPONSE (http::response<T>& response, const RequestContext &request, const Address& CORS) {
+    response.version(request.version);
     response.set(http::field::server, "Iris RESTful Server");
     if (CORS.length()) response.set("Access-Control-Allow-Origin", CORS);
-    response.keep_alive(request.keep_alive());
+    response.keep_alive(request.keep_alive);
     response.prepare_payload();
 }
+inline int64_t PARSE_HTTP_DATE (const std::string_view& date)
+{
+    // IMF-fixdate only (e.g. "Sun, 06 Nov 1994 08:49:37 GMT"); the obsolete
+    // formats are rarely sent and the request is then served unconditionally.
+    constexpr std::string_view MONTHS = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    if (date.size() != 29 || date.substr(25) != " GMT") return -1;
+    auto number = [&date](size_t offset, size_t length, int& value) {
+        auto result = std::from_chars(date.data() + offset, date.data() + offset + length, value);
+        return result.ec == std::errc{} && result.ptr == date.data() + offset + length;
+    };
+    struct tm time {};
+    auto month = MONTHS.find(date.substr(8, 3));
+    if (month == std::string_view::npos || month % 3) return -1;
+    if (!number(5, 2, time.tm_mday) || !number(12, 4, time.tm_year) ||
+        !number(17, 2, time.tm_hour) || !number(20, 2, time.tm_min) ||
+        !number(23, 2, time.tm_sec)) return -1;
+    time.tm_mon     = static_cast<int>(month / 3);
+    time.tm_year   -= 1900;
+    #ifdef _WIN32
+    return static_cast<int64_t>(_mkgmtime(&time));
+    #else
+    return static_cast<int64_t>(timegm(&time));
+    #endif
+}
+inline bool ETAG_MATCHES (std::string_view if_none_match, const std::string_view& etag)
+{
+    // If-None-Match: "a", W/"b" / * (weak comparison, RFC 9110 13.1.2)
+    while (if_none_match.size()) {
+        auto back   = std::min(if_none_match.find(','), if_none_match.size());
+        auto tag    = if_none_match.substr(0, back);
+        if_none_match.remove_prefix(std::min(back + 1, if_none_match.size()));
+        while (tag.size() && tag.front() == ' ') tag.remove_prefix(1);
+        while (tag.size() && tag.back()  == ' ') tag.remove_suffix(1);
+        if (tag.starts_with("W/")) tag.remove_prefix(2);
+        if (tag == "*" || tag == etag) return true;
+    }
+    return false;
+}
+inline bool NOT_MODIFIED (const std::string& if_none_match, const RequestContext& request,
+                          const std::string_view& etag, const SlideValidators& validators)
+{
+    // If-None-Match takes precedence; If-Modified-Since is then ignored.
+    if (if_none_match.size()) return ETAG_MATCHES(if_none_match, etag);
+    return request.if_modified_since > -1 && validators.modified > -1 &&
+           validators.modified <= request.if_modified_since;
+}
+inline std::string_view FORMAT_TILE_ETAG (char (&buffer)[64], const std::string& tag,
+                                          uint32_t layer, uint32_t tile)
+{
+    // "<slide tag>-<layer>-<tile>"; the slide tag is 16 hex digits at most
+    char* end = buffer;
+    *end++ = '"';
+    end = std::copy(tag.begin(), tag.end(), end);
+    *end++ = '-';
+    end = std::to_chars(end, buffer + sizeof(buffer), layer).ptr;
+    *end++ = '-';
+    end = std::to_chars(end, buffer + sizeof(buffer), tile).ptr;
+    *end++ = '"';
+    return std::string_view(buffer, end - buffer);
+}
+// Fields of a response whose body is a buffer owned by a slide. A not
+// modified (304) response carries only the validators and caching policy.
+struct BufferHeader {
+    std::string_view    mime;
+    size_t              size            = 0;
+    std::string_view    encoding;
+    std::string_view    etag;
+    std::string_view    last_modified;
+    std::string_view    cache_control;
+    bool                vary            = false; // The body depends upon Accept-Encoding
+    bool                not_modified    = false;
+};
+// Header of a response whose body is a buffer owned by a slide (tiles and
+// metadata). Written as text into the session's reused header string rather
+// than through http::fields, which heap allocates each field. The fields
+// and their order match FORMAT_RESPONSE.
+inline void FORMAT_BUFFER_HEADER (std::string& header, const RequestContext &request, const Address& CORS,
+                                  const BufferHeader& fields)
+{
+    header.assign(request.version == 10 ? "HTTP/1.0 " : "HTTP/1.1 ");
+    header.append(fields.not_modified ? "304 Not Modified\r\n" : "200 OK\r\n");
+    if (!fields.not_modified) {
+        header.append("Content-Type: ").append(fields.mime).append("\r\n");
+        if (fields.encoding.size()) header.append("Content-Encoding: ").append(fields.encoding).append("\r\n");
+    }
+    if (fields.etag.size()) header.append("ETag: ").append(fields.etag).append("\r\n");
+    if (fields.last_modified.size()) header.append("Last-Modified: ").append(fields.last_modified).append("\r\n");
+    if (fields.cache_control.size()) header.append("Cache-Control: ").append(fields.cache_control).append("\r\n");
+    if (fields.vary) header.append("Vary: Accept-Encoding\r\n");
+    header.append("Server: Iris RESTful Server\r\n");
+    if (CORS.length()) header.append("Access-Control-Allow-Origin: ").append(CORS).append("\r\n");
+    if (request.version == 10 && request.keep_alive) header.append("Connection: keep-alive\r\n");
+    if (request.version != 10 && !request.keep_alive) header.append("Connection: close\r\n");
+    if (!fields.not_modified) {
+        char length[24];
+        auto end = std::to_chars(length, length + sizeof(length), fields.size).ptr;
+        header.append("Content-Length: ").append(length, end).append("\r\n");
+    }
+    header.append("\r\n");
+}
+// Multipart (multipart/mixed) body of a tile batch. All part headers are
+// formatted up front into one string, so the Content-Length is known and the
+// body needs no chunked encoding; the tile bytes are referenced in the slide
+// mapping. The body is written in chunks of TILE_BATCH_CHUNK tiles, one
+// gather write each, so the first tiles reach the client while the pages of
+// later tiles are still being faulted in.
+constexpr std::string_view TILE_BATCH_BOUNDARY = "iris-tile-batch";
+constexpr std::string_view TILE_BATCH_MIME     = "multipart/mixed; boundary=iris-tile-batch";
+constexpr std::string_view DICOM_FRAMES_MIME   = "multipart/related; type=\"image/jpeg\"; boundary=iris-tile-batch";
+constexpr size_t TILE_BATCH_CHUNK = 16;
+struct TileBatchBody {
+    GetTileBatchResponse                response;
+    std::string                         parts;      // Part headers, then the closing delimiter
+    std::vector<uint32_t>               offsets;    // Start of each tile's part header; back() the delimiter
+    size_t                              next        = 0; // Next tile to write
+    std::array<net::const_buffer, TILE_BATCH_CHUNK * 2 + 2> buffers;
+    explicit TileBatchBody              (GetTileBatchResponse&& batch) : response(std::move(batch)) {}
+};
+inline size_t FORMAT_TILE_BATCH_PARTS (TileBatchBody& batch)
+{
+    // --<boundary>\r\nContent-Type: image/jpeg\r\nContent-ID: <index>\r\n
+    // Content-Length: <size>\r\n\r\n<bytes>\r\n--<boundary>...--\r\n
+    // DICOM frames (multipart/related) are identified by their order alone.
+    auto& tiles     = batch.response.tiles;
+    const bool iris = batch.response.protocol == REQUEST_PROTOCOL_IRIS;
+    size_t length   = 0;
+    batch.parts.reserve(tiles.size() * 96 + 32);
+    batch.offsets.reserve(tiles.size() + 1);
+    for (auto&& entry : tiles) {
+        char number[16];
+        batch.offsets.push_back(static_cast<uint32_t>(batch.parts.size()));
+        if (batch.offsets.size() > 1) batch.parts.append("\r\n");
+        batch.parts.append("--").append(TILE_BATCH_BOUNDARY).append("\r\nContent-Type: image/jpeg\r\n");
+        if (iris) batch.parts.append("Content-ID: ").append
+            (number, std::to_chars(number, number + sizeof(number), entry.index).ptr).append("\r\n");
+        batch.parts.append("Content-Length: ");
+        batch.parts.append(number, std::to_chars(number, number + sizeof(number), entry.tile.size).ptr);
+        batch.parts.append("\r\n\r\n");
+        length += entry.tile.size;
+    }
+    batch.offsets.push_back(static_cast<uint32_t>(batch.parts.size()));
+    batch.parts.append("\r\n--").append(TILE_BATCH_BOUNDARY).append("--\r\n");
+    return length + batch.parts.size();
+}
 template<class Session_>
-void __INTERNAL__Networking::interpret_request(const Session_& session, const HTTPRequest_t &request)
+void __INTERNAL__Networking::interpret_request(const Session_& session, HTTPRequest_t&& request)
 {
     // The _server->.on_X_Request callbacks use a nested callback for a VERY good reason.
     // This allows the __INTERNAL__Server instance to push the implementation off the stack
@@ -327,60 +916,137 @@ void __INTERNAL__Networking::interpret_request(const Session_& session, const HT
     // - Ryan
     switch (request.method()) {
             
-        // RESTful GET request
+        // RESTful GET request. POST and DELETE are only routed for the
+        // slide warm-up API; the server rejects them on any other target.
         case boost::beast::http::verb::head:
-        case boost::beast::http::verb::get: {
-            std::string target = request.target();
+        case boost::beast::http::verb::get:
+        case boost::beast::http::verb::post:
+        case boost::beast::http::verb::delete_: {
+            // The target is copied into the session's reused target string;
+            // the server parses views into it on the worker thread.
+            auto& target = session->request.target;
+            target.assign(request.target().data(), request.target().size());
             if (target.length() == 1 && target.compare("/") == 0)
                 target.append("index.html");
+            // Conditional headers are evaluated against the slide validators
+            // once the server has resolved the slide, before any tile bytes.
+            auto if_none_match = request[http::field::if_none_match];
+            session->request.if_none_match.assign(if_none_match.data(), if_none_match.size());
+            session->request.method = request.method() == http::verb::post    ? REQUEST_METHOD_POST :
+                                      request.method() == http::verb::delete_ ? REQUEST_METHOD_DELETE :
+                                      REQUEST_METHOD_GET;
+            const RequestContext context {
+                .version    = request.version(),
+                .keep_alive = request.keep_alive(),
+                .accept_gzip= ACCEPTS_GZIP(request[http::field::accept_encoding]),
+                .head       = request.method() == http::verb::head,
+                .if_modified_since = PARSE_HTTP_DATE(request[http::field::if_modified_since]),
+            };
             
             // See __INTERNAL__Server::on_get_request (IrisRestfulServer.cpp) for implementation
-            _server->on_get_request(session, target, [this,session, request]
-                                    (const std::unique_ptr<GetResponse>& response){
+            _server->on_get_request(session, [this, session, context]
+                                    (GetResponse&& response){
                 
-                switch (response->type) {
-                        // Tile Data response (most frequent type of response)
-                    case GetResponse::GET_RESPONSE_TILE: {
-                        auto __response     = reinterpret_cast<GetTileResponse*>(response.get());
-                        auto tile_response  = GENERATE_TILE_RESPONSE(*__response);
-                        FORMAT_RESPONSE(*tile_response, request, _CORS);
-                        return send_buffer(session, tile_response, __response->pixelData);
-                    }
-                        
-                        // String / Text responses (returning text-formatted information)
-                    case GetResponse::GET_RESPONSE_UNDEFINED:
-                    case GetResponse::GET_RESPONSE_MALFORMED_REQ:
-                    case GetResponse::GET_RESPONSE_FILE_NOT_FOUND:
-                    case GetResponse::GET_RESPONSE_METADATA: {
-                        auto string_response = GENERATE_STRING_GET_RESPONSE(*response);
-                        FORMAT_RESPONSE(*string_response, request, _CORS);
-                        return send_response(session, string_response);
-                    }
-                        
-                        // File Server responses for Web server functionality (if enabled)
-                    case GetResponse::GET_RESPONSE_FILE: {
-                        auto __response     = reinterpret_cast<GetFileResponse*>(response.get());
-                        auto file_response  = GENERATE_FILE_RESPONSE(*__response);
-                        FORMAT_RESPONSE(*file_response, request, _CORS);
-                        return send_file(session, file_response);
+                // Tile Data response (most frequent type of response)
+                if (auto tile = std::get_if<GetTileResponse>(&response)) {
+                    auto& validators    = tile->slide->get_validators();
+                    char etag_buffer[64];
+                    BufferHeader fields {
+                        .mime           = "image/jpeg",
+                        .size           = tile->tile.size,
+                        .etag           = FORMAT_TILE_ETAG(etag_buffer, validators.tag, tile->layer, tile->index),
+                        .last_modified  = validators.last_modified,
+                        .cache_control  = _cache_control,
+                    };
+                    fields.not_modified = NOT_MODIFIED(session->request.if_none_match, context,
+                                                       fields.etag, validators);
+                    FORMAT_BUFFER_HEADER(session->request.header, context, _CORS, fields);
+                    // Not modified and HEAD responses write only the header
+                    if (fields.not_modified || context.head)
+                        return send_slide_buffer(session, nullptr, 0, nullptr, context.keep_alive);
+                    _server->_counters.tile_bytes += tile->tile.size;
+                    if constexpr (SENDFILE_STREAM<Session_>) if
+                        (SENDFILE_ACTIVE(session, _delivery) &&
+                         tile->slide->get_file_descriptor() > -1)
+                        return send_tile_range(session, *tile, context.keep_alive);
+                    return send_slide_buffer(session, tile->tile.data, tile->tile.size,
+                                             tile->slide, context.keep_alive);
+                }
+                
+                // Tile batch; multipart body written in chunks (see TileBatchBody)
+                if (auto tiles = std::get_if<GetTileBatchResponse>(&response)) {
+                    auto batch  = std::make_shared<TileBatchBody>(std::move(*tiles));
+                    BufferHeader fields {
+                        .mime           = batch->response.protocol == REQUEST_PROTOCOL_DICOM ?
+                                          DICOM_FRAMES_MIME : TILE_BATCH_MIME,
+                        .size           = FORMAT_TILE_BATCH_PARTS(*batch),
+                        .cache_control  = _cache_control,
+                    };
+                    FORMAT_BUFFER_HEADER(session->request.header, context, _CORS, fields);
+                    if (context.head)
+                        return send_slide_buffer(session, nullptr, 0, nullptr, context.keep_alive);
+                    _server->_counters.tile_bytes += fields.size - batch->parts.size();
+                    return send_tile_batch(session, batch, context.keep_alive);
+                }
+                
+                // Slide metadata; serialized once per slide and sent by reference
+                if (auto metadata = std::get_if<GetMetadataResponse>(&response)) {
+                    auto& validators    = metadata->slide->get_validators();
+                    BufferHeader fields {
+                        .last_modified  = validators.last_modified,
+                        .cache_control  = _cache_control,
+                    };
+                    const std::string* body;
+                    if (metadata->protocol == REQUEST_PROTOCOL_DICOM) {
+                        // Generated by the worker thread (see PROCESS_GET_METATADATA_REQUEST)
+                        auto& dicom     = metadata->slide->get_dicom_metadata();
+                        const bool series = metadata->instance < 0;
+                        body            = series ? &dicom.series : &dicom.instances[metadata->instance];
+                        fields.mime     = "application/dicom+json";
+                        fields.etag     = series ? dicom.series_etag : dicom.instance_etags[metadata->instance];
+                    } else {
+                        auto& serialized = metadata->slide->get_metadata();
+                        const bool gzip = context.accept_gzip && serialized.gzip.size();
+                        body            = gzip ? &serialized.gzip : &serialized.json;
+                        fields.mime     = "application/json";
+                        fields.encoding = gzip ? "gzip" : "";
+                        fields.etag     = gzip ? serialized.gzip_etag : serialized.etag;
+                        fields.vary     = true;
                     }
-                        
-                        
+                    fields.size         = body->size();
+                    fields.not_modified = NOT_MODIFIED(session->request.if_none_match, context,
+                                                       fields.etag, validators);
+                    FORMAT_BUFFER_HEADER(session->request.header, context, _CORS, fields);
+                    if (fields.not_modified || context.head)
+                        return send_slide_buffer(session, nullptr, 0, nullptr, context.keep_alive);
+                    return send_slide_buffer(session, reinterpret_cast<const BYTE*>(body->data()), body->size(),
+                                             metadata->slide, context.keep_alive);
+                }
+                
+                // File Server responses for Web server functionality (if enabled)
+                if (auto file = std::get_if<GetFileResponse>(&response)) {
+                    auto file_response  = GENERATE_FILE_RESPONSE(*file);
+                    FORMAT_RESPONSE(*file_response, context, _CORS);
+                    if (context.head) return send_header
+                        (session, std::make_shared<HTTPResponseHeader_t>(std::move(file_response->base())));
+                    return send_file(session, file_response);
                 }
+                
+                // String / Text responses (returning text-formatted information)
+                auto string_response = GENERATE_STRING_GET_RESPONSE(response);
+                FORMAT_RESPONSE(*string_response, context, _CORS);
+                if (context.head) return send_header
+                    (session, std::make_shared<HTTPResponseHeader_t>(std::move(string_response->base())));
+                return send_response(session, string_response);
             }); return;
         }
             
-        // RESTful POST request
-        case http::verb::post:
-        
         // RESTFUL PUT request
         case http::verb::put:
             
         // RESTFUL PATCH request
         case http::verb::patch:
             
-        // RESTFUL DELETE request
-        case http::verb::delete_:
         case http::verb::options:
         default: {
             
@@ -394,7 +1060,7 @@ template<class Session_>
 void __INTERNAL__Networking::send_response(const Session_ &session, const HTTPResponse &response)
 {
     http::async_write(*session->stream, *response,
-                      [this, session, response]
+                      SESSION_HANDLER(session, [this, session, response]
                       (beast::error_code error, size_t bytes_transferred) {
         if (error) std::cerr    << "["<<session->remote<<"] "
                                 << "Error writing response to stream: "
@@ -402,28 +1068,168 @@ void __INTERNAL__Networking::send_response(const Session_ &session, const HTTPRe
         if (response->keep_alive() && IS_STREAM_OPEN(session))
                 read_request (session);
         else    close_stream (session);
-    });
+    }));
 }
 template<class Session_>
-void __INTERNAL__Networking::send_buffer(const Session_ &session, const HTTPResponseBuffer &response, const Buffer &buffer)
+void __INTERNAL__Networking::send_header(const Session_ &session, const HTTPResponseHeader &response)
 {
-//    auto serializer = std::make_shared<http::serializer<false, http::buffer_body>> (*response);
+    // HEAD responses: the header (including the Content-Length the body
+    // would have had) is moved into a message without a body.
     http::async_write(*session->stream, *response,
-                      [this, session, response, buffer]
+                      SESSION_HANDLER(session, [this, session, response]
                       (beast::error_code error, size_t bytes_transferred) {
         if (error) std::cerr    << "["<<session->remote<<"] "
-                                << "Error writing bin buffer response to stream: "
+                                << "Error writing header response to stream: "
                                 << error.message();
         if (response->keep_alive() && IS_STREAM_OPEN(session))
                 read_request (session);
         else    close_stream (session);
+    }));
+}
+template<class Session_>
+void __INTERNAL__Networking::send_slide_buffer(const Session_ &session, const BYTE* data, size_t size,
+                                               const Slide &slide, bool keep_alive)
+{
+    // Gather the session's header and the body bytes into a single write.
+    // The body is owned by the slide (a tile within its file mapping, or its
+    // serialized metadata) and is written without a copy; capturing the
+    // slide keeps those bytes alive until the write completes.
+    const std::array<net::const_buffer, 2> buffers {
+        net::buffer(session->request.header),
+        net::buffer(data, size),
+    };
+    net::async_write(*session->stream, buffers,
+                     SESSION_HANDLER(session, [this, session, slide, keep_alive]
+                     (beast::error_code error, size_t bytes_transferred) {
+        if (error) std::cerr    << "["<<session->remote<<"] "
+                                << "Error writing buffer response to stream: "
+                                << error.message();
+        if (!error && keep_alive && IS_STREAM_OPEN(session))
+                read_request (session);
+        else    close_stream (session);
+    }));
+}
+template<class Session_>
+void __INTERNAL__Networking::send_tile_batch(const Session_ &session, const TileBatch &batch, bool keep_alive)
+{
+    // Gather the next chunk of part headers and tile bytes (with the response
+    // header before the first chunk and the closing delimiter after the last)
+    // into one write; the batch keeps its slide, and so the bytes, alive.
+    auto& tiles         = batch->response.tiles;
+    auto& parts         = batch->parts;
+    auto& offsets       = batch->offsets;
+    auto& buffers       = batch->buffers;
+    const size_t end    = std::min(batch->next + TILE_BATCH_CHUNK, tiles.size());
+    size_t count        = 0;
+    if (batch->next == 0) buffers[count++] = net::buffer(session->request.header);
+    for (size_t index = batch->next; index < end; ++index) {
+        buffers[count++] = net::buffer(parts.data() + offsets[index], offsets[index + 1] - offsets[index]);
+        buffers[count++] = net::buffer(tiles[index].tile.data, tiles[index].tile.size);
+    }
+    if (end == tiles.size())
+        buffers[count++] = net::buffer(parts.data() + offsets.back(), parts.size() - offsets.back());
+    batch->next = end;
+    
+    net::async_write(*session->stream, std::span<const net::const_buffer>(buffers.data(), count),
+                     SESSION_HANDLER(session, [this, session, batch, keep_alive]
+                     (beast::error_code error, size_t bytes_transferred) {
+        if (error) {
+            std::cerr   << "["<<session->remote<<"] "
+                        << "Error writing tile batch to stream: "
+                        << error.message();
+            return close_stream (session);
+        }
+        if (batch->next < batch->response.tiles.size())
+                return send_tile_batch (session, batch, keep_alive);
+        if (keep_alive && IS_STREAM_OPEN(session))
+                read_request (session);
+        else    close_stream (session);
+    }));
+}
+#if IRIS_SENDFILE_SUPPORTED
+template <class Handler>
+inline void ASYNC_SEND_FILE_RANGE (ASIOSocket_t& socket, int fd, off_t offset, size_t remaining,
+                                   SessionHandler<Handler>&& handler)
+{
+    // Push as much of the range as the socket buffer will accept. When the
+    // socket would block, wait for it to become writable on the reactor
+    // and resume from the updated offset.
+    while (remaining) {
+        ssize_t sent = ::sendfile(socket.native_handle(), fd, &offset, remaining);
+        if (sent > 0) { remaining -= sent; continue; }
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            const auto allocator = handler.get_allocator();
+            socket.async_wait(tcp::socket::wait_write, SESSION_HANDLER(allocator,
+                              [&socket, fd, offset, remaining, handler = std::move(handler)]
+                              (beast::error_code error) mutable {
+                if (error) return handler(error);
+                ASYNC_SEND_FILE_RANGE(socket, fd, offset, remaining, std::move(handler));
+            }));
+            return;
+        }
+        // A zero return means the file ended before the range did (truncated)
+        return handler(beast::error_code(sent < 0 ? errno : EIO, boost::system::system_category()));
+    }
+    handler(beast::error_code{});
+}
+#endif
+template <class Handler>
+inline void ASYNC_SEND_TILE_RANGE (const Session& session, int fd, const TileData& tile, Handler&& handler)
+{
+    #if IRIS_SENDFILE_SUPPORTED
+    // The session deadline (see WATCH_DEADLINE) also covers the writability
+    // waits of the sendfile phase: a client that stops reading has its wait
+    // cancelled rather than holding the session (and the slide's descriptor).
+    auto& socket = beast::get_lowest_layer(*session->stream).socket();
+    beast::error_code error;
+    socket.native_non_blocking(true, error);
+    ASYNC_SEND_FILE_RANGE(socket, fd, static_cast<off_t>(tile.offset), tile.size, std::move(handler));
+    #endif
+}
+template <class Handler>
+inline void ASYNC_SEND_TILE_RANGE (const KtlsSession& session, int fd, const TileData& tile, Handler&& handler)
+{
+    // The kernel encrypts the file range as TLS records (SSL_sendfile)
+    session->stream->async_sendfile(fd, static_cast<off_t>(tile.offset), tile.size,
+                                    [handler = std::move(handler)]
+                                    (beast::error_code error, size_t) {
+        handler(error);
     });
 }
 template<class Session_>
+void __INTERNAL__Networking::send_tile_range(const Session_ &session, const GetTileResponse &response, bool keep_alive)
+{
+    static_assert(SENDFILE_STREAM<Session_>, "send_tile_range requires an unencrypted or kernel TLS stream");
+    // Write the session's tile header through the stream first, then have the
+    // kernel copy the tile bytes from the slide file directly into the socket.
+    // Capturing the slide keeps its file descriptor open until complete.
+    net::async_write(*session->stream, net::buffer(session->request.header),
+                     SESSION_HANDLER(session, [this, session, tile = response.tile, slide = response.slide, keep_alive]
+                     (beast::error_code error, size_t bytes_transferred) {
+        if (error) {
+            std::cerr   << "["<<session->remote<<"] "
+                        << "Error writing tile response header to stream: "
+                        << error.message();
+            return close_stream (session);
+        }
+        ASYNC_SEND_TILE_RANGE(session, slide->get_file_descriptor(), tile,
+                              SESSION_HANDLER(session, [this, session, slide, keep_alive]
+                              (beast::error_code error) {
+            if (error) std::cerr    << "["<<session->remote<<"] "
+                                    << "Error sending tile range to stream: "
+                                    << error.message();
+            if (!error && keep_alive && IS_STREAM_OPEN(session))
+                    read_request (session);
+            else    close_stream (session);
+        }));
+    }));
+}
+template<class Session_>
 void __INTERNAL__Networking::send_file(const Session_ &session, const HTTPResponseFile &response)
 {
     http::async_write(*session->stream, *response,
-                      [this, session, response]
+                      SESSION_HANDLER(session, [this, session, response]
                       (beast::error_code error, size_t bytes_transferred){
         if (error) std::cerr    << "["<<session->remote<<"] "
                                 << "Error writing file response to stream: "
@@ -431,7 +1237,7 @@ void __INTERNAL__Networking::send_file(const Session_ &session, const HTTPRespon
         if (response->keep_alive() && IS_STREAM_OPEN(session))
                 read_request (session);
         else    close_stream (session);
-    });
+    }));
 }
 template<> void __INTERNAL__Networking::close_stream<Session>(const Session& session)
 {
@@ -457,5 +1263,20 @@ template<> void __INTERNAL__Networking::close_stream<SslSession>(const SslSessio
                             << "Error in closing the stream: "
                             << error.message() << "\n";
 }
+template<> void __INTERNAL__Networking::close_stream<KtlsSession>(const KtlsSession& session)
+{
+    beast::get_lowest_layer(*session->stream).expires_after(Time::seconds(30));
+    beast::error_code error;
+    if (IS_STREAM_OPEN(session)) {
+        (*session->stream).shutdown(error);
+        (*session->stream).socket().shutdown(tcp::socket::shutdown_send, error);
+    }
+    if (error == net::ssl::error::stream_truncated ||
+        error == net::error::broken_pipe ||
+        error == net::error::not_connected);
+    else if (error) std::cerr    << "["<<session->remote<<"] "
+                            << "Error in closing the stream: "
+                            << error.message() << "\n";
+}
 } // END RESTFUL
 } // END IRIS
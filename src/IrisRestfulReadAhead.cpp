@@ -0,0 +1,204 @@
+/**
+ * @file IrisRestfulReadAhead.cpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ */
+#include <cmath>
+#include <algorithm>
+#include "IrisRestfulPriv.hpp"
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Iris {
+namespace RESTful {
+using Targets = __INTERNAL__ReadAhead::Targets;
+constexpr float     FAST_AVERAGE    = 0.5f;     // Weights of the newest position
+constexpr float     SLOW_AVERAGE    = 0.1f;
+constexpr float     PAN_THRESHOLD   = 1.0f;     // Tiles of separation that indicate a pan
+constexpr uint32_t  MIN_SAMPLES     = 8;        // Within the layer before predicting a pan
+constexpr int64_t   GESTURE_GAP     = 1000000000; // Idle time (ns) that ends a gesture
+inline void ADVISE_WILLNEED (const TileData& tile)
+{
+    // Start reading the pages of the tile's byte range into the page cache.
+    // For file mappings this only queues the reads; it does not wait on them.
+    #ifndef _WIN32
+    static const uintptr_t PAGE = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    if (!tile.data || !tile.size) return;
+    auto front = reinterpret_cast<uintptr_t>(tile.data) & ~(PAGE - 1);
+    auto back  = reinterpret_cast<uintptr_t>(tile.data) + tile.size;
+    madvise(reinterpret_cast<void*>(front), back - front, MADV_WILLNEED);
+    #endif
+}
+inline void ADD_TARGET (Targets& targets, const LayerExtents& layers, uint32_t layer, int64_t x, int64_t y)
+{
+    if (targets.count == __INTERNAL__ReadAhead::MAX_TARGETS || layer >= layers.size()) return;
+    auto& extent = layers[layer];
+    if (x < 0 || y < 0 || x >= extent.xTiles || y >= extent.yTiles) return;
+    targets.tiles[targets.count++] = {layer, static_cast<uint32_t>(y * extent.xTiles + x)};
+}
+inline void ADD_CHILDREN (Targets& targets, const LayerExtents& layers, uint32_t layer, uint32_t x, uint32_t y)
+{
+    if (layer + 1 >= layers.size()) return;
+    const double ratio  = layers[layer + 1].scale / layers[layer].scale;
+    for (auto cy = static_cast<int64_t>(y * ratio); cy < std::ceil((y + 1) * ratio); ++cy)
+        for (auto cx = static_cast<int64_t>(x * ratio); cx < std::ceil((x + 1) * ratio); ++cx)
+            ADD_TARGET(targets, layers, layer + 1, cx, cy);
+}
+inline void ADD_PARENT (Targets& targets, const LayerExtents& layers, uint32_t layer, uint32_t x, uint32_t y)
+{
+    if (layer == 0) return;
+    const double ratio  = layers[layer].scale / layers[layer - 1].scale;
+    ADD_TARGET(targets, layers, layer - 1, static_cast<int64_t>(x / ratio), static_cast<int64_t>(y / ratio));
+}
+inline void RECORD_MOTION (SessionMotion& motion, uint32_t layer, uint32_t x, uint32_t y)
+{
+    const int64_t now = Time::steady_clock::now().time_since_epoch().count();
+    if (layer != motion.layer || now - motion.last > GESTURE_GAP) {
+        // A new layer or gesture; remember the zoom direction if the layer changed
+        motion.zoom     = motion.layer == UINT32_MAX || now - motion.last > GESTURE_GAP ? 0 :
+                          layer > motion.layer ? 1 : layer < motion.layer ? -1 : 0;
+        motion.layer    = layer;
+        motion.count    = 0;
+        motion.fast_x   = motion.slow_x = static_cast<float>(x);
+        motion.fast_y   = motion.slow_y = static_cast<float>(y);
+    }
+    motion.history[motion.count++ % SessionMotion::HISTORY] = {x, y};
+    motion.fast_x += FAST_AVERAGE * (x - motion.fast_x);
+    motion.fast_y += FAST_AVERAGE * (y - motion.fast_y);
+    motion.slow_x += SLOW_AVERAGE * (x - motion.slow_x);
+    motion.slow_y += SLOW_AVERAGE * (y - motion.slow_y);
+    motion.last     = now;
+}
+inline bool PREDICT_MOTION (const SessionMotion& motion, const LayerExtents& layers,
+                            uint32_t layer, uint32_t x, uint32_t y, Targets& targets)
+{
+    // Zooming: the tiles of the next layer in the same direction
+    if (motion.zoom > 0 && motion.count < MIN_SAMPLES) ADD_CHILDREN(targets, layers, layer, x, y);
+    if (motion.zoom < 0 && motion.count < MIN_SAMPLES) ADD_PARENT(targets, layers, layer, x, y);
+    if (targets.count) return true;
+
+    // Panning: the column and/or row just beyond the leading edge of the
+    // region requested recently, in the direction of motion
+    if (motion.count < MIN_SAMPLES) return false;
+    const float vx = motion.fast_x - motion.slow_x;
+    const float vy = motion.fast_y - motion.slow_y;
+    if (std::abs(vx) < PAN_THRESHOLD && std::abs(vy) < PAN_THRESHOLD) return false;
+    uint32_t min_x = UINT32_MAX, max_x = 0, min_y = UINT32_MAX, max_y = 0;
+    for (uint32_t index = 0; index < std::min(motion.count, SessionMotion::HISTORY); ++index) {
+        auto& sample = motion.history[index];
+        min_x = std::min(min_x, sample.x); max_x = std::max(max_x, sample.x);
+        min_y = std::min(min_y, sample.y); max_y = std::max(max_y, sample.y);
+    }
+    if (std::abs(vx) >= PAN_THRESHOLD) {
+        const int64_t column = vx > 0 ? int64_t(max_x) + 1 : int64_t(min_x) - 1;
+        for (int64_t row = min_y; row <= max_y; ++row) ADD_TARGET(targets, layers, layer, column, row);
+    }
+    if (std::abs(vy) >= PAN_THRESHOLD) {
+        const int64_t row = vy > 0 ? int64_t(max_y) + 1 : int64_t(min_y) - 1;
+        for (int64_t column = min_x; column <= max_x; ++column) ADD_TARGET(targets, layers, layer, column, row);
+    }
+    return targets.count;
+}
+inline void NEIGHBORHOOD (const LayerExtents& layers, uint32_t layer, uint32_t x, uint32_t y, Targets& targets)
+{
+    // 8-neighborhood within the layer (panning), then parent and children (zooming)
+    for (int dy = -1; dy <= 1; ++dy)
+        for (int dx = -1; dx <= 1; ++dx)
+            if (dx || dy) ADD_TARGET(targets, layers, layer, int64_t(x) + dx, int64_t(y) + dy);
+    ADD_PARENT(targets, layers, layer, x, y);
+    ADD_CHILDREN(targets, layers, layer, x, y);
+}
+__INTERNAL__ReadAhead::__INTERNAL__ReadAhead(const Async::ThreadPool& threads, uint32_t budget) :
+_threads    (threads),
+_budget     (budget),
+_targets    (std::make_unique<Targets[]>(budget)),
+_free       (budget),
+_in_flight  (0),
+_counters   ()
+{
+    for (uint32_t index = 0; index < _budget; ++index)
+        _free.try_push(uint32_t(index));
+}
+__INTERNAL__ReadAhead::~__INTERNAL__ReadAhead()
+{
+    // In-flight tasks reference this object; let them finish
+    while (_in_flight.load()) std::this_thread::yield();
+}
+void __INTERNAL__ReadAhead::on_tile_served(const Slide& slide, uint32_t layer, uint32_t tile, SessionMotion& motion)
+{
+    auto& layers = slide->get_extent().layers;
+    if (layer >= layers.size() || !layers[layer].xTiles) return;
+    const uint32_t x = tile % layers[layer].xTiles;
+    const uint32_t y = tile / layers[layer].xTiles;
+
+    switch (slide->clear_prefetched(layer, tile)) {
+        case PREFETCH_NONE: ++_counters.misses; break;
+        case PREFETCH_PREDICTED: ++_counters.predicted_hits; [[fallthrough]];
+        case PREFETCH_NEIGHBOR:
+            ++_counters.hits;
+            _counters.hit_bytes += slide->get_tile_entry(layer, tile).size;
+            break;
+    }
+    RECORD_MOTION(motion, layer, x, y);
+
+    // Reserve a target list within the in-flight budget or do not follow this tile
+    uint32_t index;
+    if (!_free.try_pop(index)) { ++_counters.dropped; return; }
+    ++_in_flight;
+
+    // The targets are chosen here, while the motion is this worker's to read
+    auto& targets = _targets[index];
+    targets = Targets {};
+    if (PREDICT_MOTION(motion, layers, layer, x, y, targets)) targets.kind = PREFETCH_PREDICTED;
+    else NEIGHBORHOOD(layers, layer, x, y, targets);
+    // Read-ahead is optional work: under backpressure it is dropped
+    if (!_threads->try_issue_task([this, slide, index]() {
+        advise(slide, _targets[index]);
+        release(index);
+    })) {
+        release(index);
+        ++_counters.dropped;
+    }
+}
+void __INTERNAL__ReadAhead::release(uint32_t index)
+{
+    // The ring holds every index, so returning one always succeeds
+    _free.try_push(uint32_t(index));
+    --_in_flight;
+}
+void __INTERNAL__ReadAhead::advise(const Slide& slide, const Targets& targets)
+{
+    for (uint32_t index = 0; index < targets.count; ++index) {
+        auto& target = targets.tiles[index];
+        // Each tile is advised once until it is served, its flag expires, or
+        // the slide's pages are released (see __INTERNAL__Slide::flag_prefetched)
+        if (!slide->flag_prefetched(target.layer, target.index, targets.kind)) continue;
+        try {
+            auto tile = slide->get_tile_entry(target.layer, target.index);
+            ADVISE_WILLNEED(tile);
+            _counters.bytes += tile.size;
+        } catch (std::runtime_error&) { continue; }
+        ++_counters.issued;
+        if (targets.kind == PREFETCH_PREDICTED) ++_counters.predicted;
+    }
+}
+void __INTERNAL__ReadAhead::get_statistics(ServerStatistics& statistics) const
+{
+    const uint64_t bytes = _counters.bytes.load(), hit_bytes = _counters.hit_bytes.load();
+    statistics.readahead_issued         = _counters.issued.load();
+    statistics.readahead_predicted      = _counters.predicted.load();
+    statistics.readahead_dropped        = _counters.dropped.load();
+    statistics.readahead_hits           = _counters.hits.load();
+    statistics.readahead_predicted_hits = _counters.predicted_hits.load();
+    statistics.readahead_misses         = _counters.misses.load();
+    statistics.readahead_wasted_bytes   = bytes > hit_bytes ? bytes - hit_bytes : 0;
+}
+} // END RESTFUL
+} // END IRIS
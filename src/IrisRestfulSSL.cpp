@@ -15,6 +15,7 @@
 #pragma clang diagnostic pop
 #endif // __clang__
 
+#include <fstream>
 #include "IrisRestfulPriv.hpp"
 
 // Modular Exponential (MODP) Groups for the Internet Key Exchange (IKE) protocol
@@ -222,8 +223,37 @@ inline Result GENERATE_SELF_SIGNED_CERT (Iris::Buffer & cert, Iris::Buffer & key
     
     return result;
 }
+inline void ENABLE_KERNEL_TLS (boost::asio::ssl::context& ctx)
+{
+    #if defined(__linux__) && defined(SSL_OP_ENABLE_KTLS)
+    // Ask OpenSSL to hand symmetric record encryption to the kernel once the
+    // handshake completes. Whether the kernel accepts is checked per connection.
+    auto native = ctx.native_handle();
+    SSL_CTX_set_options (native, SSL_OP_ENABLE_KTLS);
+    // Restrict to AES-GCM suites which every kTLS capable kernel implements
+    // (ChaCha20-Poly1305 offload is kernel version dependent).
+    SSL_CTX_set_ciphersuites (native, "TLS_AES_128_GCM_SHA256:TLS_AES_256_GCM_SHA384");
+    // Session tickets are post-handshake records; skip them so the socket
+    // carries only application data once it is handed to the kernel.
+    SSL_CTX_set_num_tickets (native, 0);
+    
+    // The kernel 'tls' upper layer protocol must be loaded for the offload
+    std::ifstream ulp ("/proc/sys/net/ipv4/tcp_available_ulp");
+    std::string available;
+    std::getline(ulp, available);
+    if (available.find("tls") == std::string::npos)
+        std::cout   << "[WARNING] Kernel TLS requested but the kernel 'tls' module is not loaded "
+                    << "(see /proc/sys/net/ipv4/tcp_available_ulp). Connections will be encrypted "
+                    << "by OpenSSL in user space until it is loaded (modprobe tls).\n";
+    else std::cout  << "[NOTE] Kernel TLS offload enabled for HTTPS connections.\n";
+    #else
+    std::cout   << "[WARNING] Kernel TLS was requested but is not supported by this platform "
+                << "or OpenSSL build. Connections will be encrypted by OpenSSL in user space.\n";
+    #endif
+}
 std::shared_ptr<boost::asio::ssl::context> CREATE_SSL_CONTEXT (const std::filesystem::path& cert_path,
-                                                               const std::filesystem::path& key_path) {
+                                                               const std::filesystem::path& key_path,
+                                                               bool ktls) {
     
     Result result = IRIS_FAILURE;
     Iris::Buffer cert = NULL, key = NULL;
@@ -257,6 +287,8 @@ std::shared_ptr<boost::asio::ssl::context> CREATE_SSL_CONTEXT (const std::filesy
             << "supports 1024, 1536, 2048, 3072, and 4096 bit ciphers for Diffie-Hellman key agreement protocols.\n";
     }
     
+    if (ktls) ENABLE_KERNEL_TLS (*ctx);
+    
     // Return the newly constructed SSL Context
     return ctx;
 }
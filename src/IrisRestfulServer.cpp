@@ -8,6 +8,10 @@
  * @copyright Copyright (c) 2025 Iris Developers
  *
  */
+#include <cmath>
+#include <charconv>
+#include <algorithm>
+#include <bit>
 #include "IrisRestfulPriv.hpp"
 Iris::RESTful::Server Iris::RESTful::create_server(const ServerCreateInfo& info)
 {
@@ -60,6 +64,19 @@ Iris::RESTful::Server Iris::RESTful::create_server(const ServerCreateInfo& info)
         }
     }
     
+    // Create the persistent slide-open cache directory if requested
+    if (!mut_info.cache_dir.empty()) {
+        mut_info.cache_dir.make_preferred();
+        std::error_code error;
+        std::filesystem::create_directories(mut_info.cache_dir, error);
+        if (error || std::filesystem::is_directory(mut_info.cache_dir) == false) {
+            std::cerr   << "[WARNING] Failed to create the slide cache directory ("
+                        << mut_info.cache_dir
+                        << "); slides will be validated on every open\n";
+            mut_info.cache_dir.clear();
+        }
+    }
+    
     // Create a server instance
     try { return std::make_shared<__INTERNAL__Server>(mut_info); }
     catch (std::runtime_error& error) {
@@ -91,106 +108,382 @@ Iris::Result Iris::RESTful::server_listen(const Server& server, uint16_t port)
     }   return IRIS_SUCCESS;
 }
 
+Iris::RESTful::ServerStatistics Iris::RESTful::get_server_statistics(const Server& server)
+{
+    if (!server) return ServerStatistics();
+    return server->get_statistics();
+}
+
 namespace Iris {
 namespace RESTful {
 using namespace std::placeholders;
 __INTERNAL__Server::__INTERNAL__Server(const ServerCreateInfo& info) :
 _root       (info.slide_dir),
 _doc_root   (info.doc_root),
-_networking (std::make_unique<__INTERNAL__Networking>(this, info.https, info.cert, info.key, info.cors.length()?info.cors:_doc_root.empty()?"*":"")),
+_cache_dir  (info.cache_dir),
+_retain_slides  (info.retain_slides),
+_retain_bytes   (info.retain_bytes),
+_retain_ttl     (info.retain_ttl),
+_warm_api       (info.warm_api),
+_warming        (),
+_dispatch       (info.dispatch),
+_catalog    (info.catalog?std::make_unique<__INTERNAL__Catalog>(info.slide_dir, info.cache_dir,
+                                                                 info.watch && IRIS_WATCHER_SUPPORTED):nullptr),
+_networking (std::make_unique<__INTERNAL__Networking>(this, info.https, info.cert, info.key, info.cors.length()?info.cors:_doc_root.empty()?"*":"", info.delivery, info.ktls,
+                                                         info.cache_max_age, info.cache_immutable, info.reactors)),
 // ^Assign a designated CORS, if empty assign * only if no webserver root.
-_threads(Async::createThreadPool(IRIS_CONCURRENCY * 3))
+_threads(Async::createThreadPool(IRIS_CONCURRENCY * 3)),
+_readahead  (info.readahead?std::make_unique<__INTERNAL__ReadAhead>(_threads, info.readahead):nullptr)
+{
+    if (_catalog) _catalog->scan(_threads, std::bind(&__INTERNAL__Server::register_dicom_series, this, _1));
+    if (info.memory_pressure) _governor = std::make_unique<__INTERNAL__MemoryGovernor>
+        (static_cast<float>(info.memory_pressure), [this]() {
+            // Slides pinned through the warm-up API are exempt from release
+            std::vector<Slide> slides;
+            for (auto&& id : _directory.identifiers())
+                if (Slide slide = _directory.find(id)) slides.push_back(slide);
+            MutexLock lock (_retained.mutex);
+            std::erase_if(slides, [this](const Slide& slide) {
+                auto __pinned = _retained.pinned.find(slide->get_id());
+                return __pinned != _retained.pinned.end() && __pinned->second == slide;
+            });
+            return slides;
+        });
+    if (info.watch) _watcher = std::make_unique<__INTERNAL__Watcher>
+        (_root, std::bind(&__INTERNAL__Server::on_slide_file_changed, this, _1, _2));
+    if (_retain_slides) {
+        _housekeeping.active = true;
+        _housekeeping.thread = std::thread(&__INTERNAL__Server::housekeeping, this);
+    }
+}
+void LatencyHistogram::record(Time::steady_clock::duration duration)
 {
+    const auto value = static_cast<uint64_t>(std::max<int64_t>
+        (0, Time::duration_cast<Time::microseconds>(duration).count()));
+    // Values below SUB_BUCKETS have a bucket each; above, the top 4 bits
+    // (the leading one and 3 bits of fraction) select the bucket
+    uint32_t bucket = static_cast<uint32_t>(value);
+    if (value >= SUB_BUCKETS) {
+        const uint32_t exponent = std::bit_width(value) - 1;
+        bucket = (exponent - 2) * SUB_BUCKETS + ((value >> (exponent - 3)) & (SUB_BUCKETS - 1));
+    }
+    _counts[std::min(bucket, BUCKETS - 1)].fetch_add(1, std::memory_order_relaxed);
+}
+uint64_t LatencyHistogram::percentile(double fraction) const
+{
+    uint64_t counts[BUCKETS], total = 0;
+    for (uint32_t bucket = 0; bucket < BUCKETS; ++bucket)
+        total += counts[bucket] = _counts[bucket].load(std::memory_order_relaxed);
+    if (total == 0) return 0;
+    const auto rank = static_cast<uint64_t>(std::ceil(fraction * total));
+    uint64_t seen = 0;
+    for (uint32_t bucket = 0; bucket < BUCKETS; ++bucket) {
+        if ((seen += counts[bucket]) < rank) continue;
+        if (bucket < SUB_BUCKETS) return bucket;
+        const uint32_t exponent = bucket / SUB_BUCKETS + 2;
+        const uint64_t width    = 1ULL << (exponent - 3);
+        return (SUB_BUCKETS + bucket % SUB_BUCKETS) * width + width - 1;
+    }
+    return UINT64_MAX;
+}
+__INTERNAL__Server::~__INTERNAL__Server()
+{
+    if (_housekeeping.thread.joinable()) {
+        MutexLock lock (_housekeeping.mutex);
+        _housekeeping.active = false;
+        lock.unlock();
+        _housekeeping.notification.notify_all();
+        _housekeeping.thread.join();
+    }
     
+    // Warm-up tasks reference this server and queue their successors
+    _warming.cancel = true;
+    while (_warming.jobs.load()) std::this_thread::yield();
 }
 void __INTERNAL__Server::listen(uint16_t port)
 {
     _networking->listen(port);
 }
-inline std::unique_ptr<GetResponse> PROCESS_GET_FILE_REQUEST (const std::unique_ptr<GetRequest> &_r, const std::filesystem::path& doc_root)
+ServerStatistics __INTERNAL__Server::get_statistics()
+{
+    MutexLock lock (_retained.mutex);
+    ServerStatistics statistics {
+        .slide_hits         = _counters.slide_hits.load(),
+        .slide_misses       = _counters.slide_misses.load(),
+        .slide_evictions    = _counters.slide_evictions.load(),
+        .slides_retained    = static_cast<uint32_t>(_retained.size()),
+        .bytes_retained     = _retained.bytes,
+        .slides_pinned      = static_cast<uint32_t>(_retained.pinned.size()),
+        .tiles_inline       = _counters.tiles_inline.load(),
+        .tiles_offloaded    = _counters.tiles_offloaded.load(),
+        .tile_latency_p50   = _tile_latency.percentile(0.50),
+        .tile_latency_p99   = _tile_latency.percentile(0.99),
+        .tile_bytes         = _counters.tile_bytes.load(),
+        .bytes_copied       = _counters.bytes_copied.load(),
+    };
+    if (_readahead) _readahead->get_statistics(statistics);
+    return statistics;
+}
+inline GetResponse PROCESS_GET_FILE_REQUEST (const GetFileRequest& request, const std::filesystem::path& doc_root)
 {
-    assert(_r->protocol == GetRequest::GET_REQUEST_FILE && "PROCESS_GET_FILE_REQUEST attempting to interpret GetRequest of invalid type (not GetRequest::GET_REQUEST_FILE)");
     assert(doc_root.empty() == false && "PROCESS_GET_FILE_REQUEST attempting to file serve non-web-server configured Iris RESTful.");
     
-    const auto& request     = *reinterpret_cast<GetFileRequest*>(_r.get());
-    auto response           = std::make_unique<GetFileResponse>();
+    auto path = std::filesystem::path(doc_root.string().append(request.path)).make_preferred();
+    if (std::filesystem::exists(path) == false) return GetErrorResponse {
+        .type       = GetErrorResponse::GET_RESPONSE_FILE_NOT_FOUND,
+        .error_msg  = "File '" + std::string(request.path) + "' not found",
+    };
+    return GetFileResponse {
+        .mime       = std::string(request.mime),
+        .address    = std::move(path),
+    };
+}
+inline GetResponse PROCESS_GET_TILE_REQUEST (const GetTileRequest& request, const Slide &slide)
+{
+    assert(slide && "PROCESS_GET_TILE_REQUEST attempting to interpret GetRequest with invalid slide handle.");
+    
     try {
-        auto path = std::filesystem::path(doc_root.string() + request.path).make_preferred();
-        if (std::filesystem::exists(path) == false) throw std::runtime_error
-            ("File '" + request.path + "' not found");
-        response->type      = GetResponse::GET_RESPONSE_FILE;
-        response->address   = path;
-        response->mime      = request.mime;
+        if (!slide) throw std::runtime_error ("No valid slide file found");
+        return GetTileResponse {
+            .slide      = slide,
+            .tile       = slide->get_tile_entry(request.layer, request.tile),
+            .layer      = request.layer,
+            .index      = request.tile,
+        };
     } catch (std::runtime_error& e) {
-        response->type      = GetResponse::GET_RESPONSE_FILE_NOT_FOUND;
-        response->error_msg = e.what()?e.what():"[undefined error]";
+        return GetErrorResponse {
+            .type       = GetErrorResponse::GET_RESPONSE_FILE_NOT_FOUND,
+            .error_msg  = e.what(),
+        };
     }
-    return response;
 }
-inline std::unique_ptr<GetResponse> PROCESS_GET_TILE_REQUEST (const std::unique_ptr<GetRequest> &_r, const Slide &slide)
+constexpr size_t MAX_TILE_BATCH = 256;
+inline bool PARSE_INDEX_RANGE (const std::string_view& item, uint32_t& first, uint32_t& last)
 {
-    assert(_r->type == GetRequest::GET_REQUEST_TILE && "PROCESS_GET_TILE_REQUEST attempting to interpret GetRequest of invalid type (not GetRequest::GET_REQUEST_TILE)");
-    assert(slide && "PROCESS_GET_TILE_REQUEST attempting to interpret GetRequest with invalid slide handle.");
+    // <a> or <a>-<b> (inclusive)
+    auto dash   = item.find('-');
+    auto a = std::from_chars(item.data(), item.data() + std::min(dash, item.size()), first);
+    if (a.ec != std::errc{} || a.ptr != item.data() + std::min(dash, item.size())) return false;
+    if (dash == std::string_view::npos) last = first;
+    else {
+        auto b = std::from_chars(item.data() + dash + 1, item.data() + item.size(), last);
+        if (b.ec != std::errc{} || b.ptr != item.data() + item.size() || last < first) return false;
+    }
+    return true;
+}
+inline bool EXPAND_TILE_INDICES (std::string_view indices, uint32_t base, std::vector<BatchTile>& tiles)
+{
+    // <a>,<b>,<c>-<d>: ranges are inclusive; the batch size is bounded
+    // so that one request cannot pin an arbitrarily large response.
+    // Indices are numbered from base (DICOMweb frames from 1).
+    while (indices.size()) {
+        auto item   = indices.substr(0, indices.find(','));
+        indices.remove_prefix(std::min(indices.size(), item.size() + 1));
+        uint32_t first = 0, last = 0;
+        if (!PARSE_INDEX_RANGE(item, first, last) || first < base) return false;
+        if (last - first >= MAX_TILE_BATCH - tiles.size()) return false;
+        for (uint64_t index = first; index <= last; ++index)
+            tiles.push_back(BatchTile {.index = static_cast<uint32_t>(index - base)});
+    }
+    return tiles.size();
+}
+inline GetResponse PROCESS_GET_TILE_BATCH_REQUEST (const GetTileBatchRequest& request, const Slide &slide)
+{
+    assert(slide && "PROCESS_GET_TILE_BATCH_REQUEST attempting to interpret GetRequest with invalid slide handle.");
     
-    const auto& request     = *reinterpret_cast<GetTileRequest*>(_r.get());
-    auto response           = std::make_unique<GetTileResponse>();
+    GetTileBatchResponse response {
+        .protocol   = request.protocol,
+        .slide      = slide,
+        .layer      = request.layer,
+    };
+    const uint32_t base = request.protocol == REQUEST_PROTOCOL_DICOM ? 1 : 0;
+    if (!EXPAND_TILE_INDICES(request.indices, base, response.tiles)) return GetErrorResponse {
+        .type       = GetErrorResponse::GET_RESPONSE_MALFORMED_REQ,
+        .error_msg  = base ? "Invalid frame numbers; expected ascending ranges of frames numbered from 1, at most " +
+                             std::to_string(MAX_TILE_BATCH) + " frames in total." :
+                             "Invalid tile batch indices; expected ascending ranges of at most " +
+                             std::to_string(MAX_TILE_BATCH) + " tiles in total.",
+    };
     try {
-        if (!slide) throw std::runtime_error ("No valid slide file found");
-        response->type      = GetResponse::GET_RESPONSE_TILE;
-        response->pixelData = slide->get_tile_entry(request.layer, request.tile);
+        // Only the tile table is consulted; no tile bytes are read here
+        for (auto&& entry : response.tiles)
+            entry.tile = slide->get_tile_entry(request.layer, entry.index);
+        return response;
     } catch (std::runtime_error& e) {
-        response->type      = GetResponse::GET_RESPONSE_FILE_NOT_FOUND;
-        response->error_msg = e.what();
+        return GetErrorResponse {
+            .type       = GetErrorResponse::GET_RESPONSE_FILE_NOT_FOUND,
+            .error_msg  = e.what(),
+        };
     }
-    return response;
 }
-inline std::unique_ptr<GetResponse> PROCESS_GET_METATADATA_REQUEST (const std::unique_ptr<GetRequest> &_r, const Slide &slide)
+constexpr uint32_t TILE_PIXELS = 256; // Iris tiles are 256 x 256 pixels
+constexpr uint64_t MAX_VIEWPORT_TILES = 4096;
+inline GetResponse PROCESS_GET_VIEWPORT_REQUEST (const GetViewportRequest& request, const Slide &slide)
 {
-    assert(_r->type == GetRequest::GET_REQUEST_METADATA && "PROCESS_GET_METATADATA_REQUEST attempting to interpret GetRequest of invalid type (not GetRequest::GET_REQUEST_METADATA)");
-    assert(slide && "PROCESS_GET_METATADATA_REQUEST attempting to interpret GetRequest with invalid slide handle.");
+    assert(slide && "PROCESS_GET_VIEWPORT_REQUEST attempting to interpret GetRequest with invalid slide handle.");
+    
+    auto& layers = slide->get_extent().layers;
+    if (request.layer >= layers.size()) return GetErrorResponse {
+        .type       = GetErrorResponse::GET_RESPONSE_FILE_NOT_FOUND,
+        .error_msg  = "Viewport layer is out of bounds",
+    };
+    auto& layer = layers[request.layer];
     
-    #pragma clang diagnostic push
-    #pragma clang diagnostic ignored "-Wunused"
-    // Ignore for now. May need it later...
-    const auto& request = *reinterpret_cast<GetMetadataRequest*>(_r.get());
-    #pragma clang diagnostic pop
+    // Rectangle in layer pixels, clipped to the layer
+    const double scale  = request.slide_space ? layer.scale : 1.0;
+    const double left   = request.x * scale;
+    const double top    = request.y * scale;
+    const double right  = std::min<double>((request.x + static_cast<double>(request.width))  * scale,
+                                           static_cast<double>(layer.xTiles) * TILE_PIXELS);
+    const double bottom = std::min<double>((request.y + static_cast<double>(request.height)) * scale,
+                                           static_cast<double>(layer.yTiles) * TILE_PIXELS);
+    if (left >= right || top >= bottom) return GetErrorResponse {
+        .type       = GetErrorResponse::GET_RESPONSE_MALFORMED_REQ,
+        .error_msg  = "Viewport does not intersect the layer",
+    };
+    const uint32_t x0   = static_cast<uint32_t>(left / TILE_PIXELS);
+    const uint32_t y0   = static_cast<uint32_t>(top / TILE_PIXELS);
+    const uint32_t x1   = static_cast<uint32_t>(std::ceil(right / TILE_PIXELS));
+    const uint32_t y1   = static_cast<uint32_t>(std::ceil(bottom / TILE_PIXELS));
+    if (static_cast<uint64_t>(x1 - x0) * (y1 - y0) > MAX_VIEWPORT_TILES) return GetErrorResponse {
+        .type       = GetErrorResponse::GET_RESPONSE_MALFORMED_REQ,
+        .error_msg  = "Viewport covers more than " + std::to_string(MAX_VIEWPORT_TILES) +
+                      " tiles; request a lower resolution layer",
+    };
+    
+    // Order the covering tiles by the distance of their centers from the
+    // viewport center. Beyond MAX_TILE_BATCH, the outermost tiles are dropped.
+    const double cx     = (left + right) / 2.0;
+    const double cy     = (top + bottom) / 2.0;
+    std::vector<std::pair<double, uint32_t>> order;
+    order.reserve(static_cast<size_t>(x1 - x0) * (y1 - y0));
+    for (uint32_t y = y0; y < y1; ++y)
+        for (uint32_t x = x0; x < x1; ++x) {
+            const double dx = (x + 0.5) * TILE_PIXELS - cx;
+            const double dy = (y + 0.5) * TILE_PIXELS - cy;
+            order.emplace_back(dx * dx + dy * dy, y * layer.xTiles + x);
+        }
+    const size_t count = std::min(order.size(), MAX_TILE_BATCH);
+    std::partial_sort(order.begin(), order.begin() + count, order.end());
+    
+    GetTileBatchResponse response {
+        .slide      = slide,
+        .layer      = request.layer,
+    };
+    response.tiles.reserve(count);
+    try {
+        for (size_t index = 0; index < count; ++index)
+            response.tiles.push_back(BatchTile {
+                .index  = order[index].second,
+                .tile   = slide->get_tile_entry(request.layer, order[index].second),
+            });
+        return response;
+    } catch (std::runtime_error& e) {
+        return GetErrorResponse {
+            .type       = GetErrorResponse::GET_RESPONSE_FILE_NOT_FOUND,
+            .error_msg  = e.what(),
+        };
+    }
+}
+inline GetResponse PROCESS_GET_METATADATA_REQUEST (const GetMetadataRequest& request, const Slide &slide)
+{
+    assert(slide && "PROCESS_GET_METATADATA_REQUEST attempting to interpret GetRequest with invalid slide handle.");
     
-    auto response       = std::make_unique<GetMetadataResponse>();
     try {
         if (!slide) throw std::runtime_error ("No valid slide file found");
-        response->type      = GetResponse::GET_RESPONSE_METADATA;
-        response->slideInfo = slide->get_slide_info();
+        // DICOM JSON is generated here, on a worker thread, on the first
+        // DICOM metadata request for the slide
+        if (request.protocol == REQUEST_PROTOCOL_DICOM) {
+            auto& dicom = slide->get_dicom_metadata();
+            if (request.instance >= 0 && static_cast<size_t>(request.instance) >= dicom.instances.size())
+                throw std::runtime_error ("DICOM instance is out of bounds");
+        }
+        return GetMetadataResponse {
+            .protocol   = request.protocol,
+            .slide      = slide,
+            .instance   = request.instance,
+        };
     } catch (std::runtime_error& e) {
-        response->type  = GetResponse::GET_RESPONSE_FILE_NOT_FOUND;
-        response->error_msg = e.what();
+        return GetErrorResponse {
+            .type       = GetErrorResponse::GET_RESPONSE_FILE_NOT_FOUND,
+            .error_msg  = e.what(),
+        };
     }
-    return response;
 }
-inline std::unique_ptr<GetResponse> INVALID_SLIDE_IDENTIFIER (std::string& identifier)
+inline GetResponse PROCESS_GET_SLIDE_LIST_REQUEST (const GetSlideListRequest& request, const Catalog& catalog)
 {
-    auto response       = std::make_unique<GetMetadataResponse>();
-    response->type  = GetResponse::GET_RESPONSE_FILE_NOT_FOUND;
-    response->error_msg = "Slide file with identifier '" + identifier + "' not found.";
+    constexpr uint32_t MAX_PAGE = 1000;
+    if (!catalog) return GetErrorResponse {
+        .type       = GetErrorResponse::GET_RESPONSE_FILE_NOT_FOUND,
+        .error_msg  = "This Iris RESTful implementation is not configured with a slide catalog.",
+    };
+    GetSlideListResponse response;
+    catalog->list(request.offset, std::min(request.limit, MAX_PAGE), response);
     return response;
 }
-Slide __INTERNAL__Server::get_slide (const std::string &id)
+constexpr uint32_t WARM_CHUNK = 256; // Tiles prefaulted per warm-up task
+inline bool EXPAND_WARM_LAYERS (std::string_view list, size_t count, std::vector<uint32_t>& layers)
+{
+    // <a>,<b>-<c>: ranges are inclusive; an empty list selects every layer.
+    // Layers are warmed lowest (smallest) first, each once.
+    std::vector<bool> selected (count, list.empty());
+    while (list.size()) {
+        auto item   = list.substr(0, list.find(','));
+        list.remove_prefix(std::min(list.size(), item.size() + 1));
+        uint32_t first = 0, last = 0;
+        if (!PARSE_INDEX_RANGE(item, first, last) || last >= count) return false;
+        for (auto layer = first; layer <= last; ++layer) selected[layer] = true;
+    }
+    for (uint32_t layer = 0; layer < count; ++layer)
+        if (selected[layer]) layers.push_back(layer);
+    return layers.size();
+}
+inline GetResponse INVALID_SLIDE_IDENTIFIER (const std::string_view& identifier)
+{
+    return GetErrorResponse {
+        .type       = GetErrorResponse::GET_RESPONSE_FILE_NOT_FOUND,
+        .error_msg  = "Slide file with identifier '" + std::string(identifier) + "' not found.",
+    };
+}
+Slide __INTERNAL__Server::get_slide (SessionSlides& slides, const std::string_view &id)
+{
+    // The identifier is resolved to its handle once; slides this connection
+    // already uses are then found by handle without probing the directory.
+    // The slide's own reference count is still shared with other connections
+    // serving it, and touching the slide only stores once a second.
+    SlideHandle handle = _directory.handle(id);
+    if (Slide slide = slides.find(handle)) {
+        slide->touch();
+        return slide;
+    }
+    Slide slide = get_slide(id, &handle);
+    if (slide) slides.insert(handle, slide);
+    return slide;
+}
+Slide __INTERNAL__Server::get_slide (const std::string_view &__id, SlideHandle* handle)
 {
     // Let's see if the slide is already open
-    // Look it up in the directory
-    ReadLock read_lock (_directory.mutex);
-    auto __slide = _directory.find(id);
-    if (__slide != _directory.cend()) if
-        (Slide slide = __slide->second.lock())
-            return slide;
-    read_lock.unlock();
+    // Look it up in the directory (lock-free)
+    if (Slide slide = _directory.find(__id, handle)) {
+        ++_counters.slide_hits;
+        slide->touch();
+        retain_slide(slide);
+        return slide;
+    }
+    ++_counters.slide_misses;
+    
+    // Only the (rare) open path needs an owned copy of the identifier
+    const std::string id (__id);
     
     // The slide was not found.
     // We will open a new slide instead.
-    // Create the slide
-    
-    std::filesystem::path file_path (_root.string()+id+".iris");
+    // Create the slide. With a watched catalog, unknown identifiers are
+    // rejected here by a hash probe without touching the file system.
+    std::filesystem::path file_path;
+    if (!_catalog) file_path = _root.string()+id+".iris";
+    else if (!_catalog->find(id, file_path)) return nullptr;
     Slide slide;
-    try { slide = validate_and_open_slide(file_path);}
+    try { slide = validate_and_open_slide(file_path, _cache_dir);}
     catch (std::runtime_error &error) {
         std::string msg = error.what() ? error.what() :
         std::string("[undefined error in file") + __FILE__ + "]";
@@ -199,116 +492,446 @@ Slide __INTERNAL__Server::get_slide (const std::string &id)
         return nullptr;
     }
     
-    // Gain exclusive access to the slide directory and check that
-    // a competing request / thread did not just create one as well
-    ExclusiveLock update_lock (_directory.mutex);
-    __slide = _directory.find(id);
-    if (__slide != _directory.cend()) if
-        (Slide just_made = __slide->second.lock())
-        return just_made;
+    // Add a callback to remove the slide file from the server directory
+    // when it expires. It is set before publishing so that it can never be missed.
+    slide->set_on_destroyed_callback(std::bind(&__INTERNAL__Server::on_slide_destroyed, this, id));
+    
+    // Add the slide unless a competing request / thread just made one as well
+    Slide inserted = _directory.insert(id, slide, handle);
+    if (inserted != slide) return inserted;
+    slide->advise_layers();
+    retain_slide(slide);
+    register_dicom_series(id);
+    return slide;
+}
+void __INTERNAL__Server::register_dicom_series(const std::string &id)
+{
+    // WADO-RS clients address the series by the UID in its metadata
+    auto uid = dicom_uid_root(id) + ".2";
+    ExclusiveLock lock (_dicom_series.mutex);
+    _dicom_series.ids.try_emplace(std::move(uid), id);
+}
+void __INTERNAL__Server::unregister_dicom_series(const std::string &id)
+{
+    ExclusiveLock lock (_dicom_series.mutex);
+    _dicom_series.ids.erase(dicom_uid_root(id) + ".2");
+}
+void __INTERNAL__Server::resolve_dicom_series(GetRequest &request)
+{
+    // Series UIDs of slides opened since the server started, or cataloged,
+    // resolve to their identifier; anything else is taken to be the identifier itself.
+    std::visit([this](auto& request) {
+        if constexpr (requires { request.protocol; request.id; }) {
+            if (request.protocol != REQUEST_PROTOCOL_DICOM || !request.id.starts_with("2.25.")) return;
+            ReadLock lock (_dicom_series.mutex);
+            auto __series = _dicom_series.ids.find(std::string(request.id));
+            if (__series != _dicom_series.ids.end()) request.id = __series->second;
+        }
+    }, request);
+}
+void __INTERNAL__Server::on_slide_destroyed(const std::string &id)
+{
+    // Remove the entry if it is still this (now expired) slide. It may
+    // since have been replaced by a newer slide for the same identifier.
+    _directory.erase_expired(id);
+}
+void __INTERNAL__Server::on_slide_file_changed(const std::string &id, bool removed)
+{
+    // Lost events: re-check every slide that is currently open
+    if (id.empty()) {
+        for (auto&& open_id : _directory.identifiers())
+            on_slide_file_changed(open_id, false);
+        return;
+    }
+    if (removed) unregister_dicom_series(id);
+    
+    std::filesystem::path file_path (_root.string()+id+".iris");
+    Slide current = _directory.find(id);
     
-    // An interviening slide was not made (still no slide there)
-    // so add the just made slide and unlock the exclusive.
-    _directory[id] = slide;
-    update_lock.unlock();
+    // Skip events that did not change the file (the identity includes mtime)
+    if (!removed && current) try {
+        if (get_file_identity(-1, file_path) == current->get_identity()) return;
+    } catch (std::runtime_error&) {
+        removed = true;
+    }
     
-    // Add a callback to remove the slide file from the server directory
-    // when it expires.
-    slide->set_on_destroyed_callback([this, id]() {
-        // Check to see that this is still in the directory
-        ReadLock read_lock (_directory.mutex);
-        auto __slide = _directory.find(id);
-        if  (__slide == _directory.cend()) return;
-        read_lock.unlock();
-        
-        // If it is found, remove it, if this is the entry.
-        ExclusiveLock update_lock (_directory.mutex);
-        if (__slide->second.expired()) _directory.erase(__slide);
+    // Nothing depends on a slide that is neither open nor cataloged
+    if (!current && !_catalog && _cache_dir.empty()) return;
+    
+    // Open and validate the new file. A slide that is not currently open
+    // still needs this for the catalog; it also primes the slide-open cache.
+    Slide replacement;
+    if (!removed) try {
+        replacement = validate_and_open_slide(file_path, _cache_dir);
+        replacement->set_on_destroyed_callback(std::bind(&__INTERNAL__Server::on_slide_destroyed, this, id));
+    } catch (std::runtime_error& error) {
+        if (std::filesystem::exists(file_path)) {
+            std::cerr   << "[WARNING] Changed slide file ("
+                        << id << ") failed to open and was not swapped in: "
+                        << error.what() << "\n";
+            return;
+        }
+        removed = true;
+    }
+    
+    if (_catalog) {
+        if (replacement) _catalog->insert(id, file_path, replacement);
+        else _catalog->erase(id);
+        if (replacement) register_dicom_series(id);
+    }
+    if (!current) return;
+    
+    // Atomically swap the directory entry. In-flight responses hold a reference to
+    // the old slide and finish from its mapping; sessions see the stale flag and
+    // resolve the identifier again on their next request.
+    if (replacement) replacement->advise_layers();
+    _directory.replace(id, current, replacement);
+    current->_stale = true;
+    
+    // Carry the retention over to the new slide
+    MutexLock lock (_retained.mutex);
+    auto __retained = _retained.find(id);
+    if (__retained != _retained.end() && __retained->second == current) {
+        _retained.bytes -= current->get_mapped_bytes();
+        current->_retained = false;
+        if (replacement) {
+            __retained->second = replacement;
+            _retained.bytes += replacement->get_mapped_bytes();
+            replacement->_retained = true;
+        } else _retained.erase(__retained);
+    }
+    auto __pinned = _retained.pinned.find(id);
+    if (__pinned != _retained.pinned.end() && __pinned->second == current) {
+        if (replacement) __pinned->second = replacement;
+        else _retained.pinned.erase(__pinned);
+    }
+    lock.unlock();
+    
+    std::cout   << "[NOTE] Slide " << id << (replacement ? " was replaced" : " was removed")
+                << "; open sessions will move off the previous file\n";
+}
+void __INTERNAL__Server::retain_slide(const Slide &slide)
+{
+    // Retention is disabled
+    if (_retain_slides == 0) return;
+    
+    // Touching an already retained slide is lock free (see __INTERNAL__Slide::touch);
+    // only periodically check for slides that have outlived their time-to-live.
+    if (slide->_retained.load(std::memory_order_relaxed)) {
+        auto now = Time::steady_clock::now().time_since_epoch().count();
+        if (now >= _retained.next_sweep.load(std::memory_order_relaxed))
+            sweep_retained_slides(false);
+        return;
+    }
+    
+    const auto& id = slide->get_id();
+    MutexLock lock (_retained.mutex);
+    auto __retained = _retained.find(id);
+    if (__retained != _retained.end() && __retained->second == slide) return;
+    if (__retained != _retained.end()) {
+        // A different slide instance is retained under this identifier
+        _retained.bytes -= __retained->second->get_mapped_bytes();
+        __retained->second->_retained = false;
+        _retained.erase(__retained);
+    }
+    _retained.emplace(id, slide);
+    _retained.bytes += slide->get_mapped_bytes();
+    slide->_retained = true;
+    lock.unlock();
+    
+    sweep_retained_slides(true);
+}
+void __INTERNAL__Server::housekeeping()
+{
+    // Requests sweep the retained slides as they arrive (see retain_slide);
+    // this closes slides past their time-to-live on an idle server as well.
+    MutexLock lock (_housekeeping.mutex);
+    while (_housekeeping.active) {
+        _housekeeping.notification.wait_for(lock, Time::seconds(1));
+        if (!_housekeeping.active) return;
+        lock.unlock();
+        sweep_retained_slides(false);
+        lock.lock();
+    }
+}
+void __INTERNAL__Server::sweep_retained_slides(bool force)
+{
+    std::vector<Slide> released;
+    MutexLock lock (_retained.mutex, std::defer_lock);
+    if (force) lock.lock();
+    else if (!lock.try_lock()) return;
+    
+    // Schedule the next time-to-live sweep
+    const auto now = Time::steady_clock::now();
+    _retained.next_sweep.store((now + Time::seconds(1)).time_since_epoch().count(),
+                               std::memory_order_relaxed);
+    
+    auto RELEASE = [&](decltype(_retained)::iterator __retained) {
+        _retained.bytes -= __retained->second->get_mapped_bytes();
+        __retained->second->_retained = false;
+        released.push_back(std::move(__retained->second));
+        return _retained.erase(__retained);
+    };
+    
+    // Release slides idle for longer than the time-to-live
+    for (auto __retained = _retained.begin(); __retained != _retained.end();)
+        if (now - __retained->second->last_used() > _retain_ttl)
+            __retained = RELEASE(__retained);
+        else ++__retained;
+    
+    // Then release the least recently used slides until within budget
+    while (_retained.size() > _retain_slides ||
+           (_retain_bytes && _retained.bytes > _retain_bytes)) {
+        auto oldest = _retained.begin();
+        for (auto __retained = _retained.begin(); __retained != _retained.end(); ++__retained)
+            if (__retained->second->last_used() < oldest->second->last_used())
+                oldest = __retained;
+        RELEASE(oldest);
+    }
+    lock.unlock();
+    
+    if (released.empty()) return;
+    _counters.slide_evictions += released.size();
+    
+    // Dropping the last reference unmaps the slide; push that work off
+    // the request thread and onto the server's worker pool.
+    _threads->issue_task([released = std::move(released)]() mutable {
+        released.clear();
     });
-    return slide;
+}
+void __INTERNAL__Server::pin_slide(const Slide& slide, bool pin)
+{
+    // Pinned slides stay open regardless of the retention policy until
+    // unpinned, or until their file is removed.
+    MutexLock lock (_retained.mutex);
+    if (pin) _retained.pinned.insert_or_assign(slide->get_id(), slide);
+    else {
+        auto __pinned = _retained.pinned.find(slide->get_id());
+        if (__pinned != _retained.pinned.end() && __pinned->second == slide)
+            _retained.pinned.erase(__pinned);
+    }
+}
+GetResponse __INTERNAL__Server::process_warm_request(const WarmSlideRequest& request, RequestMethod method)
+{
+    // Warming opens the slide; progress and unpinning only concern open slides
+    Slide slide = method == REQUEST_METHOD_POST ? get_slide(request.id) : _directory.find(request.id);
+    if (!slide && method == REQUEST_METHOD_POST) return INVALID_SLIDE_IDENTIFIER(request.id);
+    if (!slide) return GetErrorResponse {
+        .type       = GetErrorResponse::GET_RESPONSE_FILE_NOT_FOUND,
+        .error_msg  = "Slide with identifier '" + std::string(request.id) + "' is not open.",
+    };
+    
+    bool pinned = method == REQUEST_METHOD_POST;
+    if (method == REQUEST_METHOD_POST) {
+        std::vector<uint32_t> layers;
+        const auto count = slide->get_extent().layers.size();
+        if (!EXPAND_WARM_LAYERS(request.layers, count, layers)) return GetErrorResponse {
+            .type       = GetErrorResponse::GET_RESPONSE_MALFORMED_REQ,
+            .error_msg  = "Invalid warm-up layers; expected layer ranges within the slide's " +
+                          std::to_string(count) + " layers.",
+        };
+        pin_slide(slide, true);
+        warm_slide(slide, std::move(layers));
+    } else if (method == REQUEST_METHOD_DELETE) {
+        pin_slide(slide, false);
+    } else {
+        MutexLock lock (_retained.mutex);
+        auto __pinned = _retained.pinned.find(slide->get_id());
+        pinned = __pinned != _retained.pinned.end() && __pinned->second == slide;
+    }
+    
+    auto& progress = slide->get_warm_progress();
+    return WarmSlideResponse {
+        .id             = slide->get_id(),
+        .pinned         = pinned,
+        .warming        = progress.active.load(),
+        .tiles          = progress.tiles.load(),
+        .tiles_warmed   = progress.tiles_warmed.load(),
+        .bytes          = progress.bytes.load(),
+        .bytes_warmed   = progress.bytes_warmed.load(),
+    };
+}
+void __INTERNAL__Server::warm_slide(const Slide& slide, std::vector<uint32_t>&& layers)
+{
+    // One warm-up per slide at a time; a request while one is running only
+    // reports its progress. A new warm-up starts its progress afresh.
+    auto& progress = slide->_warm;
+    if (progress.active.exchange(true)) return;
+    progress.tiles          = 0;
+    progress.tiles_warmed   = 0;
+    progress.bytes          = 0;
+    progress.bytes_warmed   = 0;
+    
+    ++_warming.jobs;
+    warm_tiles(slide, std::move(layers), 0, 0, true);
+}
+void __INTERNAL__Server::warm_tiles(const Slide& slide, std::vector<uint32_t>&& layers, size_t layer,
+                                    uint32_t tile, bool counting)
+{
+    // One chunk of tiles per task. Each task queues the next behind the
+    // requests waiting on the pool so that a warm-up never starves them.
+    // The layers are first counted (the progress totals), then warmed.
+    _threads->issue_task([this, slide, layers = std::move(layers), layer, tile, counting]() mutable {
+        auto& progress      = slide->_warm;
+        auto& extent        = slide->get_extent().layers[layers[layer]];
+        const uint32_t count= extent.xTiles * extent.yTiles;
+        const uint32_t last = std::min(count, tile + WARM_CHUNK);
+        for (; tile < last; ++tile) try {
+            if (!counting) { slide->warm_tile(layers[layer], tile); continue; }
+            progress.bytes += slide->get_tile_entry(layers[layer], tile).size;
+            ++progress.tiles;
+        } catch (std::runtime_error&) { continue; }
+        if (tile == count) {
+            tile = 0;
+            ++layer;
+        }
+        if (layer == layers.size() && counting) {
+            layer       = 0;
+            counting    = false;
+        }
+        if (layer < layers.size() && !slide->is_stale() && !_warming.cancel)
+            return warm_tiles(slide, std::move(layers), layer, tile, counting);
+        if (layer == layers.size())
+            std::cout   << "[NOTE] Slide " << slide->get_id() << " warmed: "
+                        << progress.tiles_warmed.load() << " tiles, "
+                        << (progress.bytes_warmed.load() >> 20) << " MB resident\n";
+        progress.active = false;
+        --_warming.jobs;
+    });
+}
+template <class Session_>
+bool __INTERNAL__Server::serve_resident_tile(const Session_& session, GetResponseHandler& on_response,
+                                             Time::steady_clock::time_point received)
+{
+    // Called on the reactor thread: nothing here may block. Slides are only
+    // resolved within the session (no directory insertion or retention
+    // sweep) and tile bytes must already be in the page cache.
+    if (session->request.method != REQUEST_METHOD_GET) return false;
+    const auto request  = parse_get_request (session->request.target);
+    auto __request      = std::get_if<GetTileRequest>(&request);
+    if (!__request) return false;
+    auto slide          = session->slides.find(_directory.handle(__request->id));
+    if (!slide) return false;
+    
+    // Errors (out of bounds) are reported by the worker path
+    const uint32_t layer = __request->layer, index = __request->tile;
+    TileData tile;
+    try { tile = slide->get_tile_entry(layer, index); }
+    catch (std::runtime_error&) { return false; }
+    if (!slide->is_resident(tile)) return false;
+    slide->touch();
+    
+    on_response(GetTileResponse {
+        .slide  = slide,
+        .tile   = tile,
+        .layer  = layer,
+        .index  = index,
+    });
+    _tile_latency.record(Time::steady_clock::now() - received);
+    ++_counters.tiles_inline;
+    if (_readahead) _readahead->on_tile_served(slide, layer, index, session->motion);
+    return true;
 }
 template <class Session_>
-void __INTERNAL__Server::on_get_request(const Session_& session,
-                                        const std::string& target,
-                                        const std::function<void(const std::unique_ptr<GetResponse>&)> on_response)
+void __INTERNAL__Server::on_get_request(const Session_& session, GetResponseHandler&& on_response)
 {
+    // Page cache resident tiles may be served without leaving the reactor
+    const auto received = Time::steady_clock::now();
+    if (_dispatch == REQUEST_DISPATCH_INLINE && serve_resident_tile(session, on_response, received))
+        return;
+    
+    // The handler is parked in the session's in-flight request storage; a
+    // connection has a single request in flight, and the worker task then
+    // only needs to capture the session itself.
+    session->request.on_response = std::move(on_response);
+    
     // Push the processing of requests off the network stack onto the
     // server's response stack. This confines the activities of the io_context
     // reactor threads (controlled by NetworkingTS/ASIO) only to networking tasks.
-    _threads->issue_task([this, session, target, on_response](){
-        // Parse the get request target sequence
-        auto request    = parse_get_request (target);
-        auto response   = std::make_unique<GetResponse>();
+    _threads->issue_task([this, session, received](){
+        // Parse the get request target sequence. The request
+        // references the session's target string (no copies are made).
+        auto request        = parse_get_request (session->request.target);
+        resolve_dicom_series(request);
+        auto respond        = [&session](GetResponse&& response) {
+            // Release the handler slot before invoking; the handler may start
+            // the next read on this session, which will park a new handler.
+            auto on_response = std::move(session->request.on_response);
+            on_response(std::move(response));
+        };
+        
+        // POST and DELETE are only defined for the slide warm-up API
+        if (auto __request = std::get_if<WarmSlideRequest>(&request)) {
+            if (!_warm_api) return respond(GetErrorResponse {
+                .type       = GetErrorResponse::GET_RESPONSE_FILE_NOT_FOUND,
+                .error_msg  = "This Iris RESTful implementation is not configured with the slide warm-up API.",
+            });
+            return respond(process_warm_request(*__request, session->request.method));
+        }
+        if (session->request.method != REQUEST_METHOD_GET) return respond(GetErrorResponse {
+            .type       = GetErrorResponse::GET_RESPONSE_METHOD_NOT_ALLOWED,
+            .error_msg  = "Only the slide warm-up API accepts POST and DELETE requests.",
+        });
         
         // Ensure it follows a supported RESTful API
         //  -- Currently that's IrisRESTful and WADO-RS
         //  -- OPTIONALLY that includes a webserver / file server
-        switch (request->protocol) {
-            // Are we attempting to use Iris RESTFUL as a webserver as well
-            // to avoid Cross Origin serving?
-            case GetRequest::GET_REQUEST_FILE:/* OPTIONAL must be activated */
-                if(_doc_root.empty()) {
-                    response->type = GetMetadataResponse::GET_RESPONSE_FILE_NOT_FOUND;
-                    response->error_msg =
-                    "This Iris RESTful implementation is not configured to run as a web server / file server.";
-                    return on_response(response);
-                } else return on_response(PROCESS_GET_FILE_REQUEST(request, _doc_root));
-                
-                
-            // Standard IRIS or DICOM Requests
-            case GetRequest::GET_REQUEST_IRIS:  break;
-            case GetRequest::GET_REQUEST_DICOM: break;
-            
-            // Anything else is considered malformed
-            case GetRequest::GET_REQUEST_MALFORMED:
-            default: goto MALFORMED_REQUEST;
+        if (auto __request = std::get_if<GetTileRequest>(&request)) {
+            auto slide = get_slide(session->slides, __request->id);
+            if (!slide) return respond(INVALID_SLIDE_IDENTIFIER(__request->id));
+            auto response = PROCESS_GET_TILE_REQUEST(*__request, slide);
+            const bool served = std::holds_alternative<GetTileResponse>(response);
+            respond(std::move(response));
+            _tile_latency.record(Time::steady_clock::now() - received);
+            ++_counters.tiles_offloaded;
+            // Follow the served tile once its response is on its way
+            if (_readahead && served) _readahead->on_tile_served
+                (slide, __request->layer, __request->tile, session->motion);
+            return;
         }
+        if (auto __request = std::get_if<GetTileBatchRequest>(&request)) {
+            auto slide = get_slide(session->slides, __request->id);
+            if (!slide) return respond(INVALID_SLIDE_IDENTIFIER(__request->id));
+            return respond(PROCESS_GET_TILE_BATCH_REQUEST(*__request, slide));
+        }
+        if (auto __request = std::get_if<GetViewportRequest>(&request)) {
+            auto slide = get_slide(session->slides, __request->id);
+            if (!slide) return respond(INVALID_SLIDE_IDENTIFIER(__request->id));
+            return respond(PROCESS_GET_VIEWPORT_REQUEST(*__request, slide));
+        }
+        if (auto __request = std::get_if<GetMetadataRequest>(&request)) {
+            auto slide = get_slide(session->slides, __request->id);
+            if (!slide) return respond(INVALID_SLIDE_IDENTIFIER(__request->id));
+            return respond(PROCESS_GET_METATADATA_REQUEST(*__request, slide));
+        }
+        if (auto __request = std::get_if<GetSlideListRequest>(&request))
+            return respond(PROCESS_GET_SLIDE_LIST_REQUEST(*__request, _catalog));
         
-        // Check to see what is requested
-        switch (request->type) {
-
-            case GetRequest::GET_REQUEST_TILE: {
-                auto& __request = *reinterpret_cast<GetTileRequest*>(request.get());
-                if (!session->slide || *(session->slide) != __request.id) {
-                    session->slide = get_slide(__request.id);
-                    if (!session->slide) {
-                        on_response(INVALID_SLIDE_IDENTIFIER(__request.id));
-                        return;
-                    }
-                }
-                on_response(PROCESS_GET_TILE_REQUEST(request, session->slide));
-                return;
-            }
-                
-                
-            case GetRequest::GET_REQUEST_METADATA: {
-                auto& __request = *reinterpret_cast<GetTileRequest*>(request.get());
-                if (!session->slide || *(session->slide) != __request.id) {
-                    session->slide = get_slide(__request.id);
-                    if (!session->slide) {
-                        on_response(INVALID_SLIDE_IDENTIFIER(__request.id));
-                        return;
-                    }
-                }
-                on_response(PROCESS_GET_METATADATA_REQUEST(request, session->slide));
-                return;
-            }
-                
-            case GetRequest::GET_REQUEST_UNDEFINED:
-            default: goto MALFORMED_REQUEST;
+        // Are we attempting to use Iris RESTFUL as a webserver as well
+        // to avoid Cross Origin serving? (OPTIONAL must be activated)
+        if (auto __request = std::get_if<GetFileRequest>(&request)) {
+            if (!_doc_root.empty())
+                return respond(PROCESS_GET_FILE_REQUEST(*__request, _doc_root));
+            return respond(GetErrorResponse {
+                .type       = GetErrorResponse::GET_RESPONSE_FILE_NOT_FOUND,
+                .error_msg  = "This Iris RESTful implementation is not configured to run as a web server / file server.",
+            });
         }
         
-        MALFORMED_REQUEST:
-        response->type  = GetResponse::GET_RESPONSE_MALFORMED_REQ;
-        response->error_msg = request->error_msg.size()?request->error_msg:
-        "Undefined GET request error. IrisRESTful server did elaborate on what happened.";
-        on_response (response);
+        // Anything else is considered malformed
+        auto& malformed = std::get<GetMalformedRequest>(request);
+        respond(GetErrorResponse {
+            .type       = GetErrorResponse::GET_RESPONSE_MALFORMED_REQ,
+            .error_msg  = std::string(malformed.error_msg),
+        });
     });
 }
 // Generate the implementations for Sessions and TLS Sessions
 template void __INTERNAL__Server::on_get_request <Session>
- (const Session&,  const std::string&, const std::function<void(const std::unique_ptr<GetResponse>&)>);
+ (const Session&, GetResponseHandler&&);
 template void __INTERNAL__Server::on_get_request <SslSession>
- (const SslSession &, const std::string &, const std::function<void (const std::unique_ptr<GetResponse> &)>);
+ (const SslSession&, GetResponseHandler&&);
+template void __INTERNAL__Server::on_get_request <KtlsSession>
+ (const KtlsSession&, GetResponseHandler&&);
 } // END RESTFUL
 } // END IRIS
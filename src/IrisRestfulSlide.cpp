@@ -9,48 +9,282 @@
  * 
  */
 
+#include <ctime>
+#include <charconv>
 #include "IrisRestfulPriv.hpp"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
 
-Iris::RESTful::Slide Iris::RESTful::validate_and_open_slide (const std::filesystem::path &file_path)
+namespace Iris {
+namespace RESTful {
+using namespace IrisCodec;
+inline int OPEN_READ_DESCRIPTOR (const std::filesystem::path& file_path)
 {
-    using namespace IrisCodec;
-    
-    if (!std::filesystem::exists(file_path)) throw std::runtime_error
-        (std::string("File (")+file_path.string()+ std::string(") does not exist"));
+    // A separate read-only descriptor allows the kernel to transfer tile
+    // byte ranges directly to a socket (see send_tile_range). This is
+    // optional; failure only disables the sendfile delivery path.
+    #ifndef _WIN32
+    return ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+    #else
+    return -1;
+    #endif
+}
+inline void CLOSE_READ_DESCRIPTOR (int fd)
+{
+    #ifndef _WIN32
+    if (fd > -1) ::close(fd);
+    #endif
+}
+constexpr uint64_t LOW_RESOLUTION_BYTES = 64ULL << 20; // Low resolution layers read ahead at open
+inline void MADVISE_RANGE (const BYTE* base, uint64_t front, uint64_t back, int advice)
+{
+    #ifndef _WIN32
+    static const uint64_t PAGE = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    front &= ~(PAGE - 1);
+    if (back > front) madvise(const_cast<BYTE*>(base) + front, back - front, advice);
+    #endif
+}
+inline void ADVISE_LAYERS (const File& file, const SlideTileTable& table)
+{
+    // Low resolution layers (overview, thumbnails) are requested by every
+    // viewer and small: read them ahead (MADV_WILLNEED), lowest first, up to
+    // LOW_RESOLUTION_BYTES. Tiles of the larger layers are requested sparsely:
+    // MADV_RANDOM stops each fault from reading ahead of the tile it needs.
+    #ifndef _WIN32
+    uint64_t budget = LOW_RESOLUTION_BYTES;
+    bool low        = true;
+    for (size_t layer = 0; layer + 1 < table.layers.size(); ++layer) {
+        uint64_t front = UINT64_MAX, back = 0;
+        for (auto index = table.layers[layer]; index < table.layers[layer + 1]; ++index) {
+            auto& entry = table.entries[index];
+            front   = std::min(front, entry.offset);
+            back    = std::max(back, entry.offset + entry.size);
+        }
+        if (back <= front || back > file->size) continue;
+        low = low && back - front <= budget;
+        if (low) budget -= back - front;
+        MADVISE_RANGE(file->ptr, front, back, low ? MADV_WILLNEED : MADV_RANDOM);
+    }
+    #endif
+}
+inline SlideTileTable BUILD_TILE_TABLE (const Abstraction::File& abstraction)
+{
+    auto& ttable    = abstraction.tileTable;
+    SlideTileTable table {
+        .format     = ttable.format,
+        .encoding   = ttable.encoding,
+        .extent     = ttable.extent,
+    };
+    size_t tiles    = 0;
+    for (auto&& layer : ttable.layers) tiles += layer.size();
+    table.layers.reserve(ttable.layers.size() + 1);
+    table.entries.reserve(tiles);
+    for (auto&& layer : ttable.layers) {
+        table.layers.push_back(static_cast<uint32_t>(table.entries.size()));
+        for (auto&& tile : layer) table.entries.push_back(SlideTileEntry {
+            .offset = static_cast<uint64_t>(tile.offset),
+            .size   = static_cast<uint32_t>(tile.size),
+        });
+    }
+    table.layers.push_back(static_cast<uint32_t>(table.entries.size()));
+    return table;
+}
+inline std::string FORMAT_ETAG (const std::string& body, const std::string_view& suffix = {})
+{
+    // Strong ETag of a serialized body: "<FNV-1a hex><suffix>"
+    char hash[16];
+    auto end = std::to_chars(hash, hash + sizeof(hash), FNV1A_64(body.data(), body.size()), 16).ptr;
+    std::string etag;
+    etag.reserve(20 + suffix.size());
+    etag.append("\"").append(hash, end).append(suffix).append("\"");
+    return etag;
+}
+inline SlideMetadata BUILD_SLIDE_METADATA (std::string&& json)
+{
+    SlideMetadata metadata {
+        .json       = std::move(json),
+    };
+    metadata.etag   = FORMAT_ETAG(metadata.json);
     
-    auto file = open_file(FileOpenInfo {
-        .filePath = file_path,
-        .writeAccess = false,
-    });
-    if (!file) throw std::runtime_error
-        ("Failed to open file");
+    // Metadata with many attributes compresses well; skip it when it does not.
+    auto gzip = compress_gzip(metadata.json);
+    if (gzip.size() && gzip.size() < metadata.json.size()) {
+        metadata.gzip       = std::move(gzip);
+        metadata.gzip_etag  = FORMAT_ETAG(metadata.json, "-gzip");
+    }
+    return metadata;
+}
+inline DicomMetadata BUILD_DICOM_METADATA (std::vector<std::string>&& objects)
+{
+    DicomMetadata dicom;
+    size_t length = 2;
+    for (auto&& object : objects) length += object.size() + 1;
+    dicom.series.reserve(length);
+    dicom.series += '[';
+    for (auto&& object : objects) {
+        if (dicom.series.size() > 1) dicom.series += ',';
+        dicom.series.append(object);
+        dicom.instances.push_back('[' + std::move(object) + ']');
+        dicom.instance_etags.push_back(FORMAT_ETAG(dicom.instances.back()));
+    }
+    dicom.series += ']';
+    dicom.series_etag = FORMAT_ETAG(dicom.series);
+    return dicom;
+}
+inline SlideValidators BUILD_SLIDE_VALIDATORS (const FileIdentity& identity)
+{
+    SlideValidators validators;
+    const uint64_t fields[4] = {identity.device, identity.inode, identity.size,
+                                static_cast<uint64_t>(identity.modified)};
+    char hash[16];
+    auto end = std::to_chars(hash, hash + sizeof(hash),
+                             FNV1A_64(reinterpret_cast<const char*>(fields), sizeof(fields)), 16).ptr;
+    validators.tag.assign(hash, end);
     
+    #ifndef _WIN32
+    // The Windows identity holds file clock ticks rather than Unix time;
+    // the ETag alone validates there.
+    const time_t modified = static_cast<time_t>(identity.modified / 1000000000LL);
+    struct tm time;
+    char date[32];
+    if (gmtime_r(&modified, &time) &&
+        strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", &time)) {
+        validators.last_modified    = date;
+        validators.modified         = static_cast<int64_t>(modified);
+    }
+    #endif
+    return validators;
+}
+inline std::shared_ptr<const Abstraction::File> LOAD_SLIDE_TABLE (const File& file, const FileIdentity& identity,
+                                          const std::filesystem::path& cache_dir,
+                                          SlideTileTable& table, std::string& metadata)
+{
     auto ptr    = file->ptr;
     auto size   = file->size;
     if (!IrisCodec::is_Iris_Codec_file(ptr, size)) throw std::runtime_error
         ("Not an Iris slide file");
     
+    // An up-to-date cache entry means this exact file already passed
+    // validation; skip straight to serving from its tile table.
+    if (identity.size == size && read_slide_cache(cache_dir, identity, table, metadata))
+        return nullptr;
+    
     // Validate the file structure
     auto result = IrisCodec::validate_file_structure(ptr, size);
     if (result & IRIS_FAILURE) throw std::runtime_error
         ("File failed validation: " + result.message);
     
-    // Return the new Iris File
-    return std::make_shared<__INTERNAL__Slide>(file);
+    // Abstract the file and record the compact tile table
+    // and serialized metadata for next time
+    auto abstraction = std::make_shared<const Abstraction::File>
+    (abstract_file_structure(ptr, size));
+    table = BUILD_TILE_TABLE(*abstraction);
+    metadata = serialize_slide_metadata(SlideInfo {
+        .format     = table.format,
+        .encoding   = table.encoding,
+        .extent     = table.extent,
+        .metadata   = abstraction->metadata,
+    });
+    if (identity.size == size)
+        write_slide_cache(cache_dir, identity, table, metadata);
+    return abstraction;
 }
-
-namespace Iris {
-namespace RESTful {
-using namespace IrisCodec;
-__INTERNAL__Slide::__INTERNAL__Slide(const File &file) :
-_file                   (file),
-_abstraction            (abstract_file_structure(file->ptr, file->size)),
-_remove_from_server_dir (nullptr)
+void validate_slide (const std::filesystem::path& file_path, const std::filesystem::path& cache_dir,
+                     uint64_t& bytes, Extent& extent)
 {
+    if (!std::filesystem::exists(file_path)) throw std::runtime_error
+        (std::string("File (")+file_path.string()+ std::string(") does not exist"));
     
+    auto file = open_file(FileOpenInfo {
+        .filePath = file_path,
+        .writeAccess = false,
+    });
+    if (!file) throw std::runtime_error
+        ("Failed to open file");
+    #ifndef _WIN32
+    const auto identity = get_file_identity(fileno(file->handle), file_path);
+    #else
+    const auto identity = get_file_identity(-1, file_path);
+    #endif
+    
+    SlideTileTable table;
+    std::string metadata;
+    LOAD_SLIDE_TABLE(file, identity, cache_dir, table, metadata);
+    bytes   = file->size;
+    extent  = std::move(table.extent);
+}
+Slide validate_and_open_slide (const std::filesystem::path &file_path, const std::filesystem::path& cache_dir)
+{
+    if (!std::filesystem::exists(file_path)) throw std::runtime_error
+        (std::string("File (")+file_path.string()+ std::string(") does not exist"));
+    
+    // The descriptor (used for sendfile) and the mapping are opened by path
+    // separately. If the path is replaced between the two, they would refer
+    // to different files: compare the identity of the mapped file against
+    // the descriptor's and reopen both on a mismatch.
+    constexpr int OPEN_ATTEMPTS = 3;
+    int fd = -1;
+    FileIdentity identity;
+    File file = nullptr;
+    for (int attempt = 0; attempt < OPEN_ATTEMPTS && !file; ++attempt) {
+        fd = OPEN_READ_DESCRIPTOR(file_path);
+        try {
+            identity = get_file_identity(fd, file_path);
+            file = open_file(FileOpenInfo {
+                .filePath = file_path,
+                .writeAccess = false,
+            });
+            if (!file) throw std::runtime_error
+                ("Failed to open file");
+            #ifndef _WIN32
+            if (get_file_identity(fileno(file->handle), file_path) != identity) file = nullptr;
+            #endif
+        } catch (...) {
+            CLOSE_READ_DESCRIPTOR(fd);
+            throw;
+        }
+        if (!file) CLOSE_READ_DESCRIPTOR(fd);
+    }
+    if (!file) throw std::runtime_error
+        ("Slide file (" + file_path.string() + ") was replaced repeatedly while being opened");
+    try {
+        SlideTileTable table;
+        std::string metadata;
+        auto abstraction = LOAD_SLIDE_TABLE(file, identity, cache_dir, table, metadata);
+        return std::make_shared<__INTERNAL__Slide>(file_path.stem().string(), file, fd, identity,
+                                                   std::move(table), std::move(metadata), abstraction);
+    } catch (...) {
+        CLOSE_READ_DESCRIPTOR(fd);
+        throw;
+    }
+}
+__INTERNAL__Slide::__INTERNAL__Slide(const std::string& id, const File &file, int fd, const FileIdentity& identity,
+                                     SlideTileTable&& table, std::string&& metadata_json,
+                                     const SlideAbstraction& abstraction) :
+_id                     (id),
+_file                   (file),
+_fd                     (fd),
+_identity               (identity),
+_table                  (std::move(table)),
+_metadata               (BUILD_SLIDE_METADATA(std::move(metadata_json))),
+_validators             (BUILD_SLIDE_VALIDATORS(identity)),
+_abstraction            (abstraction),
+_prefetched             (std::make_unique<std::atomic<uint64_t>[]>((_table.entries.size() + 31) / 32)),
+_prefetch_epoch         (Time::steady_clock::now().time_since_epoch().count()),
+_warm                   (),
+_remove_from_server_dir (nullptr),
+_last_used              (Time::steady_clock::now().time_since_epoch().count()),
+_retained               (false),
+_stale                  (false)
+{
+
 }
 __INTERNAL__Slide::~__INTERNAL__Slide()
 {
+    CLOSE_READ_DESCRIPTOR(_fd);
     if (_remove_from_server_dir)
         _remove_from_server_dir ();
 }
@@ -58,37 +292,226 @@ void __INTERNAL__Slide::set_on_destroyed_callback(const std::function<void()> on
 {
     _remove_from_server_dir = on_destroyed;
 }
-bool __INTERNAL__Slide::operator!=(std::string &id) const
+int __INTERNAL__Slide::get_file_descriptor() const
+{
+    return _fd;
+}
+void __INTERNAL__Slide::touch()
+{
+    // Every request touches its slide; only store (and so take the cache line
+    // from the other cores reading it) when the stamp is a TOUCH_INTERVAL old.
+    // Retention and the governor age slides in tens of seconds.
+    const auto now = Time::steady_clock::now().time_since_epoch().count();
+    if (now - _last_used.load(std::memory_order_relaxed) >=
+        Time::steady_clock::duration(TOUCH_INTERVAL).count())
+        _last_used.store(now, std::memory_order_relaxed);
+}
+bool __INTERNAL__Slide::is_stale() const
+{
+    return _stale.load(std::memory_order_relaxed);
+}
+Time::steady_clock::time_point __INTERNAL__Slide::last_used() const
+{
+    return Time::steady_clock::time_point
+    (Time::steady_clock::duration(_last_used.load(std::memory_order_relaxed)));
+}
+void __INTERNAL__Slide::advise_layers() const
+{
+    ADVISE_LAYERS(_file, _table);
+}
+size_t __INTERNAL__Slide::get_mapped_bytes() const
+{
+    return _file->size;
+}
+uint64_t __INTERNAL__Slide::release_pages() const
+{
+    // Count the slide's resident pages, then have the kernel reclaim them
+    // (MADV_PAGEOUT), or at least reclaim them first (MADV_COLD). Later tile
+    // reads simply fault the pages back in.
+    #ifndef _WIN32
+    static const size_t PAGE = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    #if defined(__APPLE__)
+    std::vector<char> residency ((_file->size + PAGE - 1) / PAGE);
+    #else
+    std::vector<unsigned char> residency ((_file->size + PAGE - 1) / PAGE);
+    #endif
+    uint64_t resident = 0;
+    if (residency.size() && mincore(_file->ptr, _file->size, residency.data()) == 0)
+        for (auto page : residency) resident += page & 1;
+    // Tiles advised before now are no longer resident; let them be advised again
+    reset_prefetched();
+    #if defined(MADV_PAGEOUT)
+    madvise(_file->ptr, _file->size, MADV_PAGEOUT);
+    #elif defined(MADV_COLD)
+    madvise(_file->ptr, _file->size, MADV_COLD);
+    #else
+    madvise(_file->ptr, _file->size, MADV_DONTNEED);
+    #endif
+    return resident * PAGE;
+    #else
+    return 0;
+    #endif
+}
+bool __INTERNAL__Slide::is_resident(const TileData& tile) const
+{
+    // Whether reading the tile's bytes would not fault to storage. Tiles
+    // spanning more than MAX_PAGES pages are reported as not resident.
+    #ifndef _WIN32
+    constexpr size_t MAX_PAGES = 64;
+    static const uintptr_t PAGE = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    if (!tile.data || !tile.size) return false;
+    auto front = reinterpret_cast<uintptr_t>(tile.data) & ~(PAGE - 1);
+    auto back  = reinterpret_cast<uintptr_t>(tile.data) + tile.size;
+    if (back - front > MAX_PAGES * PAGE) return false;
+    #if defined(__APPLE__)
+    char residency[MAX_PAGES];
+    #else
+    unsigned char residency[MAX_PAGES];
+    #endif
+    if (mincore(reinterpret_cast<void*>(front), back - front, residency)) return false;
+    for (size_t page = 0; page < (back - front + PAGE - 1) / PAGE; ++page)
+        if (!(residency[page] & 1)) return false;
+    return true;
+    #else
+    return false;
+    #endif
+}
+const FileIdentity& __INTERNAL__Slide::get_identity() const
+{
+    return _identity;
+}
+const Extent& __INTERNAL__Slide::get_extent() const
+{
+    return _table.extent;
+}
+bool __INTERNAL__Slide::operator!=(const std::string &id) const
 {
     return _id.compare(id);
 }
+const std::string& __INTERNAL__Slide::get_id() const
+{
+    return _id;
+}
 SlideInfo __INTERNAL__Slide::get_slide_info() const
 {
+    // Slides opened from the cache defer abstraction until metadata is asked for
+    std::call_once(_abstraction_flag, [this]() {
+        if (!_abstraction) _abstraction = std::make_shared<const Abstraction::File>
+            (abstract_file_structure(_file->ptr, _file->size));
+    });
     return SlideInfo {
-        .format         = _abstraction.tileTable.format,
-        .encoding       = _abstraction.tileTable.encoding,
-        .extent         = _abstraction.tileTable.extent,
-        .metadata       = _abstraction.metadata,
+        .format         = _table.format,
+        .encoding       = _table.encoding,
+        .extent         = _table.extent,
+        .metadata       = _abstraction->metadata,
     };
 }
-Buffer __INTERNAL__Slide::get_tile_entry (uint32_t layer, uint32_t tile_indx) const
+const SlideMetadata& __INTERNAL__Slide::get_metadata() const
+{
+    return _metadata;
+}
+const SlideValidators& __INTERNAL__Slide::get_validators() const
+{
+    return _validators;
+}
+const DicomMetadata& __INTERNAL__Slide::get_dicom_metadata() const
+{
+    // Most deployments never use WADO-RS; build it on the first DICOM request
+    std::call_once(_dicom_flag, [this]() {
+        _dicom = BUILD_DICOM_METADATA(serialize_dicom_instances(get_slide_info(), dicom_uid_root(_id)));
+    });
+    return _dicom;
+}
+TileData __INTERNAL__Slide::get_tile_entry (uint32_t layer, uint32_t tile_indx) const
 {
     ReadLock lock (_file->resize);
     
     // Pull the extent and check that the layer in within info
-    auto& ttable = _abstraction.tileTable;
-    auto& layers = ttable.layers;
-    if (layer >= layers.size()) throw std::runtime_error
+    auto& layers = _table.layers;
+    if (layer + 1 >= layers.size()) throw std::runtime_error
         ("layer in SlideTileReadInfo is out of bounds");
     
     // Pull the layer extent and check that the tile is within info
-    auto& tiles = layers[layer];
-    if (tile_indx >= tiles.size()) throw std::runtime_error
+    if (tile_indx >= layers[layer+1] - layers[layer]) throw std::runtime_error
         ("tile in SLideTileReadInfo is out of layer bounds");
     
-    // Get the offset and size of the tile entry
-    auto& entry = tiles[tile_indx];
-    return Iris::Copy_strong_buffer_from_data(_file->ptr + entry.offset, entry.size);
+    // Get the offset and size of the tile entry. Return a view into
+    // the mapping rather than copying the bytes out; slides are opened
+    // read-only so the mapping is never resized while the slide lives.
+    // The caller must keep this slide alive until the view is consumed.
+    auto& entry = _table.entries[layers[layer] + tile_indx];
+    return TileData {
+        .data           = _file->ptr + entry.offset,
+        .offset         = entry.offset,
+        .size           = entry.size,
+    };
+}
+inline bool ENTRY_INDEX (const SlideTileTable& table, uint32_t layer, uint32_t tile_indx, size_t& index)
+{
+    if (layer + 1 >= table.layers.size() ||
+        tile_indx >= table.layers[layer + 1] - table.layers[layer]) return false;
+    index = table.layers[layer] + tile_indx;
+    return true;
+}
+void __INTERNAL__Slide::reset_prefetched() const
+{
+    _prefetch_epoch.store(Time::steady_clock::now().time_since_epoch().count(),
+                          std::memory_order_relaxed);
+    for (size_t word = 0; word < (_table.entries.size() + 31) / 32; ++word)
+        _prefetched[word].store(0, std::memory_order_relaxed);
+}
+bool __INTERNAL__Slide::flag_prefetched(uint32_t layer, uint32_t tile_indx, PrefetchKind kind) const
+{
+    // True if the tile was not already flagged
+    size_t index;
+    if (!ENTRY_INDEX(_table, layer, tile_indx, index)) return false;
+    
+    // Flags from an earlier epoch are dropped, whether or not their tiles were
+    // served: advised pages not read since may well have been evicted.
+    const auto now  = Time::steady_clock::now().time_since_epoch().count();
+    auto epoch      = _prefetch_epoch.load(std::memory_order_relaxed);
+    if (now - epoch >= Time::steady_clock::duration(PREFETCH_EPOCH).count() &&
+        _prefetch_epoch.compare_exchange_strong(epoch, now, std::memory_order_relaxed))
+        reset_prefetched();
+    
+    auto& word          = _prefetched[index / 32];
+    const auto shift    = (index % 32) * 2;
+    uint64_t value      = word.load(std::memory_order_relaxed);
+    do if ((value >> shift) & 0x3) return false;
+    while (!word.compare_exchange_weak(value, value | (static_cast<uint64_t>(kind) << shift),
+                                       std::memory_order_relaxed));
+    return true;
+}
+PrefetchKind __INTERNAL__Slide::clear_prefetched(uint32_t layer, uint32_t tile_indx) const
+{
+    // The kind of read-ahead that advised the tile, if any (a hit)
+    size_t index;
+    if (!ENTRY_INDEX(_table, layer, tile_indx, index)) return PREFETCH_NONE;
+    auto& word          = _prefetched[index / 32];
+    const auto shift    = (index % 32) * 2;
+    const uint64_t mask = 0x3ULL << shift;
+    if (!(word.load(std::memory_order_relaxed) & mask)) return PREFETCH_NONE;
+    return static_cast<PrefetchKind>((word.fetch_and(~mask, std::memory_order_relaxed) & mask) >> shift);
+}
+void __INTERNAL__Slide::warm_tile(uint32_t layer, uint32_t tile_indx)
+{
+    // Queue the reads of the tile's pages, then fault each of them in so
+    // that the tile is resident (and counted as warmed) on return.
+    auto tile = get_tile_entry(layer, tile_indx);
+    #ifndef _WIN32
+    static const uint64_t PAGE = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    MADVISE_RANGE(_file->ptr, tile.offset, tile.offset + tile.size, MADV_WILLNEED);
+    uint8_t sum = 0;
+    for (uint64_t offset = tile.offset & ~(PAGE - 1); offset < tile.offset + tile.size; offset += PAGE)
+        sum += *(static_cast<const volatile BYTE*>(_file->ptr) + offset);
+    (void)sum;
+    #endif
+    _warm.tiles_warmed.fetch_add(1, std::memory_order_relaxed);
+    _warm.bytes_warmed.fetch_add(tile.size, std::memory_order_relaxed);
+}
+const WarmProgress& __INTERNAL__Slide::get_warm_progress() const
+{
+    return _warm;
 }
 } // END RESTFUL
 } // END IRIS
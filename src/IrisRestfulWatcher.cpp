@@ -0,0 +1,91 @@
+/**
+ * @file IrisRestfulWatcher.cpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ */
+#include "IrisRestfulPriv.hpp"
+#if IRIS_WATCHER_SUPPORTED
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+namespace Iris {
+namespace RESTful {
+constexpr char WATCHED_EXTENSION[] = ".iris";
+inline int CREATE_INOTIFY (const std::filesystem::path& root)
+{
+    #if IRIS_WATCHER_SUPPORTED
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) throw std::runtime_error
+        (std::string("Failed to create slide directory watcher: ") + strerror(errno));
+    // IN_CLOSE_WRITE: rewritten in place; IN_MOVED_TO: atomically replaced or added;
+    // IN_MOVED_FROM / IN_DELETE: removed from the slide root.
+    if (inotify_add_watch(fd, root.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO |
+                          IN_MOVED_FROM | IN_DELETE | IN_ONLYDIR) < 0) {
+        auto error = std::string(strerror(errno));
+        ::close(fd);
+        throw std::runtime_error ("Failed to watch slide directory " + root.string() + ": " + error);
+    }
+    return fd;
+    #else
+    std::cerr   << "[WARNING] Slide directory watching is not supported on this platform; "
+                << "changes to " << root << " require a server restart\n";
+    return -1;
+    #endif
+}
+__INTERNAL__Watcher::__INTERNAL__Watcher(const std::filesystem::path& root, const Callback& on_change) :
+_root       (root),
+_on_change  (on_change),
+_inotify    (CREATE_INOTIFY(root)),
+_active     (_inotify > -1)
+{
+    if (_active) _thread = std::thread(&__INTERNAL__Watcher::process_events, this);
+}
+__INTERNAL__Watcher::~__INTERNAL__Watcher()
+{
+    _active = false;
+    if (_thread.joinable()) _thread.join();
+    #if IRIS_WATCHER_SUPPORTED
+    if (_inotify > -1) ::close(_inotify);
+    #endif
+}
+void __INTERNAL__Watcher::process_events()
+{
+    #if IRIS_WATCHER_SUPPORTED
+    alignas(struct inotify_event) char buffer[16384];
+    pollfd descriptor { .fd = _inotify, .events = POLLIN, .revents = 0 };
+    while (_active) {
+        // Check every second for shutdown (mirrors the worker pool's wait)
+        if (poll(&descriptor, 1, 1000) <= 0) continue;
+        auto length = read(_inotify, buffer, sizeof(buffer));
+        if (length <= 0) continue;
+
+        for (char* ptr = buffer; ptr < buffer + length;) {
+            auto event  = reinterpret_cast<const struct inotify_event*>(ptr);
+            ptr        += sizeof(struct inotify_event) + event->len;
+            try {
+                if (event->mask & IN_Q_OVERFLOW) {
+                    std::cerr << "[WARNING] Slide directory watcher dropped events; re-checking open slides\n";
+                    _on_change(std::string(), false);
+                    continue;
+                }
+                if (!event->len || (event->mask & IN_ISDIR)) continue;
+                std::filesystem::path name (event->name);
+                if (name.extension() != WATCHED_EXTENSION) continue;
+                _on_change(name.stem().string(), event->mask & (IN_MOVED_FROM | IN_DELETE));
+            } catch (std::exception& error) {
+                std::cerr   << "[WARNING] Failed to apply slide directory change ("
+                            << event->name << "): " << error.what() << "\n";
+            }
+        }
+    }
+    #endif
+}
+} // END RESTFUL
+} // END IRIS
@@ -28,6 +28,34 @@ constexpr char help_statement[] =
 --http-only --no-https: Disable TLS / SSL layer. Server will respond to HTTP rather than HTTPS.\
 If run without defining the -r/--root option, HTTP(S) responses will contain \
 'Access-Control-Allow-Origin':'*' unless the `-o/--cors option` is defined. \n\
+--sendfile: Have the kernel send tile bytes directly from the slide file (sendfile). \
+Applies to plain HTTP (--no-https) connections on Linux; TLS connections are unaffected.\n\
+--inline-tiles: Serve tiles already resident in the page cache on the network thread rather than \
+handing them to the worker pool. Cold tiles, slide opens, and all other requests still use the pool.\n\
+--per-core-reactors: Run one network thread per core, pinned to it, each with its own listening socket \
+(SO_REUSEPORT). Connections stay on the core that accepted them (Linux).\n\
+--ktls: Offload TLS record encryption to the kernel (Linux kTLS, requires the 'tls' kernel module). \
+Tile bytes are then sent with sendfile over HTTPS as well.\n\
+--retain: Number of recently used slides kept open after their last viewer leaves (default 0, disabled)\n\
+--retain-mb: Optional limit on the total mapped size (MB) of retained slides\n\
+--retain-ttl: Seconds a retained slide may sit unused before it is closed (default 600)\n\
+--cache-dir: Directory for the persistent slide-open cache. Unchanged slides reopen \
+without revalidating the file structure; modified slides are detected and revalidated.\n\
+--catalog: Scan and validate all slides in the slide directory at startup; GET /slides?offset=&limit= \
+lists the catalog. With --watch, the catalog is kept current and unknown slide identifiers are rejected \
+without file system access; without it, slides added later are opened but not listed.\n\
+--watch: Watch the slide directory (Linux inotify). New, replaced, and removed slides are picked up \
+without restarting; sessions on a replaced slide move to the new file.\n\
+--readahead: Read ahead the neighbors, parent, and children of each served tile into the page cache, \
+with at most this many read-ahead tasks in flight (default 0, disabled). Helps slides on cold storage.\n\
+--warm-api: Enable POST /slides/<id>/warm?layers=<a>-<b> (open, pin, and read the layers into the page cache), \
+GET /slides/<id>/warm (progress), and DELETE /slides/<id>/warm (unpin). Only expose to trusted clients.\n\
+--memory-pressure: Release the page cache of the least recently used open slides when the server's \
+cgroup memory pressure (PSI some avg10) reaches this percent or its usage nears its limit (default 0, disabled; Linux)\n\
+--cache-max-age: Seconds clients may cache tiles and metadata without revalidating (default 0: \
+clients revalidate and unchanged slides are answered with 304 Not Modified)\n\
+--cache-immutable: Mark tiles and metadata as immutable (max-age defaults to one year). \
+Only use if slide files are never replaced in place.\n\
 \n\
 Usage: IrisRESTful -p <port> -d <slide_root> -c <cert.pem> -k <key.pem> -r <document_root>\n\
 Example:\n\tIrisRESTful -p 3000 -d /slides -c /ect/ssl/iris_cert.pem -k /ect/ssl/private/iris_key.pem -r /openseadragon\n\
@@ -42,6 +70,21 @@ enum ArgumentFlag : uint32_t {
     ARG_CORS,
     ARG_ROOT,
     ARG_HTTP,
+    ARG_SENDFILE,
+    ARG_INLINE_TILES,
+    ARG_PER_CORE_REACTORS,
+    ARG_KTLS,
+    ARG_RETAIN,
+    ARG_RETAIN_MB,
+    ARG_RETAIN_TTL,
+    ARG_CACHE_DIR,
+    ARG_CATALOG,
+    ARG_WATCH,
+    ARG_READAHEAD,
+    ARG_WARM_API,
+    ARG_MEMORY_PRESSURE,
+    ARG_CACHE_MAX_AGE,
+    ARG_CACHE_IMMUTABLE,
     ARG_INVALID = UINT32_MAX
 };
 
@@ -62,8 +105,56 @@ inline ArgumentFlag PARSE_ARGUMENT (const char* arg_str) {
         return ARG_ROOT;
     if (!strcmp(arg_str,"--http-only") || !strcmp(arg_str, "--no-https"))
         return ARG_HTTP;
+    if (!strcmp(arg_str,"--sendfile"))
+        return ARG_SENDFILE;
+    if (!strcmp(arg_str,"--inline-tiles"))
+        return ARG_INLINE_TILES;
+    if (!strcmp(arg_str,"--per-core-reactors"))
+        return ARG_PER_CORE_REACTORS;
+    if (!strcmp(arg_str,"--ktls"))
+        return ARG_KTLS;
+    if (!strcmp(arg_str,"--retain"))
+        return ARG_RETAIN;
+    if (!strcmp(arg_str,"--retain-mb"))
+        return ARG_RETAIN_MB;
+    if (!strcmp(arg_str,"--retain-ttl"))
+        return ARG_RETAIN_TTL;
+    if (!strcmp(arg_str,"--cache-dir"))
+        return ARG_CACHE_DIR;
+    if (!strcmp(arg_str,"--catalog"))
+        return ARG_CATALOG;
+    if (!strcmp(arg_str,"--watch"))
+        return ARG_WATCH;
+    if (!strcmp(arg_str,"--readahead"))
+        return ARG_READAHEAD;
+    if (!strcmp(arg_str,"--warm-api"))
+        return ARG_WARM_API;
+    if (!strcmp(arg_str,"--memory-pressure"))
+        return ARG_MEMORY_PRESSURE;
+    if (!strcmp(arg_str,"--cache-max-age"))
+        return ARG_CACHE_MAX_AGE;
+    if (!strcmp(arg_str,"--cache-immutable"))
+        return ARG_CACHE_IMMUTABLE;
     return ARG_INVALID;
 }
+template <typename T>
+inline bool PARSE_NUMERIC_ARGUMENT (int argc, char* argv[], int& argi, T& value)
+{
+    const char* arg_flag  = argv[argi];
+    const char* arg_chars = argi+1<argc?argv[++argi]:NULL;
+    if (!arg_chars) {
+        std::cerr   << "No corresponding value given for " << arg_flag << " argument\n";
+        return false;
+    }
+    auto result = std::from_chars(arg_chars, arg_chars+strlen(arg_chars), value);
+    if (result.ec != std::errc{}) {
+        std::cerr   << "Failed to parse a numerical value for " << arg_flag
+                    << " from argument \"" << arg_chars << "\"\n"
+                    << help_statement;
+        return false;
+    }
+    return true;
+}
 
 volatile sig_atomic_t terminate_flag = 0;
 void INTERP_CSIGNAL (int param)
@@ -199,6 +290,79 @@ int main(int argc, char* argv[])
                 std::cout << "[WARNING] Running with TLS manually disabled. The server will only respond to HTTP and will NOT respond to HTTPS. If this was unintentional and you wish for end-to-end encryption, remove the --no-https line.\n";
                 break;
                 
+            case ARG_SENDFILE:
+                info.delivery = Iris::RESTful::TILE_DELIVERY_SENDFILE;
+                break;
+                
+            case ARG_INLINE_TILES:
+                info.dispatch = Iris::RESTful::REQUEST_DISPATCH_INLINE;
+                break;
+                
+            case ARG_PER_CORE_REACTORS:
+                info.reactors = Iris::RESTful::NETWORK_REACTORS_PER_CORE;
+                break;
+                
+            case ARG_KTLS:
+                info.ktls = true;
+                break;
+                
+            case ARG_RETAIN:
+                if (!PARSE_NUMERIC_ARGUMENT(argc, argv, argi, info.retain_slides))
+                    return EXIT_FAILURE;
+                break;
+                
+            case ARG_RETAIN_MB:
+                if (!PARSE_NUMERIC_ARGUMENT(argc, argv, argi, info.retain_bytes))
+                    return EXIT_FAILURE;
+                info.retain_bytes <<= 20;
+                break;
+                
+            case ARG_RETAIN_TTL:
+                if (!PARSE_NUMERIC_ARGUMENT(argc, argv, argi, info.retain_ttl))
+                    return EXIT_FAILURE;
+                break;
+                
+            case ARG_CACHE_DIR:
+                arg_chars = argi+1<argc?argv[++argi]:NULL;
+                if (!arg_chars) {
+                    std::cerr   <<"Slide cache argument requires a directory path\n"
+                                << help_statement;
+                    return EXIT_FAILURE;
+                }
+                info.cache_dir = std::string(arg_chars);
+                break;
+                
+            case ARG_CATALOG:
+                info.catalog = true;
+                break;
+                
+            case ARG_WATCH:
+                info.watch = true;
+                break;
+                
+            case ARG_READAHEAD:
+                if (!PARSE_NUMERIC_ARGUMENT(argc, argv, argi, info.readahead))
+                    return EXIT_FAILURE;
+                break;
+                
+            case ARG_WARM_API:
+                info.warm_api = true;
+                break;
+                
+            case ARG_MEMORY_PRESSURE:
+                if (!PARSE_NUMERIC_ARGUMENT(argc, argv, argi, info.memory_pressure))
+                    return EXIT_FAILURE;
+                break;
+                
+            case ARG_CACHE_MAX_AGE:
+                if (!PARSE_NUMERIC_ARGUMENT(argc, argv, argi, info.cache_max_age))
+                    return EXIT_FAILURE;
+                break;
+                
+            case ARG_CACHE_IMMUTABLE:
+                info.cache_immutable = true;
+                break;
+                
             case ARG_INVALID:
                 std::cerr   << "Unknown argument \""
                             << argv[argi]
@@ -226,5 +390,23 @@ int main(int argc, char* argv[])
     while (!terminate_flag)
         std::this_thread::sleep_for(std::chrono::seconds(1));
     
+    auto stats = Iris::RESTful::get_server_statistics(server);
+    std::cout   << "[NOTE] Slide lookups: " << stats.slide_hits << " hits, "
+                << stats.slide_misses << " misses, "
+                << stats.slide_evictions << " retention evictions\n";
+    std::cout   << "[NOTE] Tile requests: " << stats.tiles_inline << " served inline, "
+                << stats.tiles_offloaded << " by the worker pool; service time p50 "
+                << stats.tile_latency_p50 << " us, p99 " << stats.tile_latency_p99 << " us\n";
+    std::cout   << "[NOTE] Tile bytes written: " << stats.tile_bytes << "; response bytes copied "
+                << "before writing: " << stats.bytes_copied << "\n";
+    if (info.readahead)
+        std::cout   << "[NOTE] Tile read-ahead: " << stats.readahead_hits << " hits, "
+                    << stats.readahead_misses << " misses, "
+                    << stats.readahead_issued << " tiles advised ("
+                    << stats.readahead_predicted << " predicted, "
+                    << stats.readahead_predicted_hits << " predicted hits), "
+                    << stats.readahead_dropped << " dropped over budget, "
+                    << (stats.readahead_wasted_bytes >> 20) << " MB advised but unused\n";
+    
     return EXIT_SUCCESS;
 }
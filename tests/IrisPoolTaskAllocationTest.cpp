@@ -0,0 +1,142 @@
+/**
+ * @file IrisPoolTaskAllocationTest.cpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief Regression test: issuing tasks to the thread pool does not allocate.
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ * Replaces the global allocation functions with counting ones and issues
+ * tasks shaped like the server's tile-path closure (the server, a session
+ * shared pointer and a timestamp) and read-ahead closure, both from a thread
+ * outside the pool (the injection ring) and from a pool worker (its
+ * work-stealing deque). Once the pool is warm, not a single allocation may
+ * be counted, and no task may be rejected by try_issue_task. Tasks are issued
+ * in batches that fit the injection ring and a worker's deque; an injected
+ * burst beyond the ring spills into the locked overflow deque, which does
+ * allocate (see TaskList). This covers the pool alone; IrisTileAllocationTest
+ * covers a whole tile request. Exits non-zero on failure.
+ */
+#include <new>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include "IrisTypes.hpp"
+#include "IrisFunction.hpp"
+#include "IrisQueue.hpp"
+#include "IrisAsync.hpp"
+
+static std::atomic<size_t> ALLOCATIONS {0};
+void* operator new (size_t size)
+{
+    ALLOCATIONS.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size ? size : 1)) return pointer;
+    throw std::bad_alloc();
+}
+void* operator new[] (size_t size)
+{
+    return operator new(size);
+}
+void* operator new (size_t size, std::align_val_t alignment)
+{
+    ALLOCATIONS.fetch_add(1, std::memory_order_relaxed);
+    const size_t align = static_cast<size_t>(alignment);
+    if (void* pointer = std::aligned_alloc(align, (size + align - 1) / align * align)) return pointer;
+    throw std::bad_alloc();
+}
+void* operator new[] (size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+void operator delete (void* pointer) noexcept                           { std::free(pointer); }
+void operator delete[] (void* pointer) noexcept                         { std::free(pointer); }
+void operator delete (void* pointer, size_t) noexcept                   { std::free(pointer); }
+void operator delete[] (void* pointer, size_t) noexcept                 { std::free(pointer); }
+void operator delete (void* pointer, std::align_val_t) noexcept         { std::free(pointer); }
+void operator delete[] (void* pointer, std::align_val_t) noexcept       { std::free(pointer); }
+void operator delete (void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[] (void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+
+using namespace Iris;
+using Clock = std::chrono::steady_clock;
+constexpr uint32_t  TASKS       = 10240;
+constexpr uint32_t  BATCH       = 512;      // Within TaskList::CAPACITY and a worker's deque
+struct Server {
+    std::atomic<uint32_t>       complete    {0};
+    std::atomic<uint32_t>       rejected    {0};
+};
+struct Session {
+    uint64_t                    state       [16] = {};
+};
+inline void WAIT_FOR (const std::atomic<uint32_t>& complete, uint32_t count)
+{
+    while (complete.load(std::memory_order_acquire) < count)
+        std::this_thread::yield();
+}
+// Tasks issued from outside the pool, as a network reactor issues a tile request
+size_t INJECTED_ALLOCATIONS (const Async::ThreadPool& pool, Server& server,
+                             const std::shared_ptr<Session>& session)
+{
+    server.complete = 0;
+    const size_t before = ALLOCATIONS.load();
+    for (uint32_t task = 0; task < TASKS; ++task) {
+        const auto received = Clock::now();
+        pool->issue_task([server = &server, session, received]() {
+            if (session && received.time_since_epoch().count())
+                server->complete.fetch_add(1, std::memory_order_release);
+        });
+        if ((task + 1) % BATCH == 0) WAIT_FOR(server.complete, task + 1);
+    }
+    WAIT_FOR(server.complete, TASKS);
+    return ALLOCATIONS.load() - before;
+}
+// Tasks issued by a worker, as a tile response issues its read-ahead. A
+// rejected task is counted as complete (so the wait ends) and as rejected.
+size_t SPAWNED_ALLOCATIONS (const Async::ThreadPool& pool, Server& server,
+                            const std::shared_ptr<Session>& session)
+{
+    server.complete = 0;
+    const size_t before = ALLOCATIONS.load();
+    for (uint32_t batch = 0; batch < TASKS; batch += BATCH) {
+        pool->issue_task([pool = pool.get(), server = &server, session, batch]() {
+            for (uint32_t task = batch; task < batch + BATCH; ++task)
+                if (!pool->try_issue_task([server, session, task]() {
+                    if (session && task < TASKS)
+                        server->complete.fetch_add(1, std::memory_order_release);
+                })) {
+                    server->rejected.fetch_add(1, std::memory_order_relaxed);
+                    server->complete.fetch_add(1, std::memory_order_release);
+                }
+        });
+        WAIT_FOR(server.complete, batch + BATCH);
+    }
+    return ALLOCATIONS.load() - before;
+}
+int main ()
+{
+    auto pool       = Async::createThreadPool(4);
+    auto session    = std::make_shared<Session>();
+    Server server;
+    
+    // Warm the pool: first use of its threads and queues may allocate
+    INJECTED_ALLOCATIONS(pool, server, session);
+    SPAWNED_ALLOCATIONS(pool, server, session);
+    
+    server.rejected         = 0;
+    const size_t injected   = INJECTED_ALLOCATIONS(pool, server, session);
+    const size_t spawned    = SPAWNED_ALLOCATIONS(pool, server, session);
+    pool->wait_until_complete();
+    
+    printf("Allocations issuing %u tasks: %zu injected, %zu from a worker (%u rejected)\n",
+           TASKS, injected, spawned, server.rejected.load());
+    if (injected || spawned) {
+        printf("[ERROR] Issuing a task to the thread pool allocated\n");
+        return EXIT_FAILURE;
+    }
+    if (server.rejected) {
+        printf("[ERROR] The thread pool rejected tasks issued within its capacity\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
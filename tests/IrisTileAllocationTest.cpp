@@ -0,0 +1,185 @@
+/**
+ * @file IrisTileAllocationTest.cpp
+ * @author Ryan Landvater (ryanlandvater [at] gmail [dot] com)
+ * @brief Regression test: a steady-state tile request does not allocate.
+ * @version 0.1
+ * @date 2025-06-07
+ *
+ * @copyright Copyright (c) 2025 Iris Developers
+ *
+ * Replaces the global allocation functions with counting ones, starts a plain
+ * HTTP server over the given slide directory on the loopback interface, and
+ * requests tiles of the given slide on one keep-alive connection: each
+ * request is read by the networking layer, parsed and served by the server
+ * (on_get_request), and written back (send_slide_buffer, or send_tile_range
+ * with sendfile delivery). The client uses plain sockets and prepared
+ * requests, so it does not allocate either. Once the connection and slide
+ * are warm, not a single allocation may be counted. Exits non-zero on failure.
+ *
+ * Usage: IrisTileAllocationTest <slide directory> <slide id> [port = 48620]
+ *                               [dispatch = worker | inline] [delivery = buffer | sendfile]
+ *                               [reactors = per-core | shared]
+ *
+ * The server runs per-core reactors by default (shared where unsupported).
+ * Shared reactors run one io_context on several threads; a session's strand
+ * can then be handed between them, and ASIO occasionally allocates to
+ * reschedule it once its per-thread recycled block is in use elsewhere.
+ */
+#include <new>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include "IrisResfultCore.hpp"
+
+static std::atomic<size_t> ALLOCATIONS {0};
+void* operator new (size_t size)
+{
+    ALLOCATIONS.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size ? size : 1)) return pointer;
+    throw std::bad_alloc();
+}
+void* operator new[] (size_t size)
+{
+    return operator new(size);
+}
+void* operator new (size_t size, std::align_val_t alignment)
+{
+    ALLOCATIONS.fetch_add(1, std::memory_order_relaxed);
+    const size_t align = static_cast<size_t>(alignment);
+    if (void* pointer = std::aligned_alloc(align, (size + align - 1) / align * align)) return pointer;
+    throw std::bad_alloc();
+}
+void* operator new[] (size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+void operator delete (void* pointer) noexcept                           { std::free(pointer); }
+void operator delete[] (void* pointer) noexcept                         { std::free(pointer); }
+void operator delete (void* pointer, size_t) noexcept                   { std::free(pointer); }
+void operator delete[] (void* pointer, size_t) noexcept                 { std::free(pointer); }
+void operator delete (void* pointer, std::align_val_t) noexcept         { std::free(pointer); }
+void operator delete[] (void* pointer, std::align_val_t) noexcept       { std::free(pointer); }
+void operator delete (void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[] (void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+
+using namespace Iris;
+constexpr uint32_t  TILES       = 16;       // Distinct tiles requested in turn
+constexpr uint32_t  REQUESTS    = 2000;
+constexpr size_t    BUFFER_SIZE = 1 << 16;
+static char         BUFFER      [BUFFER_SIZE];
+
+int CONNECT (uint16_t port)
+{
+    sockaddr_in address {};
+    address.sin_family      = AF_INET;
+    address.sin_port        = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (int attempt = 0; attempt < 50; ++attempt) {
+        int socket = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (::connect(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+            int enable = 1;
+            setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+            return socket;
+        }
+        ::close(socket);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    return -1;
+}
+// Send one prepared request and read its response; returns the HTTP status (0 on error)
+int REQUEST (int socket, const std::string& request)
+{
+    if (::send(socket, request.data(), request.size(), MSG_NOSIGNAL) != (ssize_t)request.size())
+        return 0;
+    size_t received = 0, header = std::string_view::npos;
+    while (header == std::string_view::npos) {
+        if (received == BUFFER_SIZE) return 0;
+        ssize_t bytes = ::recv(socket, BUFFER + received, BUFFER_SIZE - received, 0);
+        if (bytes <= 0) return 0;
+        received   += bytes;
+        header      = std::string_view(BUFFER, received).find("\r\n\r\n");
+    }
+    const std::string_view head (BUFFER, header);
+    const int status = head.size() > 12 ? std::atoi(BUFFER + 9) : 0;
+    size_t length = 0, field = head.find("Content-Length: ");
+    if (field == std::string_view::npos) field = head.find("content-length: ");
+    if (field != std::string_view::npos) length = std::strtoull(BUFFER + field + 16, nullptr, 10);
+
+    // Discard the body
+    size_t remaining = length - std::min(length, received - header - 4);
+    while (remaining) {
+        ssize_t bytes = ::recv(socket, BUFFER, std::min(remaining, BUFFER_SIZE), 0);
+        if (bytes <= 0) return 0;
+        remaining  -= bytes;
+    }
+    return status;
+}
+// Issue the requests in turn; returns the allocations counted (SIZE_MAX on a failed request)
+size_t REQUEST_ALLOCATIONS (int socket, const std::vector<std::string>& requests)
+{
+    const size_t before = ALLOCATIONS.load();
+    for (uint32_t request = 0; request < REQUESTS; ++request)
+        if (REQUEST(socket, requests[request % requests.size()]) != 200) {
+            printf("[ERROR] Tile request %s failed\n", requests[request % requests.size()].c_str());
+            return SIZE_MAX;
+        }
+    return ALLOCATIONS.load() - before;
+}
+int main (int argc, char const* argv[])
+{
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <slide directory> <slide id> [port = 48620] "
+                        "[dispatch = worker | inline] [delivery = buffer | sendfile] "
+                        "[reactors = per-core | shared]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const uint16_t port = argc > 3 ? std::stoul(argv[3]) : 48620;
+    RESTful::ServerCreateInfo info {
+        .slide_dir  = argv[1],
+        .https      = false,
+    };
+    if (argc > 4 && !std::strcmp(argv[4], "inline"))    info.dispatch = RESTful::REQUEST_DISPATCH_INLINE;
+    if (argc > 5 && !std::strcmp(argv[5], "sendfile"))  info.delivery = RESTful::TILE_DELIVERY_SENDFILE;
+    if (argc > 6 && !std::strcmp(argv[6], "shared"))    info.reactors = RESTful::NETWORK_REACTORS_SHARED;
+    else info.reactors = RESTful::NETWORK_REACTORS_PER_CORE;
+
+    auto server = RESTful::create_server(info);
+    if (!server || RESTful::server_listen(server, port) != IRIS_SUCCESS) {
+        printf("[ERROR] Failed to start a server on port %u\n", port);
+        return EXIT_FAILURE;
+    }
+    const int socket = CONNECT(port);
+    if (socket < 0) {
+        printf("[ERROR] Failed to connect to the server on port %u\n", port);
+        return EXIT_FAILURE;
+    }
+    std::vector<std::string> requests;
+    for (uint32_t tile = 0; tile < TILES; ++tile)
+        requests.push_back("GET /slides/" + std::string(argv[2]) + "/layers/0/tiles/" +
+                           std::to_string(tile) + " HTTP/1.1\r\nHost: localhost\r\n"
+                           "Accept-Encoding: gzip, deflate\r\nUser-Agent: IrisTileAllocationTest\r\n\r\n");
+
+    // Warm the connection, the slide, and the server's pools and buffers
+    const size_t warm   = REQUEST_ALLOCATIONS(socket, requests);
+    const size_t steady = REQUEST_ALLOCATIONS(socket, requests);
+    ::close(socket);
+    if (warm == SIZE_MAX || steady == SIZE_MAX) return EXIT_FAILURE;
+
+    printf("Allocations serving %u tile requests: %zu warming up, %zu in steady state\n",
+           REQUESTS, warm, steady);
+    if (steady) {
+        printf("[ERROR] Serving a tile request allocated\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}